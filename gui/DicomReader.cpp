@@ -7,7 +7,7 @@
 #include "marching-cubes/Tensor3D.hpp"
 
 DicomData::DicomData(std::unique_ptr<marchingcubes::Grid3D> grid,
-                     std::unique_ptr<marchingcubes::Tensor3D> values,
+                     std::unique_ptr<marchingcubes::Tensor3DUint16> values,
                      const std::list<std::string> &errorFileNameList)
     : mGrid{std::move(grid)}, mValues{std::move(values)},
       mErrorFileNameList{errorFileNameList} {}
@@ -24,8 +24,8 @@ DicomData DicomReader::readFiles(const std::list<std::string> &fileNameList) {
   auto dimZ = z.size();
   auto grid = std::make_unique<marchingcubes::Grid3D>(
       std::move(x), std::move(y), std::move(z));
-  auto tensor3D = std::make_unique<marchingcubes::Tensor3D>(dimX, dimY, dimZ,
-                                                            std::move(values));
+  auto tensor3D = std::make_unique<marchingcubes::Tensor3DUint16>(
+      dimX, dimY, dimZ, std::move(values));
   return DicomData{std::move(grid), std::move(tensor3D), errorFileNameList};
 }
 
@@ -85,7 +85,7 @@ void DicomReader::readOneFile(const std::string &fileName) {
     const void *frameBuffer = image.getOutputData(0, iFrame);
 
     if (isMonochrome) {
-      const char *frameParser = static_cast<const char *>(frameBuffer);
+      const Uint8 *frameParser = static_cast<const Uint8 *>(frameBuffer);
       for (unsigned int iY = 0; iY < height; iY++) {
         for (unsigned int iX = 0; iX < width; iX++) {
           values[index++] = *frameParser;
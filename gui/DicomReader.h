@@ -9,18 +9,21 @@
  =======================================*/
 #pragma once
 
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <vector>
 
 namespace marchingcubes {
 class Grid3D;
-class Tensor3D;
+template <typename TValue> class BasicTensor3D;
+using Tensor3DUint16 = BasicTensor3D<std::uint16_t>;
 } // namespace marchingcubes
 
 /*!
  * \class DicomData
  * \brief The DicomData class stores DICOM data as a tensor 3D and a grid 3D.
+ * The values are kept as 16-bit integers, as they are stored in the files.
  *
  * DicomData objects are usually created by a DicomReader.
  */
@@ -28,7 +31,7 @@ class DicomData {
 
 public:
   DicomData(std::unique_ptr<marchingcubes::Grid3D> grid,
-            std::unique_ptr<marchingcubes::Tensor3D> values,
+            std::unique_ptr<marchingcubes::Tensor3DUint16> values,
             const std::list<std::string> &errorFileNameList);
   ~DicomData();
   DicomData(DicomData &&);
@@ -37,7 +40,7 @@ public:
   std::unique_ptr<marchingcubes::Grid3D> releaseGrid() {
     return std::move(mGrid);
   }
-  std::unique_ptr<marchingcubes::Tensor3D> releaseValues() {
+  std::unique_ptr<marchingcubes::Tensor3DUint16> releaseValues() {
     return std::move(mValues);
   }
   const std::list<std::string> &getErrorFileNameList() const {
@@ -46,7 +49,7 @@ public:
 
 private:
   std::unique_ptr<marchingcubes::Grid3D> mGrid;
-  std::unique_ptr<marchingcubes::Tensor3D> mValues;
+  std::unique_ptr<marchingcubes::Tensor3DUint16> mValues;
   std::list<std::string> mErrorFileNameList;
 };
 
@@ -67,6 +70,6 @@ private:
   std::vector<double> x;
   std::vector<double> y;
   std::vector<double> z;
-  std::vector<double> values;
+  std::vector<std::uint16_t> values;
   std::list<std::string> errorFileNameList;
 };
@@ -134,6 +134,14 @@ void MCubesRenderer::initializeGL() {
   glEnable(GL_DEPTH_TEST); // Enables Depth Testing
   glDepthFunc(GL_LEQUAL);  // The Type Of Depth Test To Do
 
+  // Lighting of the surfaces with normals. The normals are renormalized after
+  // the scaling of the data, and both sides of the surfaces are lit.
+  glEnable(GL_LIGHT0);
+  glEnable(GL_NORMALIZE);
+  glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);
+  glEnable(GL_COLOR_MATERIAL);
+  glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+
   // glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST); // Really Nice
   // Perspective Calculations
 }
@@ -328,8 +336,11 @@ void MCubesRenderer::paintGL() {
    Add a drawn surface
 */ /*
  =======================================*/
-void MCubesRenderer::addSurface(Surface surface,
-                                const marchingcubes::Grid3D &grid) {
+void MCubesRenderer::addSurface(
+    std::vector<marchingcubes::Triangle3D> triangles,
+    std::vector<marchingcubes::TriangleNormals> normals,
+    const marchingcubes::Grid3D &grid) {
+  assert(normals.empty() || normals.size() == triangles.size());
   using namespace marchingcubes;
   minMax[X].push_back(
       std::make_pair(grid.values[X].front(), grid.values[X].back()));
@@ -337,7 +348,7 @@ void MCubesRenderer::addSurface(Surface surface,
       std::make_pair(grid.values[Y].front(), grid.values[Y].back()));
   minMax[Z].push_back(
       std::make_pair(grid.values[Z].front(), grid.values[Z].back()));
-  mSurfaceList.push_back(std::move(surface));
+  mSurfaceList.push_back(Surface{std::move(triangles), std::move(normals)});
 }
 
 /*=======================================*/
@@ -373,17 +384,30 @@ void MCubesRenderer::drawSurface(const Surface &surface,
   MCubesRange zRange(zMinMax.first, zMinMax.second);
   MCubesRange zColorRange(0.0, 1.0);
 
-  for (size_t iTriangle = 0; iTriangle < surface.size(); ++iTriangle) {
-    const auto &triangle = surface[iTriangle];
+  // The surfaces with normals are lit, the Z color being their material.
+  const bool hasNormals = !surface.normals.empty();
+  if (hasNormals) {
+    glEnable(GL_LIGHTING);
+  }
+  for (size_t iTriangle = 0; iTriangle < surface.triangles.size();
+       ++iTriangle) {
+    const auto &triangle = surface.triangles[iTriangle];
     glBegin(GL_TRIANGLES);
     for (unsigned int iPoint = 0; iPoint < triangle.size(); iPoint++) {
       const auto &point = triangle[iPoint];
       double zColor = zColorRange.getTransformedValue(zRange, point[Z]);
       glColor3d(zColor, zColor, 1.0);
+      if (hasNormals) {
+        const auto &normal = surface.normals[iTriangle][iPoint];
+        glNormal3d(normal[X], normal[Y], normal[Z]);
+      }
       glVertex3d(point[X], point[Y], point[Z]);
     }
     glEnd();
   }
+  if (hasNormals) {
+    glDisable(GL_LIGHTING);
+  }
 }
 
 /*=======================================*/
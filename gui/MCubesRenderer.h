@@ -23,7 +23,11 @@ class MCubesSurface;
  */
 class MCubesRenderer : public QGLWidget {
 
-  using Surface = std::vector<marchingcubes::Triangle3D>;
+  struct Surface {
+    std::vector<marchingcubes::Triangle3D> triangles;
+    // The normals at the vertices of each triangle, or empty.
+    std::vector<marchingcubes::TriangleNormals> normals;
+  };
 
 public:
   MCubesRenderer(QWidget *parent = nullptr,
@@ -60,7 +64,9 @@ private:
 
 public:
   inline size_t surfaceCount() const { return mSurfaceList.size(); }
-  void addSurface(Surface surface, const marchingcubes::Grid3D &grid);
+  void addSurface(std::vector<marchingcubes::Triangle3D> triangles,
+                  std::vector<marchingcubes::TriangleNormals> normals,
+                  const marchingcubes::Grid3D &grid);
   void removeSurface();
 
 private:
@@ -11,12 +11,20 @@
 // Class definition
 #include "gui/MCubesWindow.h"
 
+#include "marching-cubes/IncrementalMarchingCubes.hpp"
+#include "marching-cubes/IsoSurfaceCache.hpp"
+#include "marching-cubes/IsoSurfaceJob.hpp"
 #include "marching-cubes/MarchingCubes.hpp"
+#include "marching-cubes/QuadricDecimation.hpp"
 #include "marching-cubes/Tensor3D.hpp"
 
 // C / C++
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <future>
+#include <memory>
+#include <thread>
 
 // Qt
 #include <QAction>
@@ -25,8 +33,10 @@
 #include <QFileDialog>
 #include <QLabel>
 #include <QSlider>
+#include <QStatusBar>
 #include <QTextEdit>
 #include <QTime>
+#include <QTimer>
 #include <QToolBar>
 #include <QVBoxLayout>
 
@@ -35,9 +45,69 @@
 #include "gui/MCubesRenderer.h"
 #include "gui/MCubesTools.h"
 
+// The renderer draws smoothly up to about this number of triangles.
+static constexpr size_t DECIMATED_TRIANGLE_COUNT = 1000000;
+
+// The memory of the isosurfaces kept by the window.
+static constexpr size_t ISO_SURFACE_CACHE_BYTES = size_t{1} << 30;
+
+/*!
+ * \brief The MCubesIsoSurface struct is the result of the background
+ * calculation of an isosurface, with its timings.
+ */
+struct MCubesIsoSurface {
+  marchingcubes::TrianglesWithNormals surface;
+  size_t extractedTriangleCount = 0;
+  int extractionTime = 0;
+  // The time of the decimation in ms, or -1 when it is not decimated.
+  int decimationTime = -1;
+};
+
+/*!
+ * Calculates the isosurface of tensor for isoValue, and decimates it with
+ * decimation unless it is nullptr. It runs in the background, and throws
+ * IsoSurfaceCancelled once the token of progress is cancelled.
+ */
+template <typename TValue>
+static MCubesIsoSurface
+calculateIsoSurface(const marchingcubes::MarchingCubes &marchingCubes,
+                    const marchingcubes::Grid3D &grid,
+                    const marchingcubes::BasicTensor3D<TValue> &tensor,
+                    double isoValue,
+                    const marchingcubes::QuadricDecimation *decimation,
+                    const marchingcubes::CancellationToken &token,
+                    marchingcubes::IsoSurfaceProgress &progress) {
+  MCubesIsoSurface result;
+  auto &surface = result.surface;
+  QTime timer;
+  timer.start();
+  if (decimation == nullptr) {
+    surface.triangles = marchingCubes.isoSurfaceWithNormals(
+        grid, tensor, isoValue, surface.normals, progress);
+    result.extractionTime = timer.elapsed();
+    result.extractedTriangleCount = surface.triangles.size();
+    return result;
+  }
+  // The indexed mesh is decimated as it is, without welding its triangles.
+  auto mesh = marchingCubes.isoSurfaceMeshWithNormals(grid, tensor, isoValue,
+                                                      progress);
+  result.extractionTime = timer.elapsed();
+  result.extractedTriangleCount = mesh.triangles.size();
+  if (mesh.triangles.size() > decimation->targetTriangleCount()) {
+    timer.start();
+    if (token.isCancelled()) {
+      throw marchingcubes::IsoSurfaceCancelled{};
+    }
+    mesh = decimation->decimate(mesh, token);
+    result.decimationTime = timer.elapsed();
+  }
+  surface.triangles = mesh.toTriangles();
+  surface.normals = mesh.toTriangleNormals();
+  return result;
+}
+
 MCubesWindow::MCubesWindow(QWidget *parentWidget, Qt::WindowFlags flags)
-    : QMainWindow(parentWidget, flags),
-      mMarchingCubes(new marchingcubes::MarchingCubes{}) {
+    : QMainWindow(parentWidget, flags) {
 
   setWindowTitle(QObject::tr("DICOM 3D renderer"));
 
@@ -68,6 +138,21 @@ MCubesWindow::MCubesWindow(QWidget *parentWidget, Qt::WindowFlags flags)
     centralLayout->addWidget(mLogWidget);
   }
 
+  // Background isosurfaces
+  {
+    mMarchingCubes = std::make_unique<marchingcubes::MarchingCubes>(
+        std::max(1u, std::thread::hardware_concurrency()));
+    mDecimation = std::make_unique<marchingcubes::QuadricDecimation>(
+        std::max(1u, std::thread::hardware_concurrency()));
+    mDecimation->setTargetTriangleCount(DECIMATED_TRIANGLE_COUNT);
+    mIsoSurfaceCache = std::make_unique<marchingcubes::IsoSurfaceCache>(
+        ISO_SURFACE_CACHE_BYTES);
+    mIsoSurfaceTimer = new QTimer(this);
+    mIsoSurfaceTimer->setInterval(50);
+    QObject::connect(mIsoSurfaceTimer, SIGNAL(timeout()), this,
+                     SLOT(slotIsoSurfaceTimeout()));
+  }
+
   // Marching cubes
   {
     QToolBar *toolBar = new QToolBar(this);
@@ -91,6 +176,15 @@ MCubesWindow::MCubesWindow(QWidget *parentWidget, Qt::WindowFlags flags)
       QObject::connect(testAction, SIGNAL(triggered()), this,
                        SLOT(slotTestSphere()));
     }
+    {
+      mDecimateAction = new QAction(QObject::tr("Decimate"), this);
+      mDecimateAction->setToolTip(
+          QObject::tr("Decimate the large surfaces before rendering them"));
+      mDecimateAction->setCheckable(true);
+      toolBar->addAction(mDecimateAction);
+      QObject::connect(mDecimateAction, SIGNAL(toggled(bool)), this,
+                       SLOT(slotDecimateToggled(bool)));
+    }
 
     // Manage the value of the iso-surface
     {
@@ -120,6 +214,8 @@ MCubesWindow::MCubesWindow(QWidget *parentWidget, Qt::WindowFlags flags)
         boxLayout->addWidget(mIsoValueSlider);
         QObject::connect(mIsoValueSlider, SIGNAL(valueChanged(int)), this,
                          SLOT(slotSliderValueChanged(int)));
+        QObject::connect(mIsoValueSlider, SIGNAL(sliderReleased()), this,
+                         SLOT(slotSliderReleased()));
       }
 
       // Spin box
@@ -135,7 +231,10 @@ MCubesWindow::MCubesWindow(QWidget *parentWidget, Qt::WindowFlags flags)
   }
 }
 
-MCubesWindow::~MCubesWindow() = default;
+MCubesWindow::~MCubesWindow() {
+  // The job refers to the current grid and tensor.
+  cancelIsoSurface();
+}
 
 void MCubesWindow::addLogMessage(const QString &message) {
   mLogWidget->append(message);
@@ -147,18 +246,40 @@ void MCubesWindow::clearLogMessage() {
   mLogWidget->repaint();
 }
 
-void MCubesWindow::slotSliderValueChanged(int value) {
-  assert(mCurrentTensor != NULL);
+double MCubesWindow::sliderIsoValue() const {
   MCubesRange sliderRange(mIsoValueSlider->minimum(),
                           mIsoValueSlider->maximum());
   MCubesRange isoValueRange(tensorMin, tensorMax);
-  double isoValue = isoValueRange.getTransformedValue(sliderRange, value);
+  return isoValueRange.getTransformedValue(sliderRange,
+                                           mIsoValueSlider->value());
+}
 
-  setIsoValue(isoValue);
+void MCubesWindow::slotSliderValueChanged(int /*value*/) {
+  assert(mCurrentGrid != nullptr);
+  // While the slider is dragged, the coarse isosurface follows it, and the
+  // full one is calculated once it is released.
+  if (mIsoValueSlider->isSliderDown() && mPreviewLevel > 0) {
+    setPreviewIsoValue(sliderIsoValue());
+  } else {
+    setIsoValue(sliderIsoValue());
+  }
+}
+
+void MCubesWindow::slotSliderReleased() {
+  assert(mCurrentGrid != nullptr);
+  if (mPreviewLevel > 0) {
+    setIsoValue(sliderIsoValue());
+  }
 }
 
 void MCubesWindow::slotSpinBoxValueChanged(double value) { setIsoValue(value); }
 
+void MCubesWindow::slotDecimateToggled(bool /*checked*/) {
+  if (mCurrentGrid != nullptr) {
+    setIsoValue(mIsoValueSpinBox->value());
+  }
+}
+
 void MCubesWindow::slotTestSphere() {
 
   using namespace marchingcubes;
@@ -241,17 +362,61 @@ void MCubesWindow::slotOpenFile() {
   setTensor(dicomData.releaseGrid(), dicomData.releaseValues());
 }
 
-void MCubesWindow::setTensor(std::unique_ptr<marchingcubes::Grid3D> grid,
-                             std::unique_ptr<marchingcubes::Tensor3D> tensor) {
+template <typename TValue>
+void MCubesWindow::setTensor(
+    std::unique_ptr<marchingcubes::Grid3D> grid,
+    std::unique_ptr<marchingcubes::BasicTensor3D<TValue>> tensor) {
   assert(grid != nullptr);
   assert(tensor != nullptr);
   mIsoSurfaceWidget->setEnabled(true);
 
+  auto [min, max] = tensor->minMax();
+  tensorMin = static_cast<double>(min);
+  tensorMax = static_cast<double>(max);
+  // The running job and the cached isosurfaces refer to the previous grid
+  // and tensor.
+  cancelIsoSurface();
+  mIsoSurfaceCache->clear();
+  mPreviewMarchingCubes = {};
+
+  // The preview level is the finest one of at most PREVIEW_VALUE_COUNT
+  // values, so that its isosurface follows the slider.
+  constexpr size_t PREVIEW_VALUE_COUNT = 128 * 128 * 128;
+  QTime timer;
+  timer.start();
+  tensor->buildPyramid(3, std::max(1u, std::thread::hardware_concurrency()));
+  mPreviewLevel = 0;
+  while (mPreviewLevel + 1 < tensor->pyramidLevelCount()) {
+    const auto &level = tensor->pyramidLevel(mPreviewLevel);
+    if (level.size(0) * level.size(1) * level.size(2) <= PREVIEW_VALUE_COUNT) {
+      break;
+    }
+    ++mPreviewLevel;
+  }
+  mPreviewGrid = std::make_unique<marchingcubes::Grid3D>(
+      marchingcubes::pyramidGrid(*grid, mPreviewLevel));
+  addLogMessage(QString("Pyramid built in %1 ms, preview level %2")
+                    .arg(timer.elapsed())
+                    .arg(mPreviewLevel));
+  if (mPreviewLevel > 0) {
+    timer.start();
+    mPreviewMarchingCubes =
+        std::make_unique<marchingcubes::IncrementalMarchingCubes<TValue>>(
+            *mPreviewGrid, tensor->pyramidLevel(mPreviewLevel));
+    addLogMessage(QString("Preview values sorted in %1 ms")
+                      .arg(timer.elapsed()));
+  }
+
+  // Built once per tensor, so that the full isosurfaces calculated in the
+  // background skip the bricks that cannot intersect them.
+  timer.start();
+  tensor->buildMinMaxHierarchy();
+  addLogMessage(
+      QString("Min max hierarchy built in %1 ms").arg(timer.elapsed()));
+
   mCurrentGrid = std::move(grid);
   mCurrentTensor = std::move(tensor);
 
-  std::tie(tensorMin, tensorMax) = mCurrentTensor->minMax();
-
   addLogMessage(QObject::tr("Grid size = %1 x %2 x %3")
                     .arg(mCurrentGrid->values[I_XAXIS].size())
                     .arg(mCurrentGrid->values[I_YAXIS].size())
@@ -288,20 +453,147 @@ void MCubesWindow::setIsoValue(double isoValue) {
     mIsoValueSpinBox->setValue(isoValue);
   }
 
+  // The isosurface for the previous isovalue is stale: its rows of cubes in
+  // progress are finished, and the others skipped.
+  cancelIsoSurface();
   QTime timer;
   timer.start();
-  auto newSurface =
-      mMarchingCubes->isoSurface(*mCurrentGrid, *mCurrentTensor, isoValue);
+  if (const auto surface = mIsoSurfaceCache->find(isoSurfaceKey(isoValue))) {
+    addLogMessage(QString("Surface found in cache in %1 ms: %2 surfaces")
+                      .arg(timer.elapsed())
+                      .arg(surface->triangles.size()));
+    showIsoSurface(*surface);
+    return;
+  }
+  mJobIsoValue = isoValue;
+  // The job only reads the objects below, which are not modified before it
+  // is cancelled.
+  const auto &marchingCubes = *mMarchingCubes;
+  const auto &grid = *mCurrentGrid;
+  const auto *decimation =
+      mDecimateAction->isChecked() ? mDecimation.get() : nullptr;
+  auto token = std::make_shared<marchingcubes::CancellationToken>();
+  auto progress = std::make_shared<marchingcubes::IsoSurfaceProgress>(token);
+  auto result = std::visit(
+      [&](const auto &tensor) {
+        return std::async(
+            std::launch::async, [&marchingCubes, &grid, &tensor = *tensor,
+                                 isoValue, decimation, token, progress] {
+              return calculateIsoSurface(marchingCubes, grid, tensor,
+                                         isoValue, decimation, *token,
+                                         *progress);
+            });
+      },
+      mCurrentTensor);
+  mIsoSurfaceJob =
+      std::make_unique<marchingcubes::IsoSurfaceJob<MCubesIsoSurface>>(
+          std::move(token), std::move(progress), std::move(result));
+  mIsoSurfaceTimer->start();
+}
+
+void MCubesWindow::slotIsoSurfaceTimeout() {
+  assert(mIsoSurfaceJob != nullptr);
+  if (!mIsoSurfaceJob->isReady()) {
+    const auto progress = mIsoSurfaceJob->progress();
+    statusBar()->showMessage(
+        progress < 1.0
+            ? QString("Marching cubes for %1: %2 %")
+                  .arg(mJobIsoValue)
+                  .arg(static_cast<int>(100.0 * progress))
+            : QString("Decimating the surface for %1").arg(mJobIsoValue));
+    return;
+  }
+  mIsoSurfaceTimer->stop();
+  statusBar()->clearMessage();
+  // Only the job of the last isovalue is still running, so it is not
+  // cancelled.
+  auto result = mIsoSurfaceJob->get();
+  mIsoSurfaceJob = nullptr;
 
-  int elapsedTime = timer.elapsed();
-  addLogMessage(QString("Marching cubes executed in %1 ms").arg(elapsedTime));
+  addLogMessage(
+      QString("Marching cubes executed in %1 ms").arg(result.extractionTime));
   addLogMessage(QString("Surface created: %1 points and %2 surfaces")
-                    .arg(newSurface.size() * 3)
-                    .arg(newSurface.size()));
+                    .arg(result.extractedTriangleCount * 3)
+                    .arg(result.extractedTriangleCount));
+  if (result.decimationTime >= 0) {
+    addLogMessage(QString("Surface decimated to %1 surfaces in %2 ms")
+                      .arg(result.surface.triangles.size())
+                      .arg(result.decimationTime));
+  }
+
+  const auto cachedSurface =
+      std::make_shared<const marchingcubes::TrianglesWithNormals>(
+          std::move(result.surface));
+  mIsoSurfaceCache->insert(isoSurfaceKey(mJobIsoValue), cachedSurface);
+  showIsoSurface(*cachedSurface);
+}
 
+marchingcubes::IsoSurfaceKey
+MCubesWindow::isoSurfaceKey(double isoValue) const {
+  return std::visit(
+      [this, isoValue](const auto &tensor) {
+        return marchingcubes::IsoSurfaceKey{
+            tensor.get(), isoValue, tensor->indexBox(), true,
+            mDecimateAction->isChecked() ? DECIMATED_TRIANGLE_COUNT : 0};
+      },
+      mCurrentTensor);
+}
+
+void MCubesWindow::showIsoSurface(
+    const marchingcubes::TrianglesWithNormals &surface) {
   while (mRenderer->surfaceCount() > 0) {
     mRenderer->removeSurface();
   }
-  mRenderer->addSurface(std::move(newSurface), *mCurrentGrid);
+  // The renderer keeps its own copy, and the cache the shared one.
+  mRenderer->addSurface(surface.triangles, surface.normals, *mCurrentGrid);
   mRenderer->updateGL();
 }
+
+void MCubesWindow::setPreviewIsoValue(double isoValue) {
+  // The preview replaces the isosurface being calculated.
+  cancelIsoSurface();
+  {
+    QSignalBlocker blocker(mIsoValueSpinBox);
+    mIsoValueSpinBox->setValue(isoValue);
+  }
+
+  QTime timer;
+  timer.start();
+  std::vector<marchingcubes::TriangleNormals> normals;
+  // The successive isovalues of the slider are close, so only the cubes
+  // around the values between them are classified again.
+  std::size_t updatedCubeCount = 0;
+  auto newSurface = std::visit(
+      [isoValue, &normals, &updatedCubeCount](const auto &marchingCubes) {
+        auto triangles =
+            marchingCubes->isoSurfaceWithNormals(isoValue, normals);
+        updatedCubeCount = marchingCubes->updatedCubeCount();
+        return triangles;
+      },
+      mPreviewMarchingCubes);
+  addLogMessage(QString("Preview of level %1 executed in %2 ms, %3 cubes "
+                        "updated")
+                    .arg(mPreviewLevel)
+                    .arg(timer.elapsed())
+                    .arg(updatedCubeCount));
+
+  while (mRenderer->surfaceCount() > 0) {
+    mRenderer->removeSurface();
+  }
+  // The preview grid has the bounds of the current grid.
+  mRenderer->addSurface(std::move(newSurface), std::move(normals),
+                        *mCurrentGrid);
+  mRenderer->updateGL();
+}
+
+void MCubesWindow::cancelIsoSurface() {
+  mIsoSurfaceTimer->stop();
+  statusBar()->clearMessage();
+  if (mIsoSurfaceJob != nullptr) {
+    mIsoSurfaceJob->cancel();
+    // Waits for the rows of cubes, or the few thousand steps of the
+    // decimation, in progress: the job reads the tensor and the grid, which
+    // may be replaced once it is cancelled, so it is not detached.
+    mIsoSurfaceJob = nullptr;
+  }
+}
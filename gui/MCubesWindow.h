@@ -10,21 +10,34 @@
 #pragma once
 
 #include <QMainWindow>
+#include <cstdint>
 #include <memory>
+#include <variant>
 
+class QAction;
 class QTextEdit;
 class QSlider;
 class QDoubleSpinBox;
+class QTimer;
 
 class MCubesRenderer;
 class MCubesAlgorithm;
 class MCubesGrid;
 class MCubesData;
+struct MCubesIsoSurface;
 
 namespace marchingcubes {
 class Grid3D;
+template <typename TValue> class BasicTensor3D;
+template <typename TValue> class IncrementalMarchingCubes;
+class IsoSurfaceCache;
+struct IsoSurfaceKey;
 class MarchingCubes;
-class Tensor3D;
+class QuadricDecimation;
+struct TrianglesWithNormals;
+template <typename TResult> class IsoSurfaceJob;
+using Tensor3D = BasicTensor3D<double>;
+using Tensor3DUint16 = BasicTensor3D<std::uint16_t>;
 } // namespace marchingcubes
 
 /*!
@@ -50,6 +63,7 @@ private:
   QWidget *mIsoSurfaceWidget;
   QSlider *mIsoValueSlider;
   QDoubleSpinBox *mIsoValueSpinBox;
+  QAction *mDecimateAction;
 
 protected:
   void addLogMessage(const QString &message);
@@ -59,19 +73,52 @@ protected slots:
   void slotTestSphere();
   void slotOpenFile();
   void slotSliderValueChanged(int value);
+  void slotSliderReleased();
   void slotSpinBoxValueChanged(double value);
+  void slotDecimateToggled(bool checked);
+  void slotIsoSurfaceTimeout();
 
 private:
-  void setTensor(std::unique_ptr<marchingcubes::Grid3D> mCurrentGrid,
-                 std::unique_ptr<marchingcubes::Tensor3D> mCurrentTensor);
+  template <typename TValue>
+  void
+  setTensor(std::unique_ptr<marchingcubes::Grid3D> grid,
+            std::unique_ptr<marchingcubes::BasicTensor3D<TValue>> tensor);
+  double sliderIsoValue() const;
   void setIsoValue(double isoValue);
-
-private:
-  const std::unique_ptr<marchingcubes::MarchingCubes> mMarchingCubes;
+  void setPreviewIsoValue(double isoValue);
+  void cancelIsoSurface();
+  marchingcubes::IsoSurfaceKey isoSurfaceKey(double isoValue) const;
+  void showIsoSurface(const marchingcubes::TrianglesWithNormals &surface);
 
 private:
   std::unique_ptr<marchingcubes::Grid3D> mCurrentGrid;
-  std::unique_ptr<marchingcubes::Tensor3D> mCurrentTensor;
+  // The sphere is a tensor of double values, and the DICOM data a tensor of
+  // 16-bit values.
+  std::variant<std::unique_ptr<marchingcubes::Tensor3D>,
+               std::unique_ptr<marchingcubes::Tensor3DUint16>>
+      mCurrentTensor;
+  std::unique_ptr<marchingcubes::MarchingCubes> mMarchingCubes;
+  std::unique_ptr<marchingcubes::QuadricDecimation> mDecimation;
+  // The calculation and decimation of the isosurface for the last isovalue,
+  // running in the background so that the window stays responsive. It is
+  // cancelled as soon as the isovalue changes again, and its progress is
+  // polled by mIsoSurfaceTimer.
+  std::unique_ptr<marchingcubes::IsoSurfaceJob<MCubesIsoSurface>>
+      mIsoSurfaceJob;
+  QTimer *mIsoSurfaceTimer;
+  // The last isosurfaces shown for the current tensor.
+  std::unique_ptr<marchingcubes::IsoSurfaceCache> mIsoSurfaceCache;
+  double mJobIsoValue;
+  // The grid of the pyramid level of the current tensor whose isosurface is
+  // shown while the slider is dragged.
+  std::unique_ptr<marchingcubes::Grid3D> mPreviewGrid;
+  size_t mPreviewLevel = 0;
+  // Built for the preview level, so that dragging the slider only updates
+  // the cubes around the values that change side.
+  std::variant<
+      std::unique_ptr<marchingcubes::IncrementalMarchingCubes<double>>,
+      std::unique_ptr<marchingcubes::IncrementalMarchingCubes<std::uint16_t>>>
+      mPreviewMarchingCubes;
   double tensorMin;
   double tensorMax;
 };
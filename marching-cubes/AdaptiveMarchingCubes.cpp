@@ -0,0 +1,707 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/AdaptiveMarchingCubes.hpp"
+
+#include "marching-cubes/Tensor3D.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace marchingcubes {
+
+void AdaptiveMarchingCubes::setMaxCellSize(std::size_t maxCellSize) {
+  if (maxCellSize == 0 || (maxCellSize & (maxCellSize - 1)) != 0) {
+    throw std::invalid_argument("Max cell size " +
+                                std::to_string(maxCellSize) +
+                                " is not a power of 2");
+  }
+  cellSize = maxCellSize;
+}
+
+using Index3D = std::array<size_t, DIM_COUNT>;
+
+/*!
+ * \class Sample
+ * \brief The class Sample stores a vertex of the tetrahedra of the octree: a
+ * point of the grid, or the centre of a cell of 1 cube.
+ *
+ * The key identifies the vertex: the edges of the tetrahedra are identified by
+ * the keys of their ends, so that the point of the isosurface on an edge is
+ * calculated once for all the tetrahedra around the edge.
+ */
+struct Sample {
+  std::uint64_t key;
+  double value;
+  Point3D point;
+};
+
+/*!
+ * \class AdaptiveExtraction
+ * \brief The class AdaptiveExtraction builds the octree of cells of an
+ * isosurface and extracts its triangles, see AdaptiveMarchingCubes.
+ *
+ * The octree is stored as the level of the cell that contains each cube: a
+ * cell of level l has 2^l cubes along each axis, and its origin is a multiple
+ * of 2^l.
+ *
+ * A cell may cross the last points of the tensor, as long as its centre is
+ * inside: it then ends at the last points, and its points after them are
+ * clamped to them. Otherwise, the cells along the last points, e.g. the
+ * 2^n - 1 cubes of a tensor of 2^n points, would be split down to 1 cube.
+ */
+template <typename TValue> class AdaptiveExtraction {
+
+public:
+  AdaptiveExtraction(const Grid3D &grid, const BasicTensor3D<TValue> &tensor,
+                     double isoValue, double maxError)
+      : grid{grid}, tensor{tensor}, isoValue{isoValue}, maxError{maxError},
+        cellCounts{{tensor.size(X) - 1, tensor.size(Y) - 1,
+                    tensor.size(Z) - 1}},
+        pointCount{tensor.size(X) * tensor.size(Y) * tensor.size(Z)},
+        levels(cellCounts[X] * cellCounts[Y] * cellCounts[Z]) {
+    assert(pointCount + levels.size() <= (std::uint64_t{1} << 32));
+  }
+
+public:
+  void build(size_t maxCellSize);
+  void balance();
+  IndexedMesh extract();
+
+private:
+  size_t cellIndex(const Index3D &cube) const {
+    return cube[X] + cellCounts[X] * (cube[Y] + cellCounts[Y] * cube[Z]);
+  }
+  std::uint8_t levelAt(const Index3D &cube) const {
+    return levels[cellIndex(cube)];
+  }
+  void setLevel(const Index3D &origin, std::uint8_t level);
+  bool isInside(const Index3D &origin, size_t size) const;
+  Index3D clamp(const Index3D &point) const;
+
+  template <typename TFunction> void forEachCell(TFunction function) const;
+
+  void subdivide(const Index3D &origin, std::uint8_t level);
+  void split(const Index3D &origin, std::uint8_t level);
+  bool isAccurate(const Index3D &origin, size_t size) const;
+  bool hasSmallerNeighbour(const Index3D &origin, std::uint8_t level) const;
+  bool isCorner(const Index3D &point) const;
+
+  Sample pointSample(const Index3D &point) const;
+  Sample cubeCentreSample(const Index3D &cube) const;
+  void extractCell(const Index3D &origin, size_t size);
+  void marchTetrahedron(const Sample &a, const Sample &b, const Sample &c,
+                        const Sample &d);
+  std::uint32_t edgeVertex(const Sample &a, const Sample &b);
+  void addTriangle(std::uint32_t i0, std::uint32_t i1, std::uint32_t i2,
+                   const Vector3D &direction);
+
+private:
+  const Grid3D &grid;
+  const BasicTensor3D<TValue> &tensor;
+  const double isoValue;
+  const double maxError;
+  const Index3D cellCounts;
+  const size_t pointCount;
+  std::vector<std::uint8_t> levels;
+
+  IndexedMesh mesh;
+  std::unordered_map<std::uint64_t, std::uint32_t> edgeVertices;
+};
+
+template <typename TValue>
+void AdaptiveExtraction<TValue>::setLevel(const Index3D &origin,
+                                          std::uint8_t level) {
+  const size_t size = size_t{1} << level;
+  const auto end = clamp({{origin[X] + size, origin[Y] + size,
+                           origin[Z] + size}});
+  for (size_t z = origin[Z]; z < end[Z]; ++z) {
+    for (size_t y = origin[Y]; y < end[Y]; ++y) {
+      for (size_t x = origin[X]; x < end[X]; ++x) {
+        levels[cellIndex({{x, y, z}})] = level;
+      }
+    }
+  }
+}
+
+/*!
+ * Returns true when the cell of origin and size can be in the octree: when
+ * its centre is before the last points, or when it is 1 cube.
+ */
+template <typename TValue>
+bool AdaptiveExtraction<TValue>::isInside(const Index3D &origin,
+                                          size_t size) const {
+  for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    if (origin[iDim] + size / 2 >= cellCounts[iDim] && size > 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*!
+ * Returns point, clamped to the last points of the tensor.
+ */
+template <typename TValue>
+Index3D AdaptiveExtraction<TValue>::clamp(const Index3D &point) const {
+  return {{std::min(point[X], cellCounts[X]),
+           std::min(point[Y], cellCounts[Y]),
+           std::min(point[Z], cellCounts[Z])}};
+}
+
+/*!
+ * Calls function(origin, level) for each cell of the octree, in the order of
+ * its origin, including the cells that function splits on the way.
+ */
+template <typename TValue>
+template <typename TFunction>
+void AdaptiveExtraction<TValue>::forEachCell(TFunction function) const {
+  Index3D cube;
+  for (cube[Z] = 0; cube[Z] < cellCounts[Z]; ++cube[Z]) {
+    for (cube[Y] = 0; cube[Y] < cellCounts[Y]; ++cube[Y]) {
+      for (cube[X] = 0; cube[X] < cellCounts[X]; ++cube[X]) {
+        const auto level = levelAt(cube);
+        const size_t mask = (size_t{1} << level) - 1;
+        if (((cube[X] | cube[Y] | cube[Z]) & mask) == 0) {
+          function(cube, level);
+        }
+      }
+    }
+  }
+}
+
+template <typename TValue>
+void AdaptiveExtraction<TValue>::build(size_t maxCellSize) {
+  std::uint8_t maxLevel = 0;
+  while ((size_t{1} << maxLevel) < maxCellSize) {
+    ++maxLevel;
+  }
+  Index3D origin;
+  for (origin[Z] = 0; origin[Z] < cellCounts[Z]; origin[Z] += maxCellSize) {
+    for (origin[Y] = 0; origin[Y] < cellCounts[Y]; origin[Y] += maxCellSize) {
+      for (origin[X] = 0; origin[X] < cellCounts[X];
+           origin[X] += maxCellSize) {
+        subdivide(origin, maxLevel);
+      }
+    }
+  }
+}
+
+template <typename TValue>
+void AdaptiveExtraction<TValue>::subdivide(const Index3D &origin,
+                                           std::uint8_t level) {
+  const size_t size = size_t{1} << level;
+  if (level == 0 || (isInside(origin, size) && isAccurate(origin, size))) {
+    setLevel(origin, level);
+    return;
+  }
+  const size_t half = size / 2;
+  for (size_t iChild = 0; iChild < 8; ++iChild) {
+    const Index3D child{{origin[X] + (iChild & 1) * half,
+                         origin[Y] + ((iChild >> 1) & 1) * half,
+                         origin[Z] + ((iChild >> 2) & 1) * half}};
+    if (child[X] < cellCounts[X] && child[Y] < cellCounts[Y] &&
+        child[Z] < cellCounts[Z]) {
+      subdivide(child, level - 1);
+    }
+  }
+}
+
+/*!
+ * Replaces the cell of origin and level by its children, and the children
+ * that are not inside the tensor by theirs, see isInside.
+ */
+template <typename TValue>
+void AdaptiveExtraction<TValue>::split(const Index3D &origin,
+                                       std::uint8_t level) {
+  const size_t half = size_t{1} << (level - 1);
+  for (size_t iChild = 0; iChild < 8; ++iChild) {
+    const Index3D child{{origin[X] + (iChild & 1) * half,
+                         origin[Y] + ((iChild >> 1) & 1) * half,
+                         origin[Z] + ((iChild >> 2) & 1) * half}};
+    if (child[X] < cellCounts[X] && child[Y] < cellCounts[Y] &&
+        child[Z] < cellCounts[Z]) {
+      if (isInside(child, half)) {
+        setLevel(child, level - 1);
+      } else {
+        split(child, level - 1);
+      }
+    }
+  }
+}
+
+/*!
+ * Returns true when the isosurface does not cross the cell, or when the
+ * values of the cell differ by at most maxError from the trilinear
+ * interpolation of the values of its 8 corners, along the indices. The cell
+ * ends at the last points of the tensor, see clamp.
+ */
+template <typename TValue>
+bool AdaptiveExtraction<TValue>::isAccurate(const Index3D &origin,
+                                            size_t size) const {
+  const auto end = clamp({{origin[X] + size, origin[Y] + size,
+                           origin[Z] + size}});
+  bool hasBelow = false;
+  bool hasAbove = false;
+  for (size_t z = origin[Z]; z <= end[Z]; ++z) {
+    for (size_t y = origin[Y]; y <= end[Y]; ++y) {
+      for (size_t x = origin[X]; x <= end[X]; ++x) {
+        (tensor.value(x, y, z) < isoValue ? hasBelow : hasAbove) = true;
+      }
+    }
+  }
+  if (!hasBelow || !hasAbove) {
+    return true;
+  }
+  std::array<double, 8> corners;
+  for (size_t iCorner = 0; iCorner < 8; ++iCorner) {
+    corners[iCorner] = tensor.value(iCorner & 1 ? end[X] : origin[X],
+                                    (iCorner >> 1) & 1 ? end[Y] : origin[Y],
+                                    (iCorner >> 2) & 1 ? end[Z] : origin[Z]);
+  }
+  const auto lerp = [](double a, double b, double t) {
+    return a + (b - a) * t;
+  };
+  Vector3D scales;
+  for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    scales[iDim] = 1.0 / static_cast<double>(end[iDim] - origin[iDim]);
+  }
+  for (size_t z = 0; z <= end[Z] - origin[Z]; ++z) {
+    const auto tz = static_cast<double>(z) * scales[Z];
+    for (size_t y = 0; y <= end[Y] - origin[Y]; ++y) {
+      const auto ty = static_cast<double>(y) * scales[Y];
+      const auto v0 = lerp(lerp(corners[0], corners[2], ty),
+                           lerp(corners[4], corners[6], ty), tz);
+      const auto v1 = lerp(lerp(corners[1], corners[3], ty),
+                           lerp(corners[5], corners[7], ty), tz);
+      for (size_t x = 0; x <= end[X] - origin[X]; ++x) {
+        const auto interpolated =
+            lerp(v0, v1, static_cast<double>(x) * scales[X]);
+        const double value =
+            tensor.value(origin[X] + x, origin[Y] + y, origin[Z] + z);
+        if (std::abs(value - interpolated) > maxError) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/*!
+ * Returns true when a cell touching the cell of origin and level, by a face,
+ * an edge or a vertex, is more than 2 times smaller.
+ */
+template <typename TValue>
+bool AdaptiveExtraction<TValue>::hasSmallerNeighbour(
+    const Index3D &origin, std::uint8_t level) const {
+  const size_t size = size_t{1} << level;
+  Index3D begin;
+  Index3D end;
+  for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    begin[iDim] = origin[iDim] > 0 ? origin[iDim] - 1 : 0;
+    end[iDim] = std::min(origin[iDim] + size + 1, cellCounts[iDim]);
+  }
+  Index3D cube;
+  for (cube[Z] = begin[Z]; cube[Z] < end[Z]; ++cube[Z]) {
+    const bool insideZ = cube[Z] >= origin[Z] && cube[Z] < origin[Z] + size;
+    for (cube[Y] = begin[Y]; cube[Y] < end[Y]; ++cube[Y]) {
+      const bool insideY = cube[Y] >= origin[Y] && cube[Y] < origin[Y] + size;
+      // Inside the cell along Y and Z, only the 2 cubes before and after it
+      // along X are neighbours.
+      const size_t step = insideY && insideZ ? size + 1 : 1;
+      for (cube[X] = begin[X]; cube[X] < end[X]; cube[X] += step) {
+        if (levelAt(cube) + 1 < level) {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+/*!
+ * Splits the cells until the octree is balanced. The cells to check are kept
+ * in a stack: when a cell is split, its children and the cells that touch it
+ * are checked again, since the splits of the cells along the last points may
+ * cascade far along them.
+ */
+template <typename TValue> void AdaptiveExtraction<TValue>::balance() {
+  std::vector<Index3D> cells;
+  std::vector<bool> isQueued(levels.size(), false);
+  const auto queue = [&cells, &isQueued, this](const Index3D &origin) {
+    if (!isQueued[cellIndex(origin)]) {
+      isQueued[cellIndex(origin)] = true;
+      cells.push_back(origin);
+    }
+  };
+  forEachCell([&queue](const Index3D &origin, std::uint8_t level) {
+    if (level > 0) {
+      queue(origin);
+    }
+  });
+  while (!cells.empty()) {
+    // Levels only decrease, so origin is still the origin of a cell.
+    const auto origin = cells.back();
+    cells.pop_back();
+    isQueued[cellIndex(origin)] = false;
+    const auto level = levelAt(origin);
+    if (level == 0 || !hasSmallerNeighbour(origin, level)) {
+      continue;
+    }
+    split(origin, level);
+    const size_t size = size_t{1} << level;
+    Index3D begin;
+    Index3D end;
+    for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+      begin[iDim] = origin[iDim] > 0 ? origin[iDim] - 1 : 0;
+      end[iDim] = std::min(origin[iDim] + size + 1, cellCounts[iDim]);
+    }
+    Index3D cube;
+    for (cube[Z] = begin[Z]; cube[Z] < end[Z]; ++cube[Z]) {
+      for (cube[Y] = begin[Y]; cube[Y] < end[Y]; ++cube[Y]) {
+        for (cube[X] = begin[X]; cube[X] < end[X]; ++cube[X]) {
+          const auto cubeLevel = levelAt(cube);
+          if (cubeLevel > 0) {
+            const size_t mask = ~((size_t{1} << cubeLevel) - 1);
+            queue({{cube[X] & mask, cube[Y] & mask, cube[Z] & mask}});
+          }
+        }
+      }
+    }
+  }
+}
+
+/*!
+ * Returns true when point is a corner of one of the cells around it. point
+ * is not clamped: after the last points, it is a corner of the cells that
+ * cross them.
+ */
+template <typename TValue>
+bool AdaptiveExtraction<TValue>::isCorner(const Index3D &point) const {
+  for (size_t iCube = 0; iCube < 8; ++iCube) {
+    Index3D cube;
+    bool isAround = true;
+    for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+      const bool before = (iCube >> iDim) & 1;
+      isAround = isAround && (before ? point[iDim] > 0
+                                     : point[iDim] < cellCounts[iDim]);
+      cube[iDim] = before ? std::min(point[iDim], cellCounts[iDim]) - 1
+                          : point[iDim];
+    }
+    if (!isAround) {
+      continue;
+    }
+    const size_t size = size_t{1} << levelAt(cube);
+    bool isCellCorner = true;
+    for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+      const auto origin = cube[iDim] & ~(size - 1);
+      isCellCorner = isCellCorner && (point[iDim] == origin ||
+                                      point[iDim] == origin + size);
+    }
+    if (isCellCorner) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*!
+ * Returns the sample of point, once clamped to the last points of the
+ * tensor.
+ */
+template <typename TValue>
+Sample
+AdaptiveExtraction<TValue>::pointSample(const Index3D &unclampedPoint) const {
+  const auto point = clamp(unclampedPoint);
+  return {point[X] + tensor.size(X) * (point[Y] + tensor.size(Y) * point[Z]),
+          static_cast<double>(tensor.value(point[X], point[Y], point[Z])),
+          {{grid.values[X][point[X]], grid.values[Y][point[Y]],
+            grid.values[Z][point[Z]]}}};
+}
+
+/*!
+ * Returns the centre of the cube, whose value is the average of its 8
+ * corners.
+ */
+template <typename TValue>
+Sample
+AdaptiveExtraction<TValue>::cubeCentreSample(const Index3D &cube) const {
+  double value = 0.0;
+  for (size_t iCorner = 0; iCorner < 8; ++iCorner) {
+    value += tensor.value(cube[X] + (iCorner & 1),
+                          cube[Y] + ((iCorner >> 1) & 1),
+                          cube[Z] + ((iCorner >> 2) & 1));
+  }
+  Point3D point;
+  for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    point[iDim] = 0.5 * (grid.values[iDim][cube[iDim]] +
+                         grid.values[iDim][cube[iDim] + 1]);
+  }
+  return {pointCount + cellIndex(cube), value / 8.0, point};
+}
+
+/*!
+ * Splits the cell into tetrahedra and calculates the isosurface in each of
+ * them.
+ *
+ * A face is a fan of triangles around its centre when the corners of the
+ * cells around it include its centre or the middles of its edges: this is
+ * the case when the face, or one of its edges, is shared with cells 2 times
+ * smaller. Otherwise, it is split in 2 triangles by the diagonal through the
+ * centre of the face 2 times larger that contains it, which is the centre of
+ * the fan of the face of a cell 2 times larger. The triangles of a face are
+ * thus the same on both of its sides.
+ *
+ * The diagonals of the faces that are not fans all pass through the corner
+ * of the cell at the centre of the cell 2 times larger that contains it, or
+ * through the opposite corner: when no face is a fan, the cell is split in 6
+ * tetrahedra around this diagonal. Otherwise, it is split from its centre to
+ * the triangles of its faces.
+ */
+template <typename TValue>
+void AdaptiveExtraction<TValue>::extractCell(const Index3D &origin,
+                                             size_t size) {
+  const size_t half = size / 2;
+  // The corner of the cell at the centre of its parent.
+  Index3D parentCentre;
+  for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    parentCentre[iDim] =
+        origin[iDim] % (2 * size) == 0 ? origin[iDim] + size : origin[iDim];
+  }
+  std::array<std::array<Sample, 8>, 2 * DIM_COUNT> boundaries;
+  std::array<size_t, 2 * DIM_COUNT> boundaryCounts;
+  std::array<Index3D, 2 * DIM_COUNT> faceCentres;
+  std::array<bool, 2 * DIM_COUNT> isFan;
+  bool hasFan = false;
+  for (size_t iFace = 0; iFace < 2 * DIM_COUNT; ++iFace) {
+    const size_t axis = iFace / 2;
+    const size_t u = (axis + 1) % DIM_COUNT;
+    const size_t v = (axis + 2) % DIM_COUNT;
+    Index3D corner = origin;
+    corner[axis] += (iFace % 2) * size;
+    const auto facePoint = [&corner, u, v](size_t du, size_t dv) {
+      Index3D point = corner;
+      point[u] += du;
+      point[v] += dv;
+      return point;
+    };
+    // The corners in order, from the one at the centre of the parent face,
+    // through which passes the diagonal when the face is not a fan.
+    const size_t ku = parentCentre[u] - origin[u];
+    const size_t kv = parentCentre[v] - origin[v];
+    const std::array<std::array<size_t, 2>, 4> corners{
+        {{{ku, kv}}, {{size - kv, ku}}, {{size - ku, size - kv}},
+         {{kv, size - ku}}}};
+    auto &boundary = boundaries[iFace];
+    auto &boundaryCount = boundaryCounts[iFace];
+    boundaryCount = 0;
+    isFan[iFace] = false;
+    for (size_t iCorner = 0; iCorner < 4; ++iCorner) {
+      const auto &from = corners[iCorner];
+      const auto &to = corners[(iCorner + 1) % 4];
+      boundary[boundaryCount++] = pointSample(facePoint(from[0], from[1]));
+      if (size >= 2) {
+        const auto middle =
+            facePoint((from[0] + to[0]) / 2, (from[1] + to[1]) / 2);
+        if (isCorner(middle)) {
+          boundary[boundaryCount++] = pointSample(middle);
+          isFan[iFace] = true;
+        }
+      }
+    }
+    faceCentres[iFace] = facePoint(half, half);
+    isFan[iFace] =
+        isFan[iFace] || (size >= 2 && isCorner(faceCentres[iFace]));
+    hasFan = hasFan || isFan[iFace];
+  }
+
+  if (!hasFan) {
+    // 6 tetrahedra from the corner at the centre of the parent to the
+    // opposite corner, one for each order of the axes.
+    Index3D opposite;
+    for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+      opposite[iDim] = 2 * origin[iDim] + size - parentCentre[iDim];
+    }
+    const auto start = pointSample(parentCentre);
+    const auto end = pointSample(opposite);
+    for (size_t first = 0; first < DIM_COUNT; ++first) {
+      for (size_t iSecond = 1; iSecond < DIM_COUNT; ++iSecond) {
+        const size_t second = (first + iSecond) % DIM_COUNT;
+        auto point = parentCentre;
+        point[first] = opposite[first];
+        const auto firstStep = pointSample(point);
+        point[second] = opposite[second];
+        marchTetrahedron(start, firstStep, pointSample(point), end);
+      }
+    }
+    return;
+  }
+
+  const auto centre =
+      size >= 2 ? pointSample({{origin[X] + half, origin[Y] + half,
+                                origin[Z] + half}})
+                : cubeCentreSample(origin);
+  for (size_t iFace = 0; iFace < 2 * DIM_COUNT; ++iFace) {
+    const auto &boundary = boundaries[iFace];
+    const auto count = boundaryCounts[iFace];
+    if (isFan[iFace]) {
+      const auto faceCentre = pointSample(faceCentres[iFace]);
+      for (size_t i = 0; i < count; ++i) {
+        marchTetrahedron(centre, faceCentre, boundary[i],
+                         boundary[(i + 1) % count]);
+      }
+    } else {
+      marchTetrahedron(centre, boundary[0], boundary[1], boundary[2]);
+      marchTetrahedron(centre, boundary[0], boundary[2], boundary[3]);
+    }
+  }
+}
+
+/*!
+ * Calculates the isosurface in the tetrahedron, with 1 triangle when 1 of
+ * its vertices is on a side of the isosurface, and 2 when 2 are.
+ */
+template <typename TValue>
+void AdaptiveExtraction<TValue>::marchTetrahedron(const Sample &a,
+                                                  const Sample &b,
+                                                  const Sample &c,
+                                                  const Sample &d) {
+  std::array<const Sample *, 4> below;
+  std::array<const Sample *, 4> above;
+  size_t belowCount = 0;
+  size_t aboveCount = 0;
+  for (const auto *sample : {&a, &b, &c, &d}) {
+    (sample->value < isoValue ? below[belowCount++] : above[aboveCount++]) =
+        sample;
+  }
+  if (belowCount == 0 || aboveCount == 0) {
+    return;
+  }
+  // From the centroid of the vertices below to the one of the vertices above.
+  Vector3D direction{{0.0, 0.0, 0.0}};
+  for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    for (size_t i = 0; i < belowCount; ++i) {
+      direction[iDim] -= below[i]->point[iDim] / belowCount;
+    }
+    for (size_t i = 0; i < aboveCount; ++i) {
+      direction[iDim] += above[i]->point[iDim] / aboveCount;
+    }
+  }
+  if (belowCount == 1 || aboveCount == 1) {
+    const auto &lone = belowCount == 1 ? *below[0] : *above[0];
+    const auto &others = belowCount == 1 ? above : below;
+    addTriangle(edgeVertex(lone, *others[0]), edgeVertex(lone, *others[1]),
+                edgeVertex(lone, *others[2]), direction);
+    return;
+  }
+  const auto ac = edgeVertex(*below[0], *above[0]);
+  const auto ad = edgeVertex(*below[0], *above[1]);
+  const auto bd = edgeVertex(*below[1], *above[1]);
+  const auto bc = edgeVertex(*below[1], *above[0]);
+  addTriangle(ac, ad, bd, direction);
+  addTriangle(ac, bd, bc, direction);
+}
+
+/*!
+ * Returns the index of the point of the isosurface on the edge from a to b,
+ * which is interpolated from the end of smaller key, so that it is the same
+ * in all the tetrahedra around the edge.
+ */
+template <typename TValue>
+std::uint32_t AdaptiveExtraction<TValue>::edgeVertex(const Sample &a,
+                                                     const Sample &b) {
+  const auto &from = a.key < b.key ? a : b;
+  const auto &to = a.key < b.key ? b : a;
+  const auto edgeKey = (from.key << 32) | to.key;
+  const auto vertexCount = static_cast<std::uint32_t>(mesh.vertices.size());
+  const auto inserted = edgeVertices.emplace(edgeKey, vertexCount);
+  if (inserted.second) {
+    const auto t = (isoValue - from.value) / (to.value - from.value);
+    Point3D point;
+    for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+      point[iDim] = from.point[iDim] + t * (to.point[iDim] - from.point[iDim]);
+    }
+    mesh.vertices.push_back(point);
+  }
+  return inserted.first->second;
+}
+
+/*!
+ * Adds the triangle, oriented so that its normal points to direction, i.e.
+ * towards the values above the isosurface.
+ */
+template <typename TValue>
+void AdaptiveExtraction<TValue>::addTriangle(std::uint32_t i0,
+                                             std::uint32_t i1,
+                                             std::uint32_t i2,
+                                             const Vector3D &direction) {
+  const auto &p0 = mesh.vertices[i0];
+  const auto &p1 = mesh.vertices[i1];
+  const auto &p2 = mesh.vertices[i2];
+  const Vector3D e1{{p1[X] - p0[X], p1[Y] - p0[Y], p1[Z] - p0[Z]}};
+  const Vector3D e2{{p2[X] - p0[X], p2[Y] - p0[Y], p2[Z] - p0[Z]}};
+  const Vector3D normal{{e1[Y] * e2[Z] - e1[Z] * e2[Y],
+                         e1[Z] * e2[X] - e1[X] * e2[Z],
+                         e1[X] * e2[Y] - e1[Y] * e2[X]}};
+  const auto orientation = normal[X] * direction[X] +
+                           normal[Y] * direction[Y] +
+                           normal[Z] * direction[Z];
+  if (orientation < 0.0) {
+    mesh.triangles.push_back({{i0, i2, i1}});
+  } else {
+    mesh.triangles.push_back({{i0, i1, i2}});
+  }
+}
+
+template <typename TValue> IndexedMesh AdaptiveExtraction<TValue>::extract() {
+  forEachCell([this](const Index3D &origin, std::uint8_t level) {
+    extractCell(origin, size_t{1} << level);
+  });
+  return std::move(mesh);
+}
+
+template <typename TValue>
+IndexedMesh
+AdaptiveMarchingCubes::isoSurfaceMesh(const Grid3D &grid,
+                                      const BasicTensor3D<TValue> &tensor,
+                                      double isoValue) const {
+  for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    assert(grid.values[iDim].size() == tensor.size(iDim));
+    if (tensor.size(iDim) < 2) {
+      return {}; // No cube in the tensor.
+    }
+  }
+  AdaptiveExtraction<TValue> extraction{grid, tensor, isoValue, error};
+  extraction.build(cellSize);
+  extraction.balance();
+  return extraction.extract();
+}
+
+template IndexedMesh AdaptiveMarchingCubes::isoSurfaceMesh(const Grid3D &,
+                                                           const Tensor3D &,
+                                                           double) const;
+template IndexedMesh
+AdaptiveMarchingCubes::isoSurfaceMesh(const Grid3D &, const Tensor3DFloat &,
+                                      double) const;
+template IndexedMesh
+AdaptiveMarchingCubes::isoSurfaceMesh(const Grid3D &, const Tensor3DUint8 &,
+                                      double) const;
+template IndexedMesh
+AdaptiveMarchingCubes::isoSurfaceMesh(const Grid3D &, const Tensor3DInt16 &,
+                                      double) const;
+template IndexedMesh
+AdaptiveMarchingCubes::isoSurfaceMesh(const Grid3D &, const Tensor3DUint16 &,
+                                      double) const;
+
+} // namespace marchingcubes
@@ -0,0 +1,105 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/BrickedTensor3D.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace marchingcubes {
+
+static size_t ceilDiv(size_t numerator, size_t denominator) {
+  return (numerator + denominator - 1) / denominator;
+}
+
+BrickLayout::BrickLayout(const std::array<size_t, DIM_COUNT> &size,
+                         size_t brickSize)
+    : mSize{size}, mBrickSize{brickSize} {
+  assert(brickSize > 0);
+  for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    // A tensor of 1 value along an axis has 1 brick without cubes.
+    mBrickCount[iDim] =
+        std::max<size_t>(1, ceilDiv(mSize[iDim] - 1, brickSize));
+  }
+}
+
+IndexBox BrickLayout::brickBox(size_t bx, size_t by, size_t bz) const {
+  const std::array<size_t, DIM_COUNT> brick{{bx, by, bz}};
+  IndexBox box;
+  for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    assert(brick[iDim] < mBrickCount[iDim]);
+    box.begin[iDim] = brick[iDim] * mBrickSize;
+    box.end[iDim] = std::min(box.begin[iDim] + mBrickSize + 1, mSize[iDim]);
+  }
+  return box;
+}
+
+std::pair<size_t, size_t> BrickLayout::locate(size_t x, size_t y,
+                                              size_t z) const {
+  const std::array<size_t, DIM_COUNT> indices{{x, y, z}};
+  std::array<size_t, DIM_COUNT> brick;
+  std::array<size_t, DIM_COUNT> inBrick;
+  for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    assert(indices[iDim] < mSize[iDim]);
+    // The last values of the tensor are in the upper faces of the last
+    // bricks.
+    brick[iDim] = std::min(indices[iDim] / mBrickSize, mBrickCount[iDim] - 1);
+    inBrick[iDim] = indices[iDim] - brick[iDim] * mBrickSize;
+  }
+  return std::make_pair(
+      brickIndex(brick[X], brick[Y], brick[Z]),
+      inBrick[X] + rowSize() * (inBrick[Y] + rowSize() * inBrick[Z]));
+}
+
+template <typename TValue>
+BasicBrickedTensor3D<TValue>::BasicBrickedTensor3D(
+    const BasicTensor3DView<TValue> &view, size_t brickSize)
+    : mLayout{{{view.size(X), view.size(Y), view.size(Z)}}, brickSize} {
+  values.resize(mLayout.brickCount() * mLayout.brickValueCount());
+  minMax.resize(mLayout.brickCount());
+  const auto rowSize = mLayout.rowSize();
+  for (size_t bz = 0; bz < mLayout.brickCount(Z); ++bz) {
+    for (size_t by = 0; by < mLayout.brickCount(Y); ++by) {
+      for (size_t bx = 0; bx < mLayout.brickCount(X); ++bx) {
+        const auto box = mLayout.brickBox(bx, by, bz);
+        const auto brickIndex = mLayout.brickIndex(bx, by, bz);
+        auto *brick = values.data() + brickIndex * mLayout.brickValueCount();
+        auto min = static_cast<double>(
+            view.value(box.begin[X], box.begin[Y], box.begin[Z]));
+        auto max = min;
+        for (size_t z = 0; z < box.size(Z); ++z) {
+          for (size_t y = 0; y < box.size(Y); ++y) {
+            auto *row = brick + rowSize * (y + rowSize * z);
+            for (size_t x = 0; x < box.size(X); ++x) {
+              row[x] = view.value(box.begin[X] + x, box.begin[Y] + y,
+                                  box.begin[Z] + z);
+              min = std::min(min, static_cast<double>(row[x]));
+              max = std::max(max, static_cast<double>(row[x]));
+            }
+          }
+        }
+        minMax[brickIndex] = std::make_pair(min, max);
+      }
+    }
+  }
+}
+
+template <typename TValue>
+TValue BasicBrickedTensor3D<TValue>::value(size_t x, size_t y,
+                                           size_t z) const {
+  const auto [brickIndex, index] = mLayout.locate(x, y, z);
+  return values[brickIndex * mLayout.brickValueCount() + index];
+}
+
+template class BasicBrickedTensor3D<double>;
+template class BasicBrickedTensor3D<float>;
+template class BasicBrickedTensor3D<std::uint8_t>;
+template class BasicBrickedTensor3D<std::int16_t>;
+template class BasicBrickedTensor3D<std::uint16_t>;
+
+} // namespace marchingcubes
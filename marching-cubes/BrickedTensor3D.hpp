@@ -0,0 +1,159 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include "marching-cubes/Tensor3D.hpp"
+
+#include <array>
+#include <utility>
+#include <vector>
+
+namespace marchingcubes {
+
+/*!
+ * \class BrickLayout
+ * \brief The class BrickLayout splits the cubes of a tensor into bricks of
+ * brickSize^3 cubes.
+ *
+ * The brick (bx, by, bz) contains the cubes whose vertex 0 has the indices
+ * [bx * brickSize, (bx + 1) * brickSize) x [by * brickSize, ...) x ...,
+ * like the bricks of MinMaxHierarchy. The values of a brick are the
+ * (brickSize + 1)^3 values of the vertices of its cubes, X first, then Y,
+ * then Z, in rows of rowSize() values: the values of the upper faces of a
+ * brick are also values of its neighbours, so that each brick can be
+ * traversed on its own. The bricks are indexed in Z, Y, X order.
+ */
+class BrickLayout {
+
+public:
+  BrickLayout(const std::array<size_t, DIM_COUNT> &size, size_t brickSize);
+
+public:
+  size_t size(size_t dimIndex) const { return mSize.at(dimIndex); }
+  size_t brickSize() const { return mBrickSize; }
+  size_t brickCount(size_t dimIndex) const {
+    return mBrickCount.at(dimIndex);
+  }
+  size_t brickCount() const {
+    return mBrickCount[X] * mBrickCount[Y] * mBrickCount[Z];
+  }
+  size_t brickIndex(size_t bx, size_t by, size_t bz) const {
+    return bx + mBrickCount[X] * (by + mBrickCount[Y] * bz);
+  }
+
+  /*!
+   * Returns the indices of the vertices of the brick in the tensor.
+   */
+  IndexBox brickBox(size_t bx, size_t by, size_t bz) const;
+
+  /*!
+   * The number of values of a row of a brick, and of rows of a layer.
+   */
+  size_t rowSize() const { return mBrickSize + 1; }
+  size_t brickValueCount() const { return rowSize() * rowSize() * rowSize(); }
+
+  /*!
+   * Returns the brick that stores the value (x, y, z) of the tensor, and the
+   * index of this value in the values of the brick.
+   */
+  std::pair<size_t, size_t> locate(size_t x, size_t y, size_t z) const;
+
+private:
+  std::array<size_t, DIM_COUNT> mSize;
+  size_t mBrickSize;
+  std::array<size_t, DIM_COUNT> mBrickCount;
+};
+
+/*!
+ * \class BasicBrickedTensor3D
+ * \brief The class BasicBrickedTensor3D stores the values of a tensor brick
+ * by brick, so that the values of the cubes of a brick are close in memory.
+ *
+ * The bricks are the ones of BrickLayout, and the bricks on the upper
+ * borders of the tensor are stored with the same size as the others.
+ *
+ * MarchingCubes::isoSurface traverses a bricked tensor brick by brick: the
+ * values of the 4 rows of a row of cubes are in the same few pages, instead
+ * of being a slice apart, and the bricks whose min and max values are on the
+ * same side of the isovalue are skipped.
+ *
+ * With bricks of 16^3 cubes, the values take (17 / 16)^3, about 1.2 times,
+ * the memory of the tensor.
+ */
+template <typename TValue> class BasicBrickedTensor3D {
+
+public:
+  using Value = TValue;
+
+public:
+  explicit BasicBrickedTensor3D(const BasicTensor3DView<TValue> &view,
+                                size_t brickSize = 16);
+  explicit BasicBrickedTensor3D(const BasicTensor3D<TValue> &tensor,
+                                size_t brickSize = 16)
+      : BasicBrickedTensor3D{BasicTensor3DView<TValue>{tensor}, brickSize} {}
+
+public:
+  const BrickLayout &layout() const { return mLayout; }
+  size_t size(size_t dimIndex) const { return mLayout.size(dimIndex); }
+  size_t brickSize() const { return mLayout.brickSize(); }
+  size_t brickCount(size_t dimIndex) const {
+    return mLayout.brickCount(dimIndex);
+  }
+  IndexBox brickBox(size_t bx, size_t by, size_t bz) const {
+    return mLayout.brickBox(bx, by, bz);
+  }
+
+  /*!
+   * Returns the (brickSize + 1)^3 values of the brick: the value of the
+   * vertex (x, y, z) of the brick box is at x + (brickSize + 1) * (y +
+   * (brickSize + 1) * z).
+   */
+  const TValue *brickValues(size_t bx, size_t by, size_t bz) const {
+    return values.data() +
+           mLayout.brickIndex(bx, by, bz) * mLayout.brickValueCount();
+  }
+
+  /*!
+   * Returns the min and max of the values of the brick.
+   */
+  std::pair<double, double> brickMinMax(size_t bx, size_t by,
+                                        size_t bz) const {
+    return minMax[mLayout.brickIndex(bx, by, bz)];
+  }
+
+  /*!
+   * Returns false when no cube of the brick can intersect the isosurface for
+   * isoValue, like MinMaxHierarchy::mayIntersect.
+   */
+  bool mayIntersect(size_t bx, size_t by, size_t bz, double isoValue) const {
+    auto [min, max] = brickMinMax(bx, by, bz);
+    return min < isoValue && isoValue <= max;
+  }
+
+  TValue value(size_t x, size_t y, size_t z) const;
+
+private:
+  BrickLayout mLayout;
+  std::vector<TValue> values;
+  std::vector<std::pair<double, double>> minMax;
+};
+
+using BrickedTensor3D = BasicBrickedTensor3D<double>;
+using BrickedTensor3DFloat = BasicBrickedTensor3D<float>;
+using BrickedTensor3DUint8 = BasicBrickedTensor3D<std::uint8_t>;
+using BrickedTensor3DInt16 = BasicBrickedTensor3D<std::int16_t>;
+using BrickedTensor3DUint16 = BasicBrickedTensor3D<std::uint16_t>;
+
+extern template class BasicBrickedTensor3D<double>;
+extern template class BasicBrickedTensor3D<float>;
+extern template class BasicBrickedTensor3D<std::uint8_t>;
+extern template class BasicBrickedTensor3D<std::int16_t>;
+extern template class BasicBrickedTensor3D<std::uint16_t>;
+
+} // namespace marchingcubes
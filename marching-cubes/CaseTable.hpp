@@ -0,0 +1,300 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include "marching-cubes/Cube.hpp"
+#include "marching-cubes/Triangle.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace marchingcubes::casetable {
+
+constexpr std::size_t CONFIG_COUNT = 256;
+constexpr std::size_t BASE_CONFIG_COUNT = 15;
+constexpr std::size_t MAX_TRIANGLE_COUNT = 4;
+constexpr std::size_t PERMUTATION_COUNT = 48;
+
+using VertexPermutation = std::array<std::uint8_t, cube::VERTEX_COUNT>;
+
+/*!
+ * \class BaseCase
+ * \brief The class BaseCase stores one of the 15 base cube configurations,
+ * and the triangles that approximate the isosurface within the cube.
+ */
+struct BaseCase {
+  std::uint8_t config;
+  std::size_t triangleCount;
+  std::array<cube::Edge, MAX_TRIANGLE_COUNT * triangle::POINT_COUNT> edges;
+};
+
+/**
+ * The 15 base configurations, sorted by number of positive vertices, see
+ * https://en.wikipedia.org/wiki/Marching_cubes
+ *
+ *      6_____7
+ *     /|    /|        z
+ *    4_____5 |        |  y
+ *    | |   | |        | /
+ *    | |   | |        |/
+ *    | |   | |        #----- x
+ *    | 2___|_3
+ *    |/    |/
+ *    0_____1
+ */
+constexpr std::array<BaseCase, BASE_CONFIG_COUNT> BASE_CASES{{
+    // 0 element: from 0 until 1
+    {0b00000000, 0, {}},
+    // 1 element: from 1 until 2
+    {cube::configurationFromPositiveVertices(0),
+     1,
+     {{cube::e01, cube::e02, cube::e04}}},
+    // 2 elements: from 2 until 5
+    {cube::configurationFromPositiveVertices(0, 1),
+     2,
+     {{cube::e02, cube::e04, cube::e15, cube::e02, cube::e13, cube::e15}}},
+    {cube::configurationFromPositiveVertices(0, 5),
+     2,
+     {{cube::e01, cube::e02, cube::e04, cube::e45, cube::e57, cube::e15}}},
+    {cube::configurationFromPositiveVertices(0, 7),
+     2,
+     {{cube::e01, cube::e02, cube::e04, cube::e37, cube::e57, cube::e67}}},
+    // 3 elements: from 5 until 8
+    {cube::configurationFromPositiveVertices(1, 2, 3),
+     3,
+     {{cube::e01, cube::e02, cube::e15, cube::e02, cube::e15, cube::e26,
+       cube::e15, cube::e37, cube::e26}}},
+    {cube::configurationFromPositiveVertices(0, 1, 7),
+     3,
+     {{cube::e02, cube::e04, cube::e13, cube::e04, cube::e13, cube::e15,
+       cube::e37, cube::e57, cube::e67}}},
+    {cube::configurationFromPositiveVertices(1, 4, 7),
+     3,
+     {{cube::e01, cube::e13, cube::e15, cube::e04, cube::e45, cube::e46,
+       cube::e37, cube::e57, cube::e67}}},
+    // 4 elements: from 8 until 15
+    {cube::configurationFromPositiveVertices(0, 1, 2, 3),
+     2,
+     {{cube::e04, cube::e15, cube::e26, cube::e15, cube::e37, cube::e26}}},
+    {cube::configurationFromPositiveVertices(1, 2, 3, 4),
+     4,
+     {{cube::e04, cube::e45, cube::e46, cube::e01, cube::e02, cube::e15,
+       cube::e02, cube::e15, cube::e37, cube::e15, cube::e26, cube::e37}}},
+    {cube::configurationFromPositiveVertices(0, 3, 5, 6),
+     4,
+     {{cube::e01, cube::e02, cube::e04, cube::e13, cube::e23, cube::e37,
+       cube::e15, cube::e45, cube::e57, cube::e26, cube::e46, cube::e67}}},
+    {cube::configurationFromPositiveVertices(0, 2, 3, 6),
+     4,
+     {{cube::e04, cube::e46, cube::e67, cube::e01, cube::e04, cube::e67,
+       cube::e01, cube::e37, cube::e67, cube::e01, cube::e13, cube::e37}}},
+    {cube::configurationFromPositiveVertices(1, 2, 3, 6),
+     4,
+     {{cube::e01, cube::e02, cube::e46, cube::e01, cube::e37, cube::e46,
+       cube::e37, cube::e46, cube::e67, cube::e01, cube::e15, cube::e37}}},
+    {cube::configurationFromPositiveVertices(0, 3, 4, 7),
+     4,
+     {{cube::e01, cube::e02, cube::e46, cube::e01, cube::e45, cube::e46,
+       cube::e13, cube::e23, cube::e67, cube::e13, cube::e57, cube::e67}}},
+    {cube::configurationFromPositiveVertices(0, 2, 3, 7),
+     4,
+     {{cube::e01, cube::e04, cube::e26, cube::e01, cube::e26, cube::e57,
+       cube::e26, cube::e57, cube::e67, cube::e01, cube::e13, cube::e57}}},
+}};
+
+/*!
+ * Index in BASE_CASES of the first base configuration with a given number of
+ * positive vertices.
+ */
+constexpr std::array<std::size_t, 6> BASE_START_BY_POSITIVE_COUNT{
+    {0, 1, 2, 5, 8, 15}};
+
+/*!
+ * The start and end vertices of each cube::Edge.
+ */
+constexpr std::array<std::array<std::uint8_t, 2>, cube::EDGE_COUNT>
+    EDGE_VERTICES{{{{0, 1}},
+                   {{0, 2}},
+                   {{0, 4}},
+                   {{1, 3}},
+                   {{1, 5}},
+                   {{2, 3}},
+                   {{2, 6}},
+                   {{3, 7}},
+                   {{4, 5}},
+                   {{4, 6}},
+                   {{5, 7}},
+                   {{6, 7}}}};
+
+/*!
+ * Returns the permutation p such that p[i] = other[permutation[i]], like
+ * utils::applyPermutation.
+ */
+constexpr VertexPermutation
+applyPermutation(const VertexPermutation &permutation,
+                 const VertexPermutation &other) {
+  VertexPermutation result{};
+  for (std::size_t i = 0; i < result.size(); ++i) {
+    result[i] = other[permutation[i]];
+  }
+  return result;
+}
+
+/*!
+ * Returns the configuration whose vertex i has the sign of the vertex
+ * permutation[i] of config, like utils::applyPermutation.
+ */
+constexpr std::uint8_t applyPermutation(const VertexPermutation &permutation,
+                                        std::uint8_t config) {
+  unsigned result = 0;
+  for (std::size_t i = 0; i < permutation.size(); ++i) {
+    result |= ((config >> permutation[i]) & 1u) << i;
+  }
+  return static_cast<std::uint8_t>(result);
+}
+
+/*!
+ * Returns the edge between the vertices permutation[start] and
+ * permutation[end] of the edge, like cube::toPermutatedCube.
+ */
+constexpr cube::Edge permutedEdge(cube::Edge edge,
+                                  const VertexPermutation &permutation) {
+  const auto &vertices = EDGE_VERTICES[static_cast<std::size_t>(edge)];
+  const auto start = permutation[vertices[0]];
+  const auto end = permutation[vertices[1]];
+  for (std::size_t i = 0; i < EDGE_VERTICES.size(); ++i) {
+    if ((EDGE_VERTICES[i][0] == start && EDGE_VERTICES[i][1] == end) ||
+        (EDGE_VERTICES[i][0] == end && EDGE_VERTICES[i][1] == start)) {
+      return static_cast<cube::Edge>(i);
+    }
+  }
+  return edge;
+}
+
+constexpr std::size_t positiveCount(std::uint8_t config) {
+  std::size_t count = 0;
+  for (; config != 0; config &= static_cast<std::uint8_t>(config - 1)) {
+    ++count;
+  }
+  return count;
+}
+
+/*!
+ * Returns the 48 permutations of the vertices that keep the cube edges, in
+ * the order used by ConfigsGenerator: the symmetries that change a0, then the
+ * ones that change a1, then the one that interchanges a2 and a4.
+ */
+constexpr std::array<VertexPermutation, PERMUTATION_COUNT>
+allowedPermutations() {
+  constexpr VertexPermutation identity{{0, 1, 2, 3, 4, 5, 6, 7}};
+  constexpr std::array<std::array<VertexPermutation, 2>, 5> symmetries{{
+      {{{{4, 5, 6, 7, 0, 1, 2, 3}}, identity}},
+      {{{{2, 3, 0, 1, 6, 7, 4, 5}}, identity}},
+      {{{{1, 0, 3, 2, 5, 4, 7, 6}}, identity}},
+      {{{{0, 2, 1, 3, 4, 6, 5, 7}}, {{0, 4, 2, 6, 1, 5, 3, 7}}}},
+      {{{{0, 1, 4, 5, 2, 3, 6, 7}}, identity}},
+  }};
+  // Number of symmetries applied at each level: identity excluded.
+  constexpr std::array<std::size_t, 5> symmetryCounts{{1, 1, 1, 2, 1}};
+
+  std::array<VertexPermutation, PERMUTATION_COUNT> permutations{};
+  permutations[0] = identity;
+  std::size_t count = 1;
+  // Each level replaces every permutation p by p followed by the
+  // permutations obtained by applying the symmetries of the level to p.
+  for (std::size_t level = 0; level < symmetries.size(); ++level) {
+    const auto factor = symmetryCounts[level] + 1;
+    for (std::size_t i = count; i-- > 0;) {
+      const auto permutation = permutations[i];
+      permutations[i * factor] = permutation;
+      for (std::size_t s = 0; s < symmetryCounts[level]; ++s) {
+        permutations[i * factor + 1 + s] =
+            applyPermutation(permutation, symmetries[level][s]);
+      }
+    }
+    count *= factor;
+  }
+  return permutations;
+}
+
+/*!
+ * \class CaseTable
+ * \brief The class CaseTable stores the triangles of the 256 cube
+ * configurations as flat arrays: the triangle i of the configuration c is
+ * made of the intersections with the edges edges[c][3 * i],
+ * edges[c][3 * i + 1] and edges[c][3 * i + 2].
+ */
+struct CaseTable {
+  std::array<std::uint8_t, CONFIG_COUNT> triangleCounts;
+  std::array<std::array<cube::Edge, MAX_TRIANGLE_COUNT * triangle::POINT_COUNT>,
+             CONFIG_COUNT>
+      edges;
+};
+
+/*!
+ * Generates the CaseTable from BASE_CASES, with the same algorithm as
+ * ConfigsGenerator::generateConfigs: each configuration with at most 4
+ * positive vertices is mapped to a base configuration by the first allowed
+ * permutation that matches, and a flipped configuration has the triangles of
+ * the configuration it is flipped from.
+ */
+constexpr CaseTable generateCaseTable() {
+  CaseTable table{};
+  std::array<bool, CONFIG_COUNT> isSet{};
+  auto setCase = [&](std::uint8_t config, std::uint8_t baseConfig,
+                     const VertexPermutation &permutation) {
+    table.triangleCounts[config] = table.triangleCounts[baseConfig];
+    for (std::size_t i = 0; i < table.edges[config].size(); ++i) {
+      table.edges[config][i] =
+          permutedEdge(table.edges[baseConfig][i], permutation);
+    }
+    isSet[config] = true;
+  };
+
+  constexpr VertexPermutation identity{{0, 1, 2, 3, 4, 5, 6, 7}};
+  for (const auto &baseCase : BASE_CASES) {
+    table.triangleCounts[baseCase.config] =
+        static_cast<std::uint8_t>(baseCase.triangleCount);
+    table.edges[baseCase.config] = baseCase.edges;
+    isSet[baseCase.config] = true;
+    setCase(static_cast<std::uint8_t>(~baseCase.config), baseCase.config,
+            identity);
+  }
+
+  const auto permutations = allowedPermutations();
+  for (std::size_t i = 0; i < CONFIG_COUNT; ++i) {
+    const auto config = static_cast<std::uint8_t>(i);
+    const auto count = positiveCount(config);
+    if (isSet[config] || count > 4) {
+      continue;
+    }
+    for (const auto &permutation : permutations) {
+      const auto permutedConfig = applyPermutation(permutation, config);
+      bool found = false;
+      for (auto iBase = BASE_START_BY_POSITIVE_COUNT[count];
+           iBase < BASE_START_BY_POSITIVE_COUNT[count + 1]; ++iBase) {
+        found = found || permutedConfig == BASE_CASES[iBase].config;
+      }
+      if (found) {
+        setCase(config, permutedConfig, permutation);
+        setCase(static_cast<std::uint8_t>(~config), permutedConfig,
+                permutation);
+        break;
+      }
+    }
+  }
+  return table;
+}
+
+/*!
+ * The table used by MarchingCubes, generated at compile time.
+ */
+inline constexpr CaseTable CASE_TABLE = generateCaseTable();
+
+} // namespace marchingcubes::casetable
@@ -0,0 +1,229 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/CompressedTensor3D.hpp"
+
+#include <algorithm>
+
+namespace marchingcubes {
+
+constexpr size_t WORD_BITS = 64;
+
+static std::uint64_t zigzag(std::int64_t difference) {
+  return (static_cast<std::uint64_t>(difference) << 1) ^
+         static_cast<std::uint64_t>(difference >> 63);
+}
+
+static std::int64_t unzigzag(std::uint64_t encoded) {
+  return static_cast<std::int64_t>(encoded >> 1) ^
+         -static_cast<std::int64_t>(encoded & 1);
+}
+
+static std::uint8_t bitCountOf(std::uint64_t value) {
+  std::uint8_t bitCount = 0;
+  for (; value != 0; value >>= 1) {
+    ++bitCount;
+  }
+  return bitCount;
+}
+
+/*!
+ * \class LorenzoPredictor
+ * \brief The class LorenzoPredictor predicts the values of a brick, stored
+ * in rows of rowSize values, from their previous neighbours: the prediction
+ * of v(x, y, z) is extrapolated from the values of the corners of the cube
+ * [x - 1, x] x [y - 1, y] x [z - 1, z] that precede it, e.g.
+ * v(x - 1, y) + v(x, y - 1) - v(x - 1, y - 1) when z = 0. It is exact for
+ * the sums of functions of one axis.
+ */
+template <typename TValue> class LorenzoPredictor {
+
+public:
+  LorenzoPredictor(const TValue *values, size_t rowSize, TValue first)
+      : values{values}, rowStep{rowSize}, layerStep{rowSize * rowSize},
+        first{first} {}
+
+public:
+  std::int64_t predict(size_t index, size_t x, size_t y, size_t z) const {
+    if (x > 0 && y > 0 && z > 0) {
+      return at(index, 1) + at(index, rowStep) + at(index, layerStep) -
+             at(index, 1 + rowStep) - at(index, 1 + layerStep) -
+             at(index, rowStep + layerStep) +
+             at(index, 1 + rowStep + layerStep);
+    }
+    const size_t steps[] = {x > 0 ? size_t{1} : 0, y > 0 ? rowStep : 0,
+                            z > 0 ? layerStep : 0};
+    size_t a = 0;
+    size_t b = 0;
+    for (auto step : steps) {
+      if (step != 0) {
+        (a == 0 ? a : b) = step;
+      }
+    }
+    if (a == 0) {
+      return first;
+    }
+    if (b == 0) {
+      return at(index, a);
+    }
+    return at(index, a) + at(index, b) - at(index, a + b);
+  }
+
+private:
+  std::int64_t at(size_t index, size_t offset) const {
+    return std::int64_t{values[index - offset]};
+  }
+
+private:
+  const TValue *values;
+  const size_t rowStep;
+  const size_t layerStep;
+  const TValue first;
+};
+
+template <typename TValue>
+BasicCompressedTensor3D<TValue>::BasicCompressedTensor3D(
+    const BasicTensor3DView<TValue> &view, size_t brickSize)
+    : mLayout{{{view.size(X), view.size(Y), view.size(Z)}}, brickSize} {
+  bricks.reserve(mLayout.brickCount());
+  const auto rowSize = mLayout.rowSize();
+  std::vector<TValue> values(mLayout.brickValueCount());
+  std::vector<std::uint64_t> encoded(rowSize);
+  size_t bit = 0;
+  for (size_t bz = 0; bz < mLayout.brickCount(Z); ++bz) {
+    for (size_t by = 0; by < mLayout.brickCount(Y); ++by) {
+      for (size_t bx = 0; bx < mLayout.brickCount(X); ++bx) {
+        const auto box = mLayout.brickBox(bx, by, bz);
+        Brick brick;
+        brick.min = view.value(box.begin[X], box.begin[Y], box.begin[Z]);
+        brick.max = brick.min;
+        for (size_t z = 0; z < box.size(Z); ++z) {
+          for (size_t y = 0; y < box.size(Y); ++y) {
+            auto *row = values.data() + rowSize * (y + rowSize * z);
+            for (size_t x = 0; x < box.size(X); ++x) {
+              row[x] = view.value(box.begin[X] + x, box.begin[Y] + y,
+                                  box.begin[Z] + z);
+              brick.min = std::min(brick.min, row[x]);
+              brick.max = std::max(brick.max, row[x]);
+            }
+          }
+        }
+        brick.firstBit = bit;
+        brick.firstRow = rowBitCounts.size();
+        bricks.push_back(brick);
+        if (brick.min == brick.max) {
+          continue; // Constant brick.
+        }
+        const LorenzoPredictor<TValue> predictor{values.data(), rowSize,
+                                                 brick.min};
+        for (size_t z = 0; z < box.size(Z); ++z) {
+          for (size_t y = 0; y < box.size(Y); ++y) {
+            const auto rowIndex = rowSize * (y + rowSize * z);
+            std::uint64_t allBits = 0;
+            for (size_t x = 0; x < box.size(X); ++x) {
+              encoded[x] =
+                  zigzag(std::int64_t{values[rowIndex + x]} -
+                         predictor.predict(rowIndex + x, x, y, z));
+              allBits |= encoded[x];
+            }
+            const auto bitCount = bitCountOf(allBits);
+            rowBitCounts.push_back(bitCount);
+            if (bitCount == 0) {
+              continue; // The row is predicted exactly.
+            }
+            words.resize((bit + box.size(X) * bitCount + WORD_BITS - 1) /
+                         WORD_BITS);
+            for (size_t x = 0; x < box.size(X); ++x, bit += bitCount) {
+              const auto shift = bit % WORD_BITS;
+              words[bit / WORD_BITS] |= encoded[x] << shift;
+              if (shift + bitCount > WORD_BITS) {
+                words[bit / WORD_BITS + 1] |= encoded[x]
+                                              >> (WORD_BITS - shift);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  words.shrink_to_fit();
+  rowBitCounts.shrink_to_fit();
+}
+
+template <typename TValue>
+void BasicCompressedTensor3D<TValue>::decompressBrick(size_t bx, size_t by,
+                                                      size_t bz,
+                                                      TValue *values) const {
+  const auto &brick = bricks[mLayout.brickIndex(bx, by, bz)];
+  const auto box = mLayout.brickBox(bx, by, bz);
+  const auto rowSize = mLayout.rowSize();
+  if (brick.min == brick.max) {
+    for (size_t z = 0; z < box.size(Z); ++z) {
+      for (size_t y = 0; y < box.size(Y); ++y) {
+        std::fill_n(values + rowSize * (y + rowSize * z), box.size(X),
+                    brick.min);
+      }
+    }
+    return;
+  }
+  const LorenzoPredictor<TValue> predictor{values, rowSize, brick.min};
+  const auto *rowBitCount = rowBitCounts.data() + brick.firstRow;
+  auto bit = brick.firstBit;
+  for (size_t z = 0; z < box.size(Z); ++z) {
+    for (size_t y = 0; y < box.size(Y); ++y) {
+      const auto rowIndex = rowSize * (y + rowSize * z);
+      const auto bitCount = *(rowBitCount++);
+      if (bitCount == 0) {
+        for (size_t x = 0; x < box.size(X); ++x) {
+          values[rowIndex + x] =
+              static_cast<TValue>(predictor.predict(rowIndex + x, x, y, z));
+        }
+        continue;
+      }
+      const auto mask = (std::uint64_t{1} << bitCount) - 1;
+      for (size_t x = 0; x < box.size(X); ++x, bit += bitCount) {
+        const auto shift = bit % WORD_BITS;
+        auto encoded = words[bit / WORD_BITS] >> shift;
+        if (shift + bitCount > WORD_BITS) {
+          encoded |= words[bit / WORD_BITS + 1] << (WORD_BITS - shift);
+        }
+        values[rowIndex + x] = static_cast<TValue>(
+            predictor.predict(rowIndex + x, x, y, z) +
+            unzigzag(encoded & mask));
+      }
+    }
+  }
+}
+
+template <typename TValue>
+TValue BasicCompressedTensor3D<TValue>::value(size_t x, size_t y,
+                                              size_t z) const {
+  const auto [brickIndex, index] = mLayout.locate(x, y, z);
+  const auto &brick = bricks[brickIndex];
+  if (brick.min == brick.max) {
+    return brick.min;
+  }
+  const auto bx = brickIndex % mLayout.brickCount(X);
+  const auto by = brickIndex / mLayout.brickCount(X) % mLayout.brickCount(Y);
+  const auto bz = brickIndex / mLayout.brickCount(X) / mLayout.brickCount(Y);
+  std::vector<TValue> values(mLayout.brickValueCount());
+  decompressBrick(bx, by, bz, values.data());
+  return values[index];
+}
+
+template <typename TValue>
+size_t BasicCompressedTensor3D<TValue>::byteCount() const {
+  return words.size() * sizeof(std::uint64_t) + rowBitCounts.size() +
+         bricks.size() * sizeof(Brick);
+}
+
+template class BasicCompressedTensor3D<std::uint8_t>;
+template class BasicCompressedTensor3D<std::int16_t>;
+template class BasicCompressedTensor3D<std::uint16_t>;
+
+} // namespace marchingcubes
@@ -0,0 +1,136 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include "marching-cubes/BrickedTensor3D.hpp"
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace marchingcubes {
+
+/*!
+ * \class BasicCompressedTensor3D
+ * \brief The class BasicCompressedTensor3D stores the values of a tensor of
+ * integers brick by brick, each brick being compressed without loss.
+ *
+ * The bricks are the ones of BrickLayout. Each value of a brick is predicted
+ * from its previous neighbours in the brick by the Lorenzo predictor, e.g.
+ * v(x - 1, y) + v(x, y - 1) - v(x - 1, y - 1) in 2D, which is close to the
+ * value where the values vary smoothly. The differences with the
+ * predictions are zigzag encoded, i.e. 0, -1, 1, -2... become 0, 1, 2,
+ * 3..., and packed with the number of bits of the largest one of their row.
+ * The bricks whose values are all equal are stored as this value only.
+ *
+ * MarchingCubes::isoSurface decompresses the bricks that may intersect the
+ * isosurface one at a time in a buffer of each thread, and skips the
+ * others, in particular the constant bricks, without decompressing them.
+ *
+ * Only the integer value types of BasicTensor3D are supported.
+ */
+template <typename TValue> class BasicCompressedTensor3D {
+  static_assert(std::is_integral_v<TValue>,
+                "The compressed values must be integers");
+
+public:
+  using Value = TValue;
+
+public:
+  explicit BasicCompressedTensor3D(const BasicTensor3DView<TValue> &view,
+                                   size_t brickSize = 16);
+  explicit BasicCompressedTensor3D(const BasicTensor3D<TValue> &tensor,
+                                   size_t brickSize = 16)
+      : BasicCompressedTensor3D{BasicTensor3DView<TValue>{tensor},
+                                brickSize} {}
+
+public:
+  const BrickLayout &layout() const { return mLayout; }
+  size_t size(size_t dimIndex) const { return mLayout.size(dimIndex); }
+  size_t brickSize() const { return mLayout.brickSize(); }
+  size_t brickCount(size_t dimIndex) const {
+    return mLayout.brickCount(dimIndex);
+  }
+  IndexBox brickBox(size_t bx, size_t by, size_t bz) const {
+    return mLayout.brickBox(bx, by, bz);
+  }
+
+  /*!
+   * Returns the min and max of the values of the brick.
+   */
+  std::pair<double, double> brickMinMax(size_t bx, size_t by,
+                                        size_t bz) const {
+    const auto &brick = bricks[mLayout.brickIndex(bx, by, bz)];
+    return std::make_pair(static_cast<double>(brick.min),
+                          static_cast<double>(brick.max));
+  }
+
+  /*!
+   * Returns false when no cube of the brick can intersect the isosurface for
+   * isoValue, like MinMaxHierarchy::mayIntersect. It is always the case for
+   * a constant brick.
+   */
+  bool mayIntersect(size_t bx, size_t by, size_t bz, double isoValue) const {
+    auto [min, max] = brickMinMax(bx, by, bz);
+    return min < isoValue && isoValue <= max;
+  }
+
+  bool isConstant(size_t bx, size_t by, size_t bz) const {
+    const auto &brick = bricks[mLayout.brickIndex(bx, by, bz)];
+    return brick.min == brick.max;
+  }
+
+  /*!
+   * Decompresses the values of the brick into values, which must have room
+   * for layout().brickValueCount() values, with the layout of
+   * BasicBrickedTensor3D::brickValues. The values beyond the brick box, for
+   * the bricks of the upper borders of the tensor, are left unchanged.
+   */
+  void decompressBrick(size_t bx, size_t by, size_t bz, TValue *values) const;
+
+  /*!
+   * Returns the value (x, y, z) of the tensor. It decompresses the brick of
+   * the value: prefer decompressBrick to read many values.
+   */
+  TValue value(size_t x, size_t y, size_t z) const;
+
+  /*!
+   * Returns the number of bytes used by the compressed values.
+   */
+  size_t byteCount() const;
+
+private:
+  struct Brick {
+    TValue min;
+    TValue max;
+    // The index of the first bit of the packed differences of the brick in
+    // words, and of the bit count of its first row in rowBitCounts.
+    size_t firstBit;
+    size_t firstRow;
+  };
+
+private:
+  BrickLayout mLayout;
+  std::vector<Brick> bricks;
+  // The packed differences of the non-constant bricks, one after the other.
+  std::vector<std::uint64_t> words;
+  // The number of bits of the packed differences of each row.
+  std::vector<std::uint8_t> rowBitCounts;
+};
+
+using CompressedTensor3DUint8 = BasicCompressedTensor3D<std::uint8_t>;
+using CompressedTensor3DInt16 = BasicCompressedTensor3D<std::int16_t>;
+using CompressedTensor3DUint16 = BasicCompressedTensor3D<std::uint16_t>;
+
+extern template class BasicCompressedTensor3D<std::uint8_t>;
+extern template class BasicCompressedTensor3D<std::int16_t>;
+extern template class BasicCompressedTensor3D<std::uint16_t>;
+
+} // namespace marchingcubes
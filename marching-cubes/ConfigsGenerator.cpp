@@ -8,86 +8,47 @@
 
 #include "marching-cubes/ConfigsGenerator.hpp"
 
+#include "marching-cubes/CaseTable.hpp"
+
 #include <list>
+#include <vector>
 
 namespace marchingcubes {
 
-// https://en.wikipedia.org/wiki/Marching_cubes
+// The base configurations and their triangles are defined once, in
+// casetable::BASE_CASES.
 auto retrieveBaseConfigurations() {
-  using namespace cube;
-  return std::array<cube::Configuration, 15>{
-      {// 0 element: from 0 until 1
-       cube::Configuration{0b00000000},
-       // 1 element: from 1 until 2
-       configurationFromPositiveVertices(0),
-       // 2 elements: from 2 until 5
-       configurationFromPositiveVertices(0, 1),
-       configurationFromPositiveVertices(0, 5),
-       configurationFromPositiveVertices(0, 7),
-       // 3 elements: from 5 until 8
-       configurationFromPositiveVertices(1, 2, 3),
-       configurationFromPositiveVertices(0, 1, 7),
-       configurationFromPositiveVertices(1, 4, 7),
-       // 4 elements: from 8 until 15
-       configurationFromPositiveVertices(0, 1, 2, 3),
-       configurationFromPositiveVertices(1, 2, 3, 4),
-       configurationFromPositiveVertices(0, 3, 5, 6),
-       configurationFromPositiveVertices(0, 2, 3, 6),
-       configurationFromPositiveVertices(1, 2, 3, 6),
-       configurationFromPositiveVertices(0, 3, 4, 7),
-       configurationFromPositiveVertices(0, 2, 3, 7)}};
+  std::array<cube::Configuration, 15> configs;
+  for (size_t i = 0; i < configs.size(); ++i) {
+    configs[i] = cube::Configuration{casetable::BASE_CASES[i].config};
+  }
+  return configs;
 }
 
 /**
  * @brief Retrieve the intersecting triangles for each marching cube base
  *        configuration.
- *
- *      6_____7
- *     /|    /|        z
- *    4_____5 |        |  y
- *    | |   | |        | /
- *    | |   | |        |/
- *    | |   | |        #----- x
- *    | 2___|_3
- *    |/    |/
- *    0_____1
  */
 std::array<TrianglesOnCubeEdges, 15> retrieveBaseConfigurationTriangles() {
-  using namespace cube;
-  constexpr auto t = [](Edge e0, Edge e1, Edge e2) {
-    return TriangleOnCubeEdges{{e0, e1, e2}};
-  };
-  using ts = TrianglesOnCubeEdges;
-
-  return std::array<TrianglesOnCubeEdges, 15>{{
-      ts{},                                                       // None
-      ts{{t(e01, e02, e04)}},                                     // 0
-      ts{{t(e02, e04, e15), t(e02, e13, e15)}},                   // 0, 1
-      ts{{t(e01, e02, e04), t(e45, e57, e15)}},                   // 0, 5
-      ts{{t(e01, e02, e04), t(e37, e57, e67)}},                   // 0, 7
-      ts{{t(e01, e02, e15), t(e02, e15, e26), t(e15, e37, e26)}}, // 1, 2 ,3
-      ts{{t(e02, e04, e13), t(e04, e13, e15), t(e37, e57, e67)}}, // 0, 1, 7
-      ts{{t(e01, e13, e15), t(e04, e45, e46), t(e37, e57, e67)}}, // 1, 4, 7
-      ts{{t(e04, e15, e26), t(e15, e37, e26)}},                   // 0, 1, 2, 3
-      ts{{t(e04, e45, e46), t(e01, e02, e15), t(e02, e15, e37),   //
-          t(e15, e26, e37)}},                                     // 1, 2, 3, 4
-      ts{{t(e01, e02, e04), t(e13, e23, e37), t(e15, e45, e57),   //
-          t(e26, e46, e67)}},                                     // 0, 3, 5, 6
-      ts{{t(e04, e46, e67), t(e01, e04, e67), t(e01, e37, e67),   //
-          t(e01, e13, e37)}},                                     // 0, 2, 3, 6
-      ts{{t(e01, e02, e46), t(e01, e37, e46), t(e37, e46, e67),   //
-          t(e01, e15, e37)}},                                     // 1, 2, 3, 6
-      ts{{t(e01, e02, e46), t(e01, e45, e46), t(e13, e23, e67),   //
-          t(e13, e57, e67)}},                                     // 0, 3, 4, 7
-      ts{{t(e01, e04, e26), t(e01, e26, e57), t(e26, e57, e67),   //
-          t(e01, e13, e57)}}                                      // 0, 2, 3, 7
-  }};
+  std::array<TrianglesOnCubeEdges, 15> triangles;
+  for (size_t i = 0; i < triangles.size(); ++i) {
+    const auto &baseCase = casetable::BASE_CASES[i];
+    std::vector<TriangleOnCubeEdges> baseTriangles;
+    for (size_t iTriangle = 0; iTriangle < baseCase.triangleCount;
+         ++iTriangle) {
+      const auto *edges = &baseCase.edges[iTriangle * triangle::POINT_COUNT];
+      baseTriangles.push_back(
+          TriangleOnCubeEdges{{edges[0], edges[1], edges[2]}});
+    }
+    triangles[i] = TrianglesOnCubeEdges{baseTriangles};
+  }
+  return triangles;
 }
 
 BaseConfigs::BaseConfigs()
     : configs{retrieveBaseConfigurations()},
       triangles{retrieveBaseConfigurationTriangles()},
-      startIndicesByTrueValueCount{{0, 1, 2, 5, 8, 15}} {}
+      startIndicesByTrueValueCount{casetable::BASE_START_BY_POSITIVE_COUNT} {}
 
 //// Test all configurations
 //
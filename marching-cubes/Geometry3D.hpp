@@ -22,6 +22,14 @@ constexpr std::size_t Y = X + 1;
 constexpr std::size_t Z = Y + 1;
 constexpr std::size_t DIM_COUNT = Z + 1;
 
-using Point3D = std::array<double, DIM_COUNT>;
+/*!
+ * The points of the isosurfaces have coordinates of type TCoordinate, double
+ * or float.
+ */
+template <typename TCoordinate>
+using BasicPoint3D = std::array<TCoordinate, DIM_COUNT>;
+using Point3D = BasicPoint3D<double>;
+using Point3DFloat = BasicPoint3D<float>;
+using Vector3D = std::array<double, DIM_COUNT>;
 
 } // namespace marchingcubes
@@ -0,0 +1,296 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/IncrementalMarchingCubes.hpp"
+
+#include "marching-cubes/Tensor3D.hpp"
+#include "marching-cubes/internal/CubeTraversal.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace marchingcubes {
+
+using namespace internal;
+
+constexpr size_t ACTIVE_WORD_BITS = 64;
+
+/*!
+ * \fn sortValueIndices
+ * \brief Returns the indices of the values that are not NaN, sorted by value.
+ *
+ * The values of 8 and 16 bits are sorted by counting, in linear time.
+ */
+template <typename TValue>
+static std::vector<std::uint32_t>
+sortValueIndices(const ValueSpan<TValue> &values) {
+  std::vector<std::uint32_t> indices;
+  if constexpr (std::is_integral_v<TValue> && sizeof(TValue) <= 2) {
+    constexpr auto LOWEST = std::numeric_limits<TValue>::lowest();
+    constexpr auto VALUE_COUNT = size_t{1} << (8 * sizeof(TValue));
+    auto bucketOf = [](TValue value) {
+      return static_cast<size_t>(static_cast<long>(value) - LOWEST);
+    };
+    std::vector<std::uint32_t> starts(VALUE_COUNT + 1, 0);
+    for (const auto value : values) {
+      ++starts[bucketOf(value) + 1];
+    }
+    for (size_t i = 1; i < starts.size(); ++i) {
+      starts[i] += starts[i - 1];
+    }
+    indices.resize(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+      indices[starts[bucketOf(values[i])]++] = static_cast<std::uint32_t>(i);
+    }
+  } else {
+    indices.reserve(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+      if (!std::isnan(static_cast<double>(values[i]))) {
+        indices.push_back(static_cast<std::uint32_t>(i));
+      }
+    }
+    std::sort(indices.begin(), indices.end(),
+              [&values](std::uint32_t lhs, std::uint32_t rhs) {
+                return values[lhs] < values[rhs];
+              });
+  }
+  return indices;
+}
+
+template <typename TValue>
+static size_t cubeCountOf(const BasicTensor3D<TValue> &tensor) {
+  return (tensor.size(X) - 1) * (tensor.size(Y) - 1) * (tensor.size(Z) - 1);
+}
+
+template <typename TValue>
+IncrementalMarchingCubes<TValue>::IncrementalMarchingCubes(
+    const Grid3D &grid, const BasicTensor3D<TValue> &tensor)
+    : grid{grid}, tensor{tensor} {
+  const auto &values = tensor.allValues();
+  if (values.size() > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::invalid_argument("Tensor of " + std::to_string(values.size()) +
+                                " values, more than 2^32 - 1");
+  }
+  sortedVertices = sortValueIndices(values);
+  configs.assign(cubeCountOf(tensor), 0);
+  activeCubes.assign((configs.size() + ACTIVE_WORD_BITS - 1) /
+                         ACTIVE_WORD_BITS,
+                     0);
+}
+
+template <typename TValue>
+void IncrementalMarchingCubes<TValue>::classifyAllCubes(double isoValue) {
+  const auto xCubes = tensor.size(X) - 1;
+  const auto yCubes = tensor.size(Y) - 1;
+  const auto zCubes = tensor.size(Z) - 1;
+  const auto &values = tensor.allValues();
+  std::fill(activeCubes.begin(), activeCubes.end(), 0);
+  size_t cubeIndex = 0;
+  for (size_t z = 0; z < zCubes; ++z) {
+    for (size_t y = 0; y < yCubes; ++y) {
+      for (size_t x = 0; x < xCubes; ++x, ++cubeIndex) {
+        unsigned config = 0;
+        for (size_t vertex = 0; vertex < VERTEX_COUNT; ++vertex) {
+          const auto value = values[tensor.index(
+              x + (vertex & 1), y + (vertex >> 1 & 1), z + (vertex >> 2))];
+          config |= static_cast<unsigned>(!(value < isoValue)) << vertex;
+        }
+        configs[cubeIndex] = static_cast<std::uint8_t>(config);
+        updateActiveCube(cubeIndex);
+      }
+    }
+  }
+  mUpdatedCubeCount = configs.size();
+}
+
+/*!
+ * Flips the bits of the vertices sortedVertices[begin, end) in the
+ * configurations of the cubes around them.
+ */
+template <typename TValue>
+void IncrementalMarchingCubes<TValue>::flipVertices(size_t begin,
+                                                    size_t end) {
+  const auto xSize = tensor.size(X);
+  const auto ySize = tensor.size(Y);
+  const auto zSize = tensor.size(Z);
+  // In the order of the tensor, so that the configurations of neighbouring
+  // vertices are patched together instead of in a random order.
+  flippedVertices.assign(sortedVertices.cbegin() + begin,
+                         sortedVertices.cbegin() + end);
+  std::sort(flippedVertices.begin(), flippedVertices.end());
+  mUpdatedCubeCount = 0;
+  for (const size_t vertexIndex : flippedVertices) {
+    const auto x = vertexIndex % xSize;
+    const auto y = vertexIndex / xSize % ySize;
+    const auto z = vertexIndex / (xSize * ySize);
+    // The vertex is the vertex (dX, dY, dZ) of the cube whose vertex 0 is
+    // (x - dX, y - dY, z - dZ).
+    for (size_t vertex = 0; vertex < VERTEX_COUNT; ++vertex) {
+      const size_t dX = vertex & 1;
+      const size_t dY = vertex >> 1 & 1;
+      const size_t dZ = vertex >> 2;
+      if (x < dX || x - dX + 1 >= xSize || y < dY || y - dY + 1 >= ySize ||
+          z < dZ || z - dZ + 1 >= zSize) {
+        continue;
+      }
+      const auto cubeIndex =
+          x - dX + (xSize - 1) * (y - dY + (ySize - 1) * (z - dZ));
+      configs[cubeIndex] ^= static_cast<std::uint8_t>(1u << vertex);
+      updateActiveCube(cubeIndex);
+      ++mUpdatedCubeCount;
+    }
+  }
+}
+
+template <typename TValue>
+void IncrementalMarchingCubes<TValue>::updateActiveCube(size_t cubeIndex) {
+  const auto config = configs[cubeIndex];
+  const auto bit = std::uint64_t{1} << (cubeIndex % ACTIVE_WORD_BITS);
+  auto &word = activeCubes[cubeIndex / ACTIVE_WORD_BITS];
+  if (config != 0 && config != 255) {
+    word |= bit;
+  } else {
+    word &= ~bit;
+  }
+}
+
+template <typename TValue>
+void IncrementalMarchingCubes<TValue>::update(double isoValue) {
+  const auto &values = tensor.allValues();
+  auto firstNotBelow = [this, &values](double threshold) {
+    return static_cast<size_t>(
+        std::lower_bound(sortedVertices.cbegin(), sortedVertices.cend(),
+                         threshold,
+                         [&values](std::uint32_t index, double threshold) {
+                           return static_cast<double>(values[index]) <
+                                  threshold;
+                         }) -
+        sortedVertices.cbegin());
+  };
+  if (!hasIsoValue) {
+    classifyAllCubes(isoValue);
+  } else if (isoValue != mIsoValue) {
+    // The vertices in [min, max) are below one isovalue and not below the
+    // other one.
+    const auto begin = firstNotBelow(std::min(isoValue, mIsoValue));
+    const auto end = firstNotBelow(std::max(isoValue, mIsoValue));
+    // Beyond a vertex out of 8, patching the configurations costs more than
+    // classifying all the cubes.
+    if (end - begin > values.size() / 8) {
+      classifyAllCubes(isoValue);
+    } else {
+      flipVertices(begin, end);
+    }
+  } else {
+    mUpdatedCubeCount = 0;
+  }
+  hasIsoValue = true;
+  mIsoValue = isoValue;
+}
+
+/*!
+ * Calls visitCube(coordinates, configIndex, iX, iY, iZ, cubeValues) for each
+ * cube that intersects the isosurface, in Z, Y, X order, like forEachCube.
+ */
+template <typename TValue>
+template <typename TVisitor>
+void IncrementalMarchingCubes<TValue>::forEachActiveCube(
+    TVisitor &&visitCube) const {
+  const auto &values = tensor.allValues();
+  const auto xCubes = tensor.size(X) - 1;
+  const auto yCubes = tensor.size(Y) - 1;
+  std::array<size_t, VERTEX_COUNT> vertexOffsets;
+  for (size_t vertex = 0; vertex < VERTEX_COUNT; ++vertex) {
+    vertexOffsets[vertex] =
+        tensor.index(vertex & 1, vertex >> 1 & 1, vertex >> 2);
+  }
+  auto visitCubes = [&](const auto &coordinates) {
+    for (size_t word = 0; word < activeCubes.size(); ++word) {
+      auto cubes = activeCubes[word];
+      while (cubes != 0) {
+        const auto cubeIndex =
+            word * ACTIVE_WORD_BITS + lowestBitIndex(cubes);
+        cubes &= cubes - 1;
+        const auto x = cubeIndex % xCubes;
+        const auto yz = cubeIndex / xCubes;
+        const auto y = yz % yCubes;
+        const auto z = yz / yCubes;
+        const auto *cubeVertices = values.data() + tensor.index(x, y, z);
+        std::array<double, VERTEX_COUNT> cubeValues;
+        for (size_t vertex = 0; vertex < VERTEX_COUNT; ++vertex) {
+          cubeValues[vertex] =
+              static_cast<double>(cubeVertices[vertexOffsets[vertex]]) -
+              mIsoValue;
+        }
+        visitCube(coordinates, configs[cubeIndex], x + 1, y + 1, z + 1,
+                  cubeValues);
+      }
+    }
+  };
+  if (const auto *uniformGrid = grid.uniformGrid()) {
+    visitCubes(*uniformGrid);
+  } else {
+    visitCubes(GridCoordinates{grid});
+  }
+}
+
+template <typename TValue>
+std::vector<Triangle3D>
+IncrementalMarchingCubes<TValue>::isoSurface(double isoValue) {
+  update(isoValue);
+  std::vector<Triangle3D> triangles;
+  triangles.reserve(mTriangleCount);
+  forEachActiveCube([&triangles](const auto &coordinates,
+                                 std::uint8_t configIndex, size_t iX,
+                                 size_t iY, size_t iZ,
+                                 const std::array<double, VERTEX_COUNT>
+                                     &cubeValues) {
+    emitCubeTriangles(configIndex, coordinates, iX, iY, iZ, cubeValues,
+                      [&triangles](const Triangle3D &triangle3D) {
+                        triangles.push_back(triangle3D);
+                      });
+  });
+  mTriangleCount = triangles.size();
+  return triangles;
+}
+
+template <typename TValue>
+std::vector<Triangle3D> IncrementalMarchingCubes<TValue>::isoSurfaceWithNormals(
+    double isoValue, std::vector<TriangleNormals> &normals) {
+  update(isoValue);
+  std::vector<Triangle3D> triangles;
+  triangles.reserve(mTriangleCount);
+  normals.clear();
+  normals.reserve(mTriangleCount);
+  const TensorRows<TValue> rows{tensor};
+  forEachActiveCube([&](const auto &coordinates, std::uint8_t configIndex,
+                        size_t iX, size_t iY, size_t iZ,
+                        const std::array<double, VERTEX_COUNT> &cubeValues) {
+    emitCubeTrianglesWithNormals(
+        configIndex, rows, coordinates, iX, iY, iZ, cubeValues,
+        [&](const Triangle3D &triangle3D,
+            const TriangleNormals &triangleNormals) {
+          triangles.push_back(triangle3D);
+          normals.push_back(triangleNormals);
+        });
+  });
+  mTriangleCount = triangles.size();
+  return triangles;
+}
+
+template class IncrementalMarchingCubes<double>;
+template class IncrementalMarchingCubes<float>;
+template class IncrementalMarchingCubes<std::uint8_t>;
+template class IncrementalMarchingCubes<std::int16_t>;
+template class IncrementalMarchingCubes<std::uint16_t>;
+
+} // namespace marchingcubes
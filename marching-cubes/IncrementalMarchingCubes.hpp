@@ -0,0 +1,100 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include "marching-cubes/Geometry3D.hpp"
+#include "marching-cubes/IndexedMesh.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace marchingcubes {
+
+class Grid3D;
+template <typename TValue> class BasicTensor3D;
+
+/*!
+ * \class IncrementalMarchingCubes
+ * \brief The class IncrementalMarchingCubes calculates the isosurfaces of one
+ * tensor for successive isovalues, such as the values of a slider, without
+ * traversing the whole tensor for each of them.
+ *
+ * It keeps the configuration of each cube for the previous isovalue, and an
+ * index of the vertices sorted by value. When the isovalue changes, only the
+ * vertices whose value lies between the previous and the new isovalue change
+ * side: the configurations of the cubes around them are patched, and the set
+ * of the cubes that intersect the isosurface is updated. The triangles are
+ * then calculated on these cubes only. The points of all of them move with
+ * the isovalue, so the triangles are calculated again rather than kept.
+ *
+ * The returned triangles are the ones of MarchingCubes::isoSurface, in the
+ * same order. The index takes 5 bytes per vertex, and the grid and the tensor
+ * must outlive the IncrementalMarchingCubes.
+ *
+ * TValue is one of the value types of BasicTensor3D.
+ */
+template <typename TValue> class IncrementalMarchingCubes {
+
+public:
+  /*!
+   * Builds the index of the vertices of tensor. Throws std::invalid_argument
+   * if the tensor has 2^32 values or more.
+   */
+  IncrementalMarchingCubes(const Grid3D &grid,
+                           const BasicTensor3D<TValue> &tensor);
+
+public:
+  /*!
+   * Returns the triangles of the isosurface of isoValue. The first call
+   * classifies all the cubes, the next ones only the cubes around the
+   * vertices that changed side.
+   */
+  std::vector<Triangle3D> isoSurface(double isoValue);
+
+  /*!
+   * Same as isoSurface, and stores in normals the normals at the vertices of
+   * the triangles, like MarchingCubes::isoSurfaceWithNormals.
+   */
+  std::vector<Triangle3D>
+  isoSurfaceWithNormals(double isoValue,
+                        std::vector<TriangleNormals> &normals);
+
+  /*!
+   * Returns the number of configurations that were patched by the last call
+   * to isoSurface, or the number of cubes if they were all classified.
+   */
+  std::size_t updatedCubeCount() const { return mUpdatedCubeCount; }
+
+private:
+  void update(double isoValue);
+  void classifyAllCubes(double isoValue);
+  void flipVertices(std::size_t begin, std::size_t end);
+  void updateActiveCube(std::size_t cubeIndex);
+  template <typename TVisitor>
+  void forEachActiveCube(TVisitor &&visitCube) const;
+
+private:
+  const Grid3D &grid;
+  const BasicTensor3D<TValue> &tensor;
+  // The indices of the values of the tensor, sorted by value. The NaN values
+  // are left out: they never change side.
+  std::vector<std::uint32_t> sortedVertices;
+  std::vector<std::uint32_t> flippedVertices;
+  // The configuration of each cube, indexed by the indices of its vertex 0.
+  std::vector<std::uint8_t> configs;
+  // A bit per cube, set when its configuration is neither 0 nor 255.
+  std::vector<std::uint64_t> activeCubes;
+  bool hasIsoValue = false;
+  double mIsoValue = 0.0;
+  std::size_t mUpdatedCubeCount = 0;
+  // The triangle count of the previous isosurface, to reserve the next one.
+  std::size_t mTriangleCount = 0;
+};
+
+} // namespace marchingcubes
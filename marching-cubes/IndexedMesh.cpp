@@ -0,0 +1,92 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/IndexedMesh.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <numeric>
+
+namespace marchingcubes {
+
+std::vector<Triangle3D> IndexedMesh::toTriangles() const {
+  std::vector<Triangle3D> result;
+  result.reserve(triangles.size());
+  for (const auto &triangle : triangles) {
+    result.push_back(Triangle3D{{vertices.at(triangle[0]),
+                                 vertices.at(triangle[1]),
+                                 vertices.at(triangle[2])}});
+  }
+  return result;
+}
+
+std::vector<TriangleNormals> IndexedMesh::toTriangleNormals() const {
+  std::vector<TriangleNormals> result;
+  if (normals.empty()) {
+    return result;
+  }
+  assert(normals.size() == vertices.size());
+  result.reserve(triangles.size());
+  for (const auto &triangle : triangles) {
+    result.push_back(TriangleNormals{{normals.at(triangle[0]),
+                                      normals.at(triangle[1]),
+                                      normals.at(triangle[2])}});
+  }
+  return result;
+}
+
+IndexedMesh weldTriangles(const std::vector<Triangle3D> &triangles,
+                          const std::vector<TriangleNormals> &normals) {
+  assert(normals.empty() || normals.size() == triangles.size());
+  // The corners of the triangles sorted by point, and by index for the same
+  // point, so that the first corner of each point is its first occurrence.
+  const auto cornerCount = triangles.size() * triangle::POINT_COUNT;
+  std::vector<size_t> corners(cornerCount);
+  std::iota(corners.begin(), corners.end(), size_t{0});
+  auto pointOf = [&triangles](size_t corner) -> const Point3D & {
+    return triangles[corner / triangle::POINT_COUNT]
+                    [corner % triangle::POINT_COUNT];
+  };
+  std::sort(corners.begin(), corners.end(), [&](size_t lhs, size_t rhs) {
+    const auto &lhsPoint = pointOf(lhs);
+    const auto &rhsPoint = pointOf(rhs);
+    return lhsPoint < rhsPoint || (lhsPoint == rhsPoint && lhs < rhs);
+  });
+  std::vector<size_t> firstCorners(cornerCount);
+  for (size_t i = 0; i < cornerCount; ++i) {
+    firstCorners[corners[i]] =
+        i > 0 && pointOf(corners[i]) == pointOf(corners[i - 1])
+            ? firstCorners[corners[i - 1]]
+            : corners[i];
+  }
+
+  IndexedMesh mesh;
+  mesh.triangles.resize(triangles.size());
+  std::vector<std::uint32_t> vertexOfCorner(cornerCount);
+  for (size_t corner = 0; corner < cornerCount; ++corner) {
+    const auto iTriangle = corner / triangle::POINT_COUNT;
+    const auto iPoint = corner % triangle::POINT_COUNT;
+    if (firstCorners[corner] == corner) {
+      assert(mesh.vertices.size() <
+             std::numeric_limits<std::uint32_t>::max());
+      vertexOfCorner[corner] =
+          static_cast<std::uint32_t>(mesh.vertices.size());
+      mesh.vertices.push_back(pointOf(corner));
+      if (!normals.empty()) {
+        mesh.normals.push_back(normals[iTriangle][iPoint]);
+      }
+    } else {
+      vertexOfCorner[corner] = vertexOfCorner[firstCorners[corner]];
+    }
+    mesh.triangles[iTriangle][iPoint] = vertexOfCorner[corner];
+  }
+  return mesh;
+}
+
+} // namespace marchingcubes
@@ -0,0 +1,85 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include "marching-cubes/Geometry3D.hpp"
+#include "marching-cubes/Triangle.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace marchingcubes {
+
+template <typename TCoordinate>
+using BasicTriangle3D = triangle::Type<BasicPoint3D<TCoordinate>>;
+using Triangle3D = BasicTriangle3D<double>;
+using Triangle3DFloat = BasicTriangle3D<float>;
+
+/*!
+ * \class TriangleNormals
+ * \brief The alias TriangleNormals stores the unit normals of an isosurface
+ * at the 3 vertices of a Triangle3D.
+ */
+using TriangleNormals = triangle::Type<Vector3D>;
+
+/*!
+ * \class IndexedTriangle
+ * \brief The alias IndexedTriangle represents a triangle as the indices of its
+ * vertices in the vertex array of an IndexedMesh.
+ */
+using IndexedTriangle = triangle::Type<std::uint32_t>;
+
+/*!
+ * \class IndexedMesh
+ * \brief The class IndexedMesh stores an isosurface as an array of unique
+ * vertices and an array of triangles that refer to these vertices.
+ *
+ * A vertex that is shared by several triangles is stored only once, which
+ * makes an IndexedMesh several times smaller than the equivalent vector of
+ * Triangle3D.
+ *
+ * The unit normals of the isosurface at the vertices are optional: normals is
+ * either empty or has one normal per vertex.
+ */
+struct IndexedMesh {
+  std::vector<Point3D> vertices;
+  std::vector<IndexedTriangle> triangles;
+  std::vector<Vector3D> normals;
+
+  /*!
+   * Converts the mesh to independent triangles, in the order of the
+   * triangles array.
+   */
+  std::vector<Triangle3D> toTriangles() const;
+
+  /*!
+   * Returns the normals of the vertices of each triangle, in the order of
+   * toTriangles(), as MarchingCubes::isoSurfaceWithNormals does. It returns
+   * an empty vector when the mesh has no normals.
+   */
+  std::vector<TriangleNormals> toTriangleNormals() const;
+};
+
+/*!
+ * \fn weldTriangles
+ * \brief The function weldTriangles converts independent triangles, and their
+ * optional normals, to an IndexedMesh whose vertices are the distinct points
+ * of the triangles, in the order of their first occurrence.
+ *
+ * MarchingCubes calculates the point of a grid edge the same way in all the
+ * cubes that share it, so the triangles of an isosurface are welded along
+ * their common edges. It is meant for the triangles that come from
+ * elsewhere, e.g. a file: MarchingCubes::isoSurfaceMeshWithNormals returns
+ * the welded mesh of an isosurface directly.
+ */
+extern IndexedMesh
+weldTriangles(const std::vector<Triangle3D> &triangles,
+              const std::vector<TriangleNormals> &normals = {});
+
+} // namespace marchingcubes
@@ -0,0 +1,95 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/IsoSurfaceCache.hpp"
+
+#include "marching-cubes/MarchingCubes.hpp"
+
+#include <cassert>
+#include <tuple>
+
+namespace marchingcubes {
+
+bool IsoSurfaceKey::operator<(const IsoSurfaceKey &rhs) const {
+  return std::tie(tensor, isoValue, region.begin, region.end, withNormals,
+                  decimatedTriangleCount) <
+         std::tie(rhs.tensor, rhs.isoValue, rhs.region.begin, rhs.region.end,
+                  rhs.withNormals, rhs.decimatedTriangleCount);
+}
+
+IsoSurfaceCache::IsoSurfaceCache(std::size_t byteBudget)
+    : budget{byteBudget} {}
+
+void IsoSurfaceCache::setByteBudget(std::size_t byteBudget) {
+  budget = byteBudget;
+  evict(budget);
+}
+
+std::shared_ptr<const TrianglesWithNormals>
+IsoSurfaceCache::find(const IsoSurfaceKey &key) {
+  const auto found = entryOfKey.find(key);
+  if (found == entryOfKey.end()) {
+    return nullptr;
+  }
+  entries.splice(entries.begin(), entries, found->second);
+  return found->second->surface;
+}
+
+void IsoSurfaceCache::insert(
+    const IsoSurfaceKey &key,
+    std::shared_ptr<const TrianglesWithNormals> surface) {
+  assert(surface != nullptr);
+  const auto found = entryOfKey.find(key);
+  if (found != entryOfKey.end()) {
+    erase(found->second);
+  }
+  const auto byteSize = byteSizeOf(*surface);
+  if (byteSize > budget) {
+    return;
+  }
+  evict(budget - byteSize);
+  entries.push_front(Entry{key, std::move(surface), byteSize});
+  entryOfKey.emplace(key, entries.begin());
+  bytes += byteSize;
+}
+
+void IsoSurfaceCache::erase(const void *tensor) {
+  for (auto entry = entries.begin(); entry != entries.end();) {
+    const auto next = std::next(entry);
+    if (entry->key.tensor == tensor) {
+      erase(entry);
+    }
+    entry = next;
+  }
+}
+
+void IsoSurfaceCache::clear() {
+  entries.clear();
+  entryOfKey.clear();
+  bytes = 0;
+}
+
+std::size_t IsoSurfaceCache::byteSizeOf(const TrianglesWithNormals &surface) {
+  return surface.triangles.size() * sizeof(Triangle3D) +
+         surface.normals.size() * sizeof(TriangleNormals);
+}
+
+void IsoSurfaceCache::erase(std::list<Entry>::iterator entry) {
+  bytes -= entry->byteSize;
+  entryOfKey.erase(entry->key);
+  entries.erase(entry);
+}
+
+void IsoSurfaceCache::evict(std::size_t byteBudget) {
+  while (bytes > byteBudget) {
+    assert(!entries.empty());
+    erase(std::prev(entries.end()));
+  }
+}
+
+} // namespace marchingcubes
@@ -0,0 +1,119 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include "marching-cubes/Tensor3D.hpp"
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+
+namespace marchingcubes {
+
+struct TrianglesWithNormals;
+
+/*!
+ * \class IsoSurfaceKey
+ * \brief The class IsoSurfaceKey identifies an isosurface in an
+ * IsoSurfaceCache: the tensor it was calculated from, its isovalue, the box
+ * of the tensor it covers, and the options of its calculation.
+ *
+ * The tensor is identified by its address, so the cache must be cleared, or
+ * its entries erased, when the tensor is destroyed or modified.
+ */
+struct IsoSurfaceKey {
+  const void *tensor;
+  double isoValue;
+  IndexBox region;
+  bool withNormals;
+  // The target triangle count of the decimation of the isosurface, or 0 when
+  // it is not decimated.
+  std::size_t decimatedTriangleCount;
+
+  bool operator<(const IsoSurfaceKey &rhs) const;
+};
+
+/*!
+ * \class IsoSurfaceCache
+ * \brief The class IsoSurfaceCache keeps the last isosurfaces calculated,
+ * so that coming back to an isovalue does not calculate its isosurface
+ * again.
+ *
+ * The isosurfaces are shared with the callers, and the memory of their
+ * triangles and normals is bounded by byteBudget(): inserting an isosurface
+ * evicts the least recently used ones until the isosurfaces fit in the
+ * budget. An isosurface larger than the budget is not kept.
+ *
+ * The cache is not thread safe.
+ */
+class IsoSurfaceCache {
+
+public:
+  explicit IsoSurfaceCache(std::size_t byteBudget);
+
+public:
+  std::size_t byteBudget() const { return budget; }
+  /*!
+   * Changes the budget, and evicts the least recently used isosurfaces
+   * which no longer fit in it.
+   */
+  void setByteBudget(std::size_t byteBudget);
+
+  /*!
+   * Returns the number of bytes of the triangles and normals of the
+   * isosurfaces in the cache.
+   */
+  std::size_t byteSize() const { return bytes; }
+  std::size_t size() const { return entries.size(); }
+
+  /*!
+   * Returns the isosurface of key, which becomes the most recently used
+   * one, or nullptr if it is not in the cache.
+   */
+  std::shared_ptr<const TrianglesWithNormals> find(const IsoSurfaceKey &key);
+
+  /*!
+   * Inserts surface, or replaces the isosurface of key, as the most recently
+   * used isosurface.
+   */
+  void insert(const IsoSurfaceKey &key,
+              std::shared_ptr<const TrianglesWithNormals> surface);
+
+  /*!
+   * Erases the isosurfaces of tensor.
+   */
+  void erase(const void *tensor);
+  void clear();
+
+  /*!
+   * Returns the number of bytes of the triangles and normals of surface.
+   */
+  static std::size_t byteSizeOf(const TrianglesWithNormals &surface);
+
+private:
+  struct Entry {
+    IsoSurfaceKey key;
+    std::shared_ptr<const TrianglesWithNormals> surface;
+    std::size_t byteSize;
+  };
+
+  void erase(std::list<Entry>::iterator entry);
+  void evict(std::size_t byteBudget);
+
+private:
+  std::size_t budget;
+  std::size_t bytes = 0;
+  // The most recently used entry first.
+  std::list<Entry> entries;
+  std::map<IsoSurfaceKey, std::list<Entry>::iterator> entryOfKey;
+};
+
+} // namespace marchingcubes
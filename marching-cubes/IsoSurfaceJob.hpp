@@ -0,0 +1,152 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <stdexcept>
+
+namespace marchingcubes {
+
+/*!
+ * \class CancellationToken
+ * \brief The class CancellationToken requests the calculations that share it
+ * to stop, e.g. the calculation of an isosurface for an isovalue that the
+ * user has already changed.
+ *
+ * cancel() may be called from any thread. The calculations check the token
+ * between rows of cubes, and throw IsoSurfaceCancelled once it is cancelled.
+ */
+class CancellationToken {
+
+public:
+  void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+  bool isCancelled() const {
+    return cancelled.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<bool> cancelled{false};
+};
+
+/*!
+ * \class IsoSurfaceCancelled
+ * \brief The exception IsoSurfaceCancelled is thrown by a calculation whose
+ * CancellationToken is cancelled.
+ */
+class IsoSurfaceCancelled : public std::runtime_error {
+
+public:
+  IsoSurfaceCancelled()
+      : std::runtime_error{"The isosurface calculation was cancelled"} {}
+};
+
+/*!
+ * \class IsoSurfaceProgress
+ * \brief The class IsoSurfaceProgress counts the rows of cubes done by a
+ * calculation of MarchingCubes, and checks its CancellationToken between
+ * them.
+ *
+ * The calculation calls start() with its number of rows, then finishRow()
+ * after each row, from any of its threads. fraction() may be read from any
+ * thread meanwhile.
+ */
+class IsoSurfaceProgress {
+
+public:
+  explicit IsoSurfaceProgress(
+      std::shared_ptr<const CancellationToken> token = nullptr)
+      : token{std::move(token)} {}
+
+public:
+  /*!
+   * Returns the fraction of the rows done, from 0 to 1.
+   */
+  double fraction() const {
+    const auto total = rowCount.load(std::memory_order_relaxed);
+    const auto done = doneRowCount.load(std::memory_order_relaxed);
+    return total == 0 ? 0.0
+                      : static_cast<double>(done) / static_cast<double>(total);
+  }
+
+  void start(std::size_t totalRowCount) {
+    rowCount.store(totalRowCount, std::memory_order_relaxed);
+    doneRowCount.store(0, std::memory_order_relaxed);
+  }
+
+  /*!
+   * Throws IsoSurfaceCancelled if the token is cancelled, and otherwise
+   * counts a row as done.
+   */
+  void finishRow() {
+    if (token != nullptr && token->isCancelled()) {
+      throw IsoSurfaceCancelled{};
+    }
+    doneRowCount.fetch_add(1, std::memory_order_relaxed);
+  }
+
+private:
+  const std::shared_ptr<const CancellationToken> token;
+  std::atomic<std::size_t> rowCount{0};
+  std::atomic<std::size_t> doneRowCount{0};
+};
+
+/*!
+ * \class IsoSurfaceJob
+ * \brief The class IsoSurfaceJob is the handle of a calculation of
+ * MarchingCubes running in the background, see MarchingCubes::isoSurfaceAsync.
+ *
+ * The job reports the progress of the calculation, cancels it, and returns
+ * its result. Destroying the job waits for the end of the calculation: a job
+ * that is no longer needed should be cancelled first, so that it stops at the
+ * end of its current rows.
+ */
+template <typename TResult> class IsoSurfaceJob {
+
+public:
+  IsoSurfaceJob(std::shared_ptr<CancellationToken> token,
+                std::shared_ptr<const IsoSurfaceProgress> progress,
+                std::future<TResult> result)
+      : token{std::move(token)}, progressState{std::move(progress)},
+        result{std::move(result)} {}
+
+public:
+  /*!
+   * Returns the fraction of the calculation done, from 0 to 1.
+   */
+  double progress() const { return progressState->fraction(); }
+
+  void cancel() { token->cancel(); }
+  bool isCancelled() const { return token->isCancelled(); }
+
+  /*!
+   * Returns true when the result is available, without waiting.
+   */
+  bool isReady() const {
+    return result.wait_for(std::chrono::seconds(0)) ==
+           std::future_status::ready;
+  }
+
+  /*!
+   * Waits for the end of the calculation, and returns its result. Throws
+   * IsoSurfaceCancelled if the job was cancelled before its end, or the
+   * exception thrown by the calculation. It may be called only once.
+   */
+  TResult get() { return result.get(); }
+
+private:
+  std::shared_ptr<CancellationToken> token;
+  std::shared_ptr<const IsoSurfaceProgress> progressState;
+  std::future<TResult> result;
+};
+
+} // namespace marchingcubes
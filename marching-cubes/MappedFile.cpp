@@ -0,0 +1,73 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/MappedFile.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace marchingcubes {
+
+static std::system_error systemError(const std::string &what) {
+  return std::system_error(errno, std::generic_category(), what);
+}
+
+MappedFile::MappedFile(const std::string &path) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw systemError("Cannot open " + path);
+  }
+  struct stat status;
+  if (::fstat(fd, &status) != 0) {
+    const auto error = systemError("Cannot stat " + path);
+    ::close(fd);
+    throw error;
+  }
+  mSize = static_cast<std::size_t>(status.st_size);
+  if (mSize > 0) {
+    // MAP_SHARED: the pages are the ones of the page cache, shared with the
+    // other processes that read the file.
+    void *address = ::mmap(nullptr, mSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+      const auto error = systemError("Cannot map " + path);
+      ::close(fd);
+      throw error;
+    }
+    mData = static_cast<const std::byte *>(address);
+    ::posix_madvise(address, mSize, POSIX_MADV_SEQUENTIAL);
+  }
+  // The mapping stays valid once the file is closed.
+  ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (mData != nullptr) {
+    ::munmap(const_cast<std::byte *>(mData), mSize);
+  }
+}
+
+void MappedFile::willNeed(std::size_t offset, std::size_t length) const {
+  if (mData == nullptr || offset >= mSize) {
+    return;
+  }
+  // posix_madvise requires an address aligned on a page.
+  static const auto pageSize =
+      static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  const auto begin = offset / pageSize * pageSize;
+  const auto end = std::min(offset + length, mSize);
+  ::posix_madvise(const_cast<std::byte *>(mData) + begin, end - begin,
+                  POSIX_MADV_WILLNEED);
+}
+
+} // namespace marchingcubes
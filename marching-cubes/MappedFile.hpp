@@ -0,0 +1,53 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace marchingcubes {
+
+/*!
+ * \class MappedFile
+ * \brief The class MappedFile maps a whole file in memory, read-only.
+ *
+ * The pages are loaded lazily by the kernel when they are first read, and
+ * are shared with the other processes that map the same file: opening a
+ * large file is instantaneous, and the file is kept once in the page cache.
+ * The mapping is advised for sequential access, so that the kernel reads
+ * ahead while the file is swept in order.
+ */
+class MappedFile {
+
+public:
+  /*!
+   * Maps the file at path. Throws std::system_error if the file cannot be
+   * opened or mapped.
+   */
+  explicit MappedFile(const std::string &path);
+  ~MappedFile();
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+public:
+  const std::byte *data() const { return mData; }
+  std::size_t size() const { return mSize; }
+
+  /*!
+   * Advises the kernel that the bytes [offset, offset + length) of the file
+   * will be read soon, so that it starts to load them in the background.
+   */
+  void willNeed(std::size_t offset, std::size_t length) const;
+
+private:
+  const std::byte *mData = nullptr;
+  std::size_t mSize = 0;
+};
+
+} // namespace marchingcubes
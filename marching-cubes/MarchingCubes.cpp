@@ -8,12 +8,23 @@
 
 #include "marching-cubes/MarchingCubes.hpp"
 
-#include "marching-cubes/ConfigsGenerator.hpp"
+#include "marching-cubes/BrickedTensor3D.hpp"
+#include "marching-cubes/CompressedTensor3D.hpp"
 #include "marching-cubes/Tensor3D.hpp"
+#include "marching-cubes/ThreadPool.hpp"
+#include "marching-cubes/internal/CubeTraversal.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
 
 namespace marchingcubes {
 
-constexpr auto VERTEX_COUNT = cube::VERTEX_COUNT;
+using namespace internal;
+using casetable::CASE_TABLE;
 
 /*!
  * \class MarchingCubesImpl
@@ -24,24 +35,184 @@ constexpr auto VERTEX_COUNT = cube::VERTEX_COUNT;
 class MarchingCubesImpl {
 
 public:
-  MarchingCubesImpl();
+  explicit MarchingCubesImpl(std::size_t threadCount);
+
+  std::size_t threadCount() const { return pool->threadCount(); }
+  void setThreadCount(std::size_t threadCount);
+
+  TriangleAllocation triangleAllocation() const { return allocation; }
+  void setTriangleAllocation(TriangleAllocation allocation) {
+    this->allocation = allocation;
+  }
+
+  /*!
+   * TTensor is a BasicTensor3D or a BasicTensor3DView. When progress is not
+   * null, it counts the rows of cubes, and may stop the calculation.
+   */
+  template <typename TCoordinate, typename TTensor>
+  std::vector<BasicTriangle3D<TCoordinate>>
+  isoSurface(const Grid3D &grid, const TTensor &tensor, double isoValue,
+             const IndexBox &box,
+             IsoSurfaceProgress *progress = nullptr) const;
+
+  /*!
+   * TBrickedTensor is a BasicBrickedTensor3D or a BasicCompressedTensor3D.
+   */
+  template <typename TCoordinate, typename TBrickedTensor>
+  std::vector<BasicTriangle3D<TCoordinate>>
+  isoSurfaceOfBricks(const Grid3D &grid, const TBrickedTensor &tensor,
+                     double isoValue) const;
 
-  std::vector<Triangle3D> isoSurface(const Grid3D &grid, const Tensor3D &tensor,
-                                     double isoValue) const;
+  /*!
+   * Passes the triangles of the isosurface to sink, see isoSurfaceInOrder.
+   * When progress is not null, it counts the rows of cubes, and may stop the
+   * calculation.
+   */
+  template <typename TCoordinate, typename TValue>
+  void isoSurface(const Grid3D &grid, const BasicTensor3D<TValue> &tensor,
+                  double isoValue, const IndexBox &box,
+                  BasicTriangleSink<TCoordinate> &sink,
+                  IsoSurfaceProgress *progress) const;
+
+  template <typename TValue>
+  std::vector<Triangle3D>
+  isoSurfaceWithNormals(const Grid3D &grid,
+                        const BasicTensor3D<TValue> &tensor, double isoValue,
+                        std::vector<TriangleNormals> &normals,
+                        IsoSurfaceProgress *progress = nullptr) const;
+
+  template <typename TValue>
+  IndexedMesh isoSurfaceMesh(const Grid3D &grid,
+                             const BasicTensor3D<TValue> &tensor,
+                             double isoValue, bool withNormals = false,
+                             IsoSurfaceProgress *progress = nullptr) const;
+
+  template <typename TValue>
+  std::vector<std::vector<Triangle3D>>
+  isoSurfaces(const Grid3D &grid, const BasicTensor3D<TValue> &tensor,
+              const std::vector<double> &isoValues) const;
 
 private:
+  /*!
+   * Returns the number of slabs of the layerCount layers of cubes of a
+   * calculation: 1 with 1 thread, and otherwise SLABS_PER_THREAD slabs per
+   * thread, so that the work stealing of the pool balances the threads when
+   * the isosurface is concentrated in a few slabs.
+   */
+  size_t slabCountOf(size_t layerCount) const;
+
+  template <typename TTensor>
   static bool areGridAndTensorConsistent(const Grid3D &grid,
-                                         const Tensor3D &tensor);
+                                         const TTensor &tensor);
+
+  /*!
+   * Returns true if box has cubes, false if it is flat, and throws
+   * std::invalid_argument if it is not inside tensor.
+   */
+  template <typename TTensor>
+  static bool hasCubes(const TTensor &tensor, const IndexBox &box);
+
+  /*!
+   * Passes the triangles of the cubes of box in the order of isoSurface. With
+   * one slab, each triangle is passed to emit(triangle) as it is calculated.
+   * With several slabs, each slab is calculated in its own buffer, and the
+   * buffers are passed to emitBatch(triangles, count) in Z order.
+   */
+  template <typename TCoordinate, typename TTensor, typename TEmit,
+            typename TEmitBatch>
+  void isoSurfaceInOrder(const Grid3D &grid, const TTensor &tensor,
+                         double isoValue, const IndexBox &box,
+                         IsoSurfaceProgress *progress, TEmit &&emit,
+                         TEmitBatch &&emitBatch) const;
+
+  template <typename TCoordinate, typename TTensor>
+  std::vector<BasicTriangle3D<TCoordinate>>
+  isoSurfaceGrowing(const Grid3D &grid, const TTensor &tensor,
+                    double isoValue, const IndexBox &box,
+                    IsoSurfaceProgress *progress) const;
+  template <typename TCoordinate, typename TTensor>
+  std::vector<BasicTriangle3D<TCoordinate>>
+  isoSurfaceCountThenFill(const Grid3D &grid, const TTensor &tensor,
+                          double isoValue, const IndexBox &box,
+                          IsoSurfaceProgress *progress) const;
+
+  /*!
+   * Calls emit(triangle) for each triangle of the cubes of box whose upper Z
+   * index is in [zBegin, zEnd), with coordinates of type TCoordinate. The
+   * indices are relative to the beginning of box. When progress is not null,
+   * progress->finishRow() is called after each row of cubes.
+   */
+  template <typename TCoordinate = double, typename TTensor, typename TEmit>
+  void isoSurfaceSlab(const Grid3D &grid, const TTensor &tensor,
+                      const IndexBox &box, double isoValue, size_t zBegin,
+                      size_t zEnd, TEmit &&emit,
+                      IsoSurfaceProgress *progress = nullptr) const;
+
+  /*!
+   * Calls emit(iIso, triangle) for each triangle of the isosurface of
+   * isoValues[iIso] on the cubes of box whose upper Z index is in
+   * [zBegin, zEnd), with coordinates of type TCoordinate.
+   */
+  template <typename TCoordinate = double, typename TTensor, typename TEmit>
+  void isoSurfacesSlab(const Grid3D &grid, const TTensor &tensor,
+                       const IndexBox &box,
+                       const std::vector<double> &isoValues, size_t zBegin,
+                       size_t zEnd, TEmit &&emit,
+                       IsoSurfaceProgress *progress = nullptr) const;
+
+  /*!
+   * Counts the triangles of the cubes of box whose upper Z index is in
+   * [zBegin, zEnd), without calculating them.
+   */
+  template <typename TTensor>
+  size_t countTriangles(const TTensor &tensor, const IndexBox &box,
+                        double isoValue, size_t zBegin, size_t zEnd,
+                        IsoSurfaceProgress *progress) const;
 
 private:
-  const AllConfigs configs;
+  std::unique_ptr<ThreadPool> pool;
+  TriangleAllocation allocation = TriangleAllocation::Growing;
 };
 
-MarchingCubesImpl::MarchingCubesImpl()
-    : configs{ConfigsGenerator{BaseConfigs{}}.generateConfigs()} {}
+/*!
+ * Returns a pool of threadCount threads, or throws std::invalid_argument if
+ * threadCount is 0.
+ */
+static std::unique_ptr<ThreadPool> createPool(std::size_t threadCount) {
+  if (threadCount == 0) {
+    throw std::invalid_argument("The thread count must be at least 1");
+  }
+  return std::make_unique<ThreadPool>(threadCount);
+}
+
+MarchingCubesImpl::MarchingCubesImpl(std::size_t threadCount)
+    : pool{createPool(threadCount)} {}
 
+/*!
+ * The number of slabs per thread of a multithreaded calculation. The threads
+ * steal the slabs from each other, but the triangles of the slabs are
+ * concatenated in their order, so the result does not depend on the number
+ * of threads.
+ */
+constexpr size_t SLABS_PER_THREAD = 8;
+
+size_t MarchingCubesImpl::slabCountOf(size_t layerCount) const {
+  if (pool->threadCount() == 1) {
+    return 1;
+  }
+  return std::max<size_t>(
+      1, std::min(pool->threadCount() * SLABS_PER_THREAD, layerCount));
+}
+
+void MarchingCubesImpl::setThreadCount(std::size_t threadCount) {
+  if (threadCount != pool->threadCount()) {
+    pool = createPool(threadCount);
+  }
+}
+
+template <typename TTensor>
 bool MarchingCubesImpl::areGridAndTensorConsistent(const Grid3D &grid,
-                                                   const Tensor3D &tensor) {
+                                                   const TTensor &tensor) {
   for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
     if (grid.values[iDim].size() != tensor.size(iDim))
       return false;
@@ -49,141 +220,1163 @@ bool MarchingCubesImpl::areGridAndTensorConsistent(const Grid3D &grid,
   return true;
 }
 
-static double offset(const std::array<double, VERTEX_COUNT> &valuesOnCube,
-                     cube::Edge edge) {
-  auto localOffset = [](double start, double end) {
-    assert(start != end); // May explode...
-    return start / (start - end);
+/*!
+ * \fn willNeed
+ * \brief Advises that the Z slices [zBegin, zEnd) of tensor will be read
+ * soon. The values of a view are not managed by the library.
+ */
+template <typename TValue>
+static void willNeed(const BasicTensor3D<TValue> &tensor, size_t zBegin,
+                     size_t zEnd) {
+  tensor.willNeed(zBegin, zEnd);
+}
+
+template <typename TValue>
+static void willNeed(const BasicTensor3DView<TValue> &, size_t, size_t) {}
+
+/*!
+ * \fn slabBounds
+ * \brief Returns the [zBegin, zEnd) range of upper Z indices of the slab
+ * iSlab when the cubes of box are split into slabCount slabs.
+ */
+static std::pair<size_t, size_t> slabBounds(const IndexBox &box, size_t iSlab,
+                                            size_t slabCount) {
+  const auto layerCount = box.size(Z) - 1;
+  return std::make_pair(1 + iSlab * layerCount / slabCount,
+                        1 + (iSlab + 1) * layerCount / slabCount);
+}
+
+template <typename TValue>
+static std::pair<size_t, size_t>
+slabBounds(const BasicTensor3D<TValue> &tensor, size_t iSlab,
+           size_t slabCount) {
+  return slabBounds(tensor.indexBox(), iSlab, slabCount);
+}
+
+/*!
+ * \fn finishRowOf
+ * \brief Returns the function called after each row of cubes of a
+ * calculation, which reports it to progress when it is not null.
+ */
+static auto finishRowOf(IsoSurfaceProgress *progress) {
+  return [progress] {
+    if (progress != nullptr) {
+      progress->finishRow();
+    }
   };
-  using namespace cube;
-  switch (edge) {
-  case e01:
-    return localOffset(valuesOnCube[0], valuesOnCube[1]);
-  case e02:
-    return localOffset(valuesOnCube[0], valuesOnCube[2]);
-  case e04:
-    return localOffset(valuesOnCube[0], valuesOnCube[4]);
-  case e13:
-    return localOffset(valuesOnCube[1], valuesOnCube[3]);
-  case e15:
-    return localOffset(valuesOnCube[1], valuesOnCube[5]);
-  case e23:
-    return localOffset(valuesOnCube[2], valuesOnCube[3]);
-  case e26:
-    return localOffset(valuesOnCube[2], valuesOnCube[6]);
-  case e37:
-    return localOffset(valuesOnCube[3], valuesOnCube[7]);
-  case e45:
-    return localOffset(valuesOnCube[4], valuesOnCube[5]);
-  case e46:
-    return localOffset(valuesOnCube[4], valuesOnCube[6]);
-  case e57:
-    return localOffset(valuesOnCube[5], valuesOnCube[7]);
-  case e67:
-    return localOffset(valuesOnCube[6], valuesOnCube[7]);
-  }
-}
-
-std::vector<Triangle3D> MarchingCubesImpl::isoSurface(const Grid3D &grid,
-                                                      const Tensor3D &tensor,
-                                                      double isoValue) const {
+}
+
+template <typename TCoordinate, typename TTensor>
+std::vector<BasicTriangle3D<TCoordinate>>
+MarchingCubesImpl::isoSurface(const Grid3D &grid, const TTensor &tensor,
+                              double isoValue, const IndexBox &box,
+                              IsoSurfaceProgress *progress) const {
+  assert(areGridAndTensorConsistent(grid, tensor));
+  if (!hasCubes(tensor, box)) {
+    return {};
+  }
+  if (progress != nullptr) {
+    // CountThenFill goes through the rows twice.
+    const size_t passCount =
+        allocation == TriangleAllocation::CountThenFill ? 2 : 1;
+    progress->start(passCount * (box.size(Y) - 1) * (box.size(Z) - 1));
+  }
+  switch (allocation) {
+  case TriangleAllocation::Growing:
+    return isoSurfaceGrowing<TCoordinate>(grid, tensor, isoValue, box,
+                                          progress);
+  case TriangleAllocation::CountThenFill:
+    return isoSurfaceCountThenFill<TCoordinate>(grid, tensor, isoValue, box,
+                                                progress);
+  }
+  assert(false);
+  return {};
+}
+
+template <typename TTensor>
+bool MarchingCubesImpl::hasCubes(const TTensor &tensor, const IndexBox &box) {
+  for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    if (box.begin[iDim] > box.end[iDim] ||
+        box.end[iDim] > tensor.size(iDim)) {
+      throw std::invalid_argument(
+          "Index box [" + std::to_string(box.begin[iDim]) + ", " +
+          std::to_string(box.end[iDim]) + ") out of [0, " +
+          std::to_string(tensor.size(iDim)) + ") along axis " +
+          std::to_string(iDim));
+    }
+  }
+  for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    if (box.size(iDim) < 2) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename TCoordinate, typename TTensor, typename TEmit,
+          typename TEmitBatch>
+void MarchingCubesImpl::isoSurfaceInOrder(const Grid3D &grid,
+                                          const TTensor &tensor,
+                                          double isoValue,
+                                          const IndexBox &box,
+                                          IsoSurfaceProgress *progress,
+                                          TEmit &&emit,
+                                          TEmitBatch &&emitBatch) const {
+  using Triangle = BasicTriangle3D<TCoordinate>;
+  const auto slabCount = slabCountOf(box.size(Z) - 1);
+  if (slabCount == 1) {
+    isoSurfaceSlab<TCoordinate>(grid, tensor, box, isoValue, 1, box.size(Z),
+                                emit, progress);
+    return;
+  }
+
+  std::vector<std::vector<Triangle>> slabTriangles(slabCount);
+  pool->run(slabCount, [&](std::size_t iSlab) {
+    auto [zBegin, zEnd] = slabBounds(box, iSlab, slabCount);
+    auto &triangles = slabTriangles[iSlab];
+    triangles.reserve(10000);
+    isoSurfaceSlab<TCoordinate>(
+        grid, tensor, box, isoValue, zBegin, zEnd,
+        [&triangles](const Triangle &triangle) {
+          triangles.push_back(triangle);
+        },
+        progress);
+  });
+  for (const auto &triangles : slabTriangles) {
+    if (!triangles.empty()) {
+      emitBatch(triangles.data(), triangles.size());
+    }
+  }
+}
+
+template <typename TCoordinate, typename TValue>
+void MarchingCubesImpl::isoSurface(const Grid3D &grid,
+                                   const BasicTensor3D<TValue> &tensor,
+                                   double isoValue, const IndexBox &box,
+                                   BasicTriangleSink<TCoordinate> &sink,
+                                   IsoSurfaceProgress *progress) const {
   assert(areGridAndTensorConsistent(grid, tensor));
-  std::vector<Triangle3D> triangles;
+  if (!hasCubes(tensor, box)) {
+    return;
+  }
+  if (progress != nullptr) {
+    progress->start((box.size(Y) - 1) * (box.size(Z) - 1));
+  }
+  using Triangle = BasicTriangle3D<TCoordinate>;
+  std::vector<Triangle> batch;
+  batch.reserve(TRIANGLE_SINK_BATCH_SIZE);
+  auto emitBatch = [&sink](const Triangle *triangles, size_t count) {
+    sink.emitBatch(triangles, count);
+  };
+  isoSurfaceInOrder<TCoordinate>(
+      grid, tensor, isoValue, box, progress,
+      [&batch, &emitBatch](const Triangle &triangle) {
+        batch.push_back(triangle);
+        if (batch.size() == TRIANGLE_SINK_BATCH_SIZE) {
+          emitBatch(batch.data(), batch.size());
+          batch.clear();
+        }
+      },
+      emitBatch);
+  if (!batch.empty()) {
+    emitBatch(batch.data(), batch.size());
+  }
+}
+
+/*!
+ * \fn concatenate
+ * \brief Returns the concatenation of the vectors of parts, in order.
+ */
+template <typename T>
+static std::vector<T> concatenate(std::vector<std::vector<T>> &parts) {
+  if (parts.size() == 1) {
+    return std::move(parts.front());
+  }
+  size_t size = 0;
+  for (const auto &part : parts) {
+    size += part.size();
+  }
+  std::vector<T> result;
+  result.reserve(size);
+  for (const auto &part : parts) {
+    result.insert(result.end(), part.cbegin(), part.cend());
+  }
+  return result;
+}
+
+template <typename TCoordinate, typename TTensor>
+std::vector<BasicTriangle3D<TCoordinate>>
+MarchingCubesImpl::isoSurfaceGrowing(const Grid3D &grid, const TTensor &tensor,
+                                     double isoValue, const IndexBox &box,
+                                     IsoSurfaceProgress *progress) const {
+  using Triangle = BasicTriangle3D<TCoordinate>;
+  std::vector<Triangle> triangles;
   triangles.reserve(10000);
-  const auto &gridX = grid.values.at(X);
-  const auto &gridY = grid.values.at(Y);
-  const auto &gridZ = grid.values.at(Z);
-  /**
-   *      6_____7
-   *     /|    /|        z
-   *    4_____5 |        |  y
-   *    | |   | |        | /
-   *    | |   | |        |/
-   *    | |   | |        #----- x
-   *    | 2___|_3
-   *    |/    |/
-   *    0_____1
-   */
-  const std::vector<double> &values = tensor.allValues();
-  for (size_t iZ = 1; iZ < tensor.size(Z); ++iZ) {
-    for (size_t iY = 1; iY < tensor.size(Y); ++iY) {
-
-      cube::Cube3D cube3D{{{std::make_pair(gridX[0], gridX[1]),
-                            std::make_pair(gridY[iY - 1], gridY[iY]),
-                            std::make_pair(gridZ[iZ - 1], gridZ[iZ])}}};
-
-      auto v1 = values.begin();
-      std::advance(v1, static_cast<long>(tensor.index(0, iY - 1, iZ - 1)));
-      auto v3 = values.cbegin();
-      std::advance(v3, static_cast<long>(tensor.index(0, iY, iZ - 1)));
-      auto v5 = values.cbegin();
-      std::advance(v5, static_cast<long>(tensor.index(0, iY - 1, iZ)));
-      auto v7 = values.cbegin();
-      std::advance(v7, static_cast<long>(tensor.index(0, iY, iZ)));
-      std::array<double, VERTEX_COUNT> cubeValues{
-          {0.0, *v1 - isoValue, 0.0, *v3 - isoValue, 0.0, *v5 - isoValue, 0.0,
-           *v7 - isoValue}};
-      auto bitConfigSet = [&cubeValues](int index) {
-        return (cubeValues[static_cast<size_t>(index)] < 0.0 ? 0 : 1) << index;
-      };
-      auto bitsToKeepFromPreviousConfig = static_cast<uint8_t>(0b10101010);
-      auto configBitSet =
-          static_cast<uint8_t>(bitConfigSet(1) | bitConfigSet(3) |
-                               bitConfigSet(5) | bitConfigSet(7));
-      for (size_t iX = 1; iX < tensor.size(X); ++iX) {
-        cube3D.setMinMax(X, gridX[iX - 1], gridX[iX]);
-        cubeValues[0] = cubeValues[1];
-        cubeValues[2] = cubeValues[3];
-        cubeValues[4] = cubeValues[5];
-        cubeValues[6] = cubeValues[7];
-        cubeValues[1] = *(++v1) - isoValue;
-        cubeValues[3] = *(++v3) - isoValue;
-        cubeValues[5] = *(++v5) - isoValue;
-        cubeValues[7] = *(++v7) - isoValue;
-        configBitSet = (configBitSet & bitsToKeepFromPreviousConfig) >> 1 |
-                       static_cast<uint8_t>(bitConfigSet(1) | bitConfigSet(3) |
-                                            bitConfigSet(5) | bitConfigSet(7));
-
-        auto configIndex = cube::Configuration(configBitSet).toUint8();
-        auto trianglesOnEdges = configs.triangles.at(configIndex);
-
-        /*
-        std::string ixyz = "(" + std::to_string(iX) + "," + std::to_string(iY) +
-                           "," + std::to_string(iZ) + ")";
-        std::cout << ixyz << " configBitSet: " << std::bitset<8>{configIndex}
-                  << " #triangles: " << triangles.size() << " - "
-                  << triangles.size() + trianglesOnEdges.size() - 1
-                  << std::endl;
-        */
-
-        auto toTriangle3D = [&](TriangleOnCubeEdges triangleOnEdges) {
-          Triangle3D triangle3D;
-          for (size_t i = 0; i < triangle3D.size(); ++i) {
-            auto edge = triangleOnEdges[i];
-            auto intersectionOffset = offset(cubeValues, edge);
-            triangle3D[i] = cube3D.interpolatedPoint(edge, intersectionOffset);
+  isoSurfaceInOrder<TCoordinate>(
+      grid, tensor, isoValue, box, progress,
+      [&triangles](const Triangle &triangle) {
+        triangles.push_back(triangle);
+      },
+      [&triangles](const Triangle *batch, size_t count) {
+        triangles.insert(triangles.end(), batch, batch + count);
+      });
+  triangles.shrink_to_fit();
+  return triangles;
+}
+
+template <typename TCoordinate, typename TTensor>
+std::vector<BasicTriangle3D<TCoordinate>>
+MarchingCubesImpl::isoSurfaceCountThenFill(const Grid3D &grid,
+                                           const TTensor &tensor,
+                                           double isoValue,
+                                           const IndexBox &box,
+                                           IsoSurfaceProgress *progress) const {
+  using Triangle = BasicTriangle3D<TCoordinate>;
+  const auto slabCount = slabCountOf(box.size(Z) - 1);
+  // First pass: count the triangles of each slab, and calculate the offset of
+  // the first triangle of each slab in the result.
+  std::vector<size_t> slabOffsets(slabCount + 1, 0);
+  pool->run(slabCount, [&](std::size_t iSlab) {
+    auto [zBegin, zEnd] = slabBounds(box, iSlab, slabCount);
+    slabOffsets[iSlab + 1] =
+        countTriangles(tensor, box, isoValue, zBegin, zEnd, progress);
+  });
+  std::partial_sum(slabOffsets.cbegin(), slabOffsets.cend(),
+                   slabOffsets.begin());
+
+  // Second pass: each slab writes its triangles at its own offset.
+  std::vector<Triangle> triangles;
+  if (slabCount == 1) {
+    triangles.reserve(slabOffsets.back());
+    isoSurfaceSlab<TCoordinate>(
+        grid, tensor, box, isoValue, 1, box.size(Z),
+        [&triangles](const Triangle &triangle) {
+          triangles.push_back(triangle);
+        },
+        progress);
+  } else {
+    triangles.resize(slabOffsets.back());
+    pool->run(slabCount, [&](std::size_t iSlab) {
+      auto [zBegin, zEnd] = slabBounds(box, iSlab, slabCount);
+      auto output = triangles.begin() + static_cast<long>(slabOffsets[iSlab]);
+      isoSurfaceSlab<TCoordinate>(
+          grid, tensor, box, isoValue, zBegin, zEnd,
+          [&output](const Triangle &triangle) { *(output++) = triangle; },
+          progress);
+      assert(output ==
+             triangles.begin() + static_cast<long>(slabOffsets[iSlab + 1]));
+    });
+  }
+  assert(triangles.size() == triangles.capacity());
+  return triangles;
+}
+
+/*!
+ * \fn brickValues
+ * \brief Returns the values of a brick of tensor, with the layout of
+ * BasicBrickedTensor3D::brickValues. The values of a compressed brick are
+ * decompressed into buffer, which has room for the values of a brick.
+ */
+template <typename TValue>
+static const TValue *brickValues(const BasicBrickedTensor3D<TValue> &tensor,
+                                 size_t bx, size_t by, size_t bz,
+                                 std::vector<TValue> &) {
+  return tensor.brickValues(bx, by, bz);
+}
+
+template <typename TValue>
+static const TValue *
+brickValues(const BasicCompressedTensor3D<TValue> &tensor, size_t bx,
+            size_t by, size_t bz, std::vector<TValue> &buffer) {
+  tensor.decompressBrick(bx, by, bz, buffer.data());
+  return buffer.data();
+}
+
+template <typename TCoordinate, typename TBrickedTensor>
+std::vector<BasicTriangle3D<TCoordinate>>
+MarchingCubesImpl::isoSurfaceOfBricks(const Grid3D &grid,
+                                      const TBrickedTensor &tensor,
+                                      double isoValue) const {
+  assert(areGridAndTensorConsistent(grid, tensor));
+  using Triangle = BasicTriangle3D<TCoordinate>;
+  using Value = typename TBrickedTensor::Value;
+  const auto &layout = tensor.layout();
+  const auto layerCount = layout.brickCount(Z);
+  const auto slabCount = slabCountOf(layerCount);
+  std::vector<std::vector<Triangle>> slabTriangles(slabCount);
+  auto computeSlab = [&](std::size_t iSlab) {
+    auto &triangles = slabTriangles[iSlab];
+    std::vector<Value> buffer(layout.brickValueCount());
+    for (auto bz = iSlab * layerCount / slabCount;
+         bz < (iSlab + 1) * layerCount / slabCount; ++bz) {
+      for (size_t by = 0; by < layout.brickCount(Y); ++by) {
+        for (size_t bx = 0; bx < layout.brickCount(X); ++bx) {
+          if (!tensor.mayIntersect(bx, by, bz, isoValue)) {
+            continue;
           }
-          return triangle3D;
-        };
+          const auto box = layout.brickBox(bx, by, bz);
+          const BrickRows<Value> rows{
+              brickValues(tensor, bx, by, bz, buffer), layout.rowSize(), box};
+          withBoxCoordinates(grid, box, [&](const auto &coordinates) {
+            forEachCube(rows, isoValue, 1, box.size(Z),
+                        [&](size_t iX, size_t iY, size_t iZ,
+                            uint8_t configIndex,
+                            const std::array<double, VERTEX_COUNT> &values) {
+                          emitCubeTriangles<TCoordinate>(
+                              configIndex, coordinates, iX, iY, iZ, values,
+                              [&triangles](const Triangle &triangle) {
+                                triangles.push_back(triangle);
+                              });
+                        });
+          });
+        }
+      }
+    }
+  };
+  if (slabCount == 1) {
+    computeSlab(0);
+  } else {
+    pool->run(slabCount, computeSlab);
+  }
+  return concatenate(slabTriangles);
+}
+
+template <typename TTensor>
+size_t MarchingCubesImpl::countTriangles(const TTensor &tensor,
+                                         const IndexBox &box, double isoValue,
+                                         size_t zBegin, size_t zEnd,
+                                         IsoSurfaceProgress *progress) const {
+  size_t count = 0;
+  forEachCube(
+      rowsOf(tensor, box), isoValue, zBegin, zEnd,
+      [&](size_t, size_t, size_t, uint8_t configIndex,
+          const std::array<double, VERTEX_COUNT> &) {
+        count += CASE_TABLE.triangleCounts[configIndex];
+      },
+      finishRowOf(progress));
+  return count;
+}
+
+template <typename TCoordinate, typename TTensor, typename TEmit>
+void MarchingCubesImpl::isoSurfaceSlab(const Grid3D &grid,
+                                       const TTensor &tensor,
+                                       const IndexBox &box, double isoValue,
+                                       size_t zBegin, size_t zEnd,
+                                       TEmit &&emit,
+                                       IsoSurfaceProgress *progress) const {
+  isoSurfacesSlab<TCoordinate>(
+      grid, tensor, box, std::vector<double>{isoValue}, zBegin, zEnd,
+      [&emit](size_t, const BasicTriangle3D<TCoordinate> &triangle) {
+        emit(triangle);
+      },
+      progress);
+}
+
+template <typename TCoordinate, typename TTensor, typename TEmit>
+void MarchingCubesImpl::isoSurfacesSlab(const Grid3D &grid,
+                                        const TTensor &tensor,
+                                        const IndexBox &box,
+                                        const std::vector<double> &isoValues,
+                                        size_t zBegin, size_t zEnd,
+                                        TEmit &&emit,
+                                        IsoSurfaceProgress *progress) const {
+  // The cubes of the slab have their vertex 7 in [zBegin, zEnd).
+  willNeed(tensor, box.begin[Z] + zBegin - 1, box.begin[Z] + zEnd);
+  withBoxCoordinates(grid, box, [&](const auto &coordinates) {
+    forEachCubeOfIsoValues(
+        rowsOf(tensor, box), isoValues, zBegin, zEnd,
+        [&](size_t iIso, size_t iX, size_t iY, size_t iZ,
+            uint8_t configIndex,
+            const std::array<double, VERTEX_COUNT> &cubeValues) {
+          emitCubeTriangles<TCoordinate>(
+              configIndex, coordinates, iX, iY, iZ, cubeValues,
+              [&emit, iIso](const BasicTriangle3D<TCoordinate> &triangle) {
+                emit(iIso, triangle);
+              });
+        },
+        finishRowOf(progress));
+  });
+}
+
+template <typename TValue>
+std::vector<std::vector<Triangle3D>>
+MarchingCubesImpl::isoSurfaces(const Grid3D &grid,
+                               const BasicTensor3D<TValue> &tensor,
+                               const std::vector<double> &isoValues) const {
+  assert(areGridAndTensorConsistent(grid, tensor));
+  const auto slabCount = slabCountOf(tensor.size(Z) - 1);
+  using Surfaces = std::vector<std::vector<Triangle3D>>;
+  std::vector<Surfaces> slabSurfaces(slabCount, Surfaces(isoValues.size()));
+  auto computeSlab = [&](std::size_t iSlab) {
+    auto [zBegin, zEnd] = slabBounds(tensor, iSlab, slabCount);
+    auto &surfaces = slabSurfaces[iSlab];
+    isoSurfacesSlab(grid, tensor, tensor.indexBox(), isoValues, zBegin, zEnd,
+                    [&surfaces](size_t iIso, const Triangle3D &triangle) {
+                      surfaces[iIso].push_back(triangle);
+                    });
+  };
+  if (slabCount == 1) {
+    computeSlab(0);
+    return std::move(slabSurfaces.front());
+  }
+
+  pool->run(slabCount, computeSlab);
+  Surfaces surfaces(isoValues.size());
+  for (size_t iIso = 0; iIso < isoValues.size(); ++iIso) {
+    size_t triangleCount = 0;
+    for (const auto &slab : slabSurfaces) {
+      triangleCount += slab[iIso].size();
+    }
+    surfaces[iIso].reserve(triangleCount);
+    for (const auto &slab : slabSurfaces) {
+      surfaces[iIso].insert(surfaces[iIso].end(), slab[iIso].cbegin(),
+                            slab[iIso].cend());
+    }
+  }
+  return surfaces;
+}
+
+template <typename TValue>
+std::vector<Triangle3D> MarchingCubesImpl::isoSurfaceWithNormals(
+    const Grid3D &grid, const BasicTensor3D<TValue> &tensor, double isoValue,
+    std::vector<TriangleNormals> &normals,
+    IsoSurfaceProgress *progress) const {
+  assert(areGridAndTensorConsistent(grid, tensor));
+  if (progress != nullptr) {
+    progress->start((tensor.size(Y) - 1) * (tensor.size(Z) - 1));
+  }
+  const auto slabCount = slabCountOf(tensor.size(Z) - 1);
+  std::vector<std::vector<Triangle3D>> slabTriangles(slabCount);
+  std::vector<std::vector<TriangleNormals>> slabNormals(slabCount);
+  auto computeSlab = [&](std::size_t iSlab) {
+    auto [zBegin, zEnd] = slabBounds(tensor, iSlab, slabCount);
+    auto &triangles = slabTriangles[iSlab];
+    auto &trianglesNormals = slabNormals[iSlab];
+    const TensorRows<TValue> rows{tensor};
+    auto emitTriangles = [&](const auto &coordinates) {
+      forEachCube(
+          rows, isoValue, zBegin, zEnd,
+          [&](size_t iX, size_t iY, size_t iZ, uint8_t configIndex,
+              const std::array<double, VERTEX_COUNT> &cubeValues) {
+            emitCubeTrianglesWithNormals(
+                configIndex, rows, coordinates, iX, iY, iZ, cubeValues,
+                [&](const Triangle3D &triangle,
+                    const TriangleNormals &triangleNormals) {
+                  triangles.push_back(triangle);
+                  trianglesNormals.push_back(triangleNormals);
+                });
+          },
+          finishRowOf(progress));
+    };
+    if (const auto *uniformGrid = grid.uniformGrid()) {
+      emitTriangles(*uniformGrid);
+    } else {
+      emitTriangles(GridCoordinates{grid});
+    }
+  };
+  if (slabCount == 1) {
+    computeSlab(0);
+  } else {
+    pool->run(slabCount, computeSlab);
+  }
+  normals = concatenate(slabNormals);
+  return concatenate(slabTriangles);
+}
+
+constexpr auto NO_VERTEX = std::numeric_limits<std::uint32_t>::max();
+
+/*!
+ * \class MeshSlab
+ * \brief The class MeshSlab builds the IndexedMesh of one Z slab.
+ *
+ * The vertex ids of the intersected edges are cached for the lower and upper
+ * XY planes of the current layer of cubes, and for the Z edges between these
+ * planes, so that each intersection point is calculated only once. These
+ * caches only exist between start() and finish(), so that only the slabs
+ * being calculated hold them. The ids of the intersected edges of the first
+ * and last planes of the slab are then kept to merge the slab with its
+ * neighbours. The normals of the vertices are added with them when the cubes
+ * come with their CubeNormals.
+ */
+class MeshSlab {
+
+public:
+  /*!
+   * The ids of the intersected edges of a plane, by increasing index of edge
+   * in the plane.
+   */
+  using PlaneIds = std::vector<std::pair<size_t, std::uint32_t>>;
+
+public:
+  MeshSlab(const Grid3D &grid, size_t zBegin)
+      : grid{grid}, xSize{grid.values[X].size()},
+        planeSize{grid.values[X].size() * grid.values[Y].size()},
+        zBegin{zBegin}, currentZ{zBegin} {}
+
+  /*!
+   * Allocates the caches of the vertex ids, before the first layer.
+   */
+  void start() {
+    for (auto &plane : planes) {
+      plane.assign(2 * planeSize, NO_VERTEX);
+    }
+    zEdges.assign(planeSize, NO_VERTEX);
+  }
+
+  /*!
+   * Must be called before adding the cubes whose upper Z index is iZ.
+   */
+  void startLayer(size_t iZ) {
+    assert(iZ == currentZ || iZ == currentZ + 1);
+    if (iZ == currentZ) {
+      return;
+    }
+    if (currentZ == zBegin) {
+      firstPlane = intersectedEdgeIds(planes[0]);
+    }
+    planes[0].swap(planes[1]);
+    std::fill(planes[1].begin(), planes[1].end(), NO_VERTEX);
+    std::fill(zEdges.begin(), zEdges.end(), NO_VERTEX);
+    currentZ = iZ;
+  }
+
+  /*!
+   * Keeps the ids of the first and last planes, and frees the caches, after
+   * the last layer.
+   */
+  void finish() {
+    if (currentZ == zBegin) {
+      firstPlane = intersectedEdgeIds(planes[0]);
+    }
+    lastPlane = intersectedEdgeIds(planes[1]);
+    for (auto &plane : planes) {
+      std::vector<std::uint32_t>{}.swap(plane);
+    }
+    std::vector<std::uint32_t>{}.swap(zEdges);
+  }
+
+  /*!
+   * Adds the triangles of the cube whose upper indices are (iX, iY,
+   * currentZ), and the normals of its new vertices when cubeNormals is not
+   * null.
+   */
+  void addCube(std::uint8_t configIndex, size_t iX, size_t iY,
+               const std::array<double, VERTEX_COUNT> &cubeValues,
+               const CubeNormals *cubeNormals) {
+    const auto triangleCount = CASE_TABLE.triangleCounts[configIndex];
+    const auto *edge = CASE_TABLE.edges[configIndex].data();
+    for (size_t iTriangle = 0; iTriangle < triangleCount; ++iTriangle) {
+      IndexedTriangle triangle;
+      for (size_t i = 0; i < triangle.size(); ++i, ++edge) {
+        triangle[i] = vertexId(*edge, iX - 1, iY - 1, cubeValues, cubeNormals);
+      }
+      mesh.triangles.push_back(triangle);
+    }
+  }
+
+  /*!
+   * Returns the vertex ids of the X and Y edges on the plane zBegin - 1, once
+   * finished.
+   */
+  const PlaneIds &firstPlaneIds() const { return firstPlane; }
+
+  /*!
+   * Returns the vertex ids of the X and Y edges on the last plane, once
+   * finished.
+   */
+  const PlaneIds &lastPlaneIds() const { return lastPlane; }
+
+  /*!
+   * Replaces the ids of the last plane by the corresponding ids in
+   * toMergedId, once the slab has been merged.
+   */
+  void translateLastPlaneIds(const std::vector<std::uint32_t> &toMergedId) {
+    for (auto &edgeId : lastPlane) {
+      edgeId.second = toMergedId[edgeId.second];
+    }
+  }
+
+public:
+  IndexedMesh mesh;
+
+private:
+  /*!
+   * Returns the id of the vertex on the edge of the cube whose vertex 0 is
+   * (x, y, currentZ - 1), and creates this vertex if required.
+   */
+  std::uint32_t vertexId(cube::Edge edge, size_t x, size_t y,
+                         const std::array<double, VERTEX_COUNT> &cubeValues,
+                         const CubeNormals *cubeNormals) {
+    using namespace cube;
+    const auto start = toInt(startVertex(edge));
+    const auto dx = start & 1;
+    const auto dy = (start >> 1) & 1;
+    const auto dz = (start >> 2) & 1;
+    const auto axis = edgeAxis(edge);
+    const auto index = x + dx + (y + dy) * xSize;
+    auto &id = axis == Z ? zEdges[index]
+                         : planes[dz][(axis == X ? 0 : planeSize) + index];
+    if (id == NO_VERTEX) {
+      assert(mesh.vertices.size() < NO_VERTEX);
+      id = static_cast<std::uint32_t>(mesh.vertices.size());
+      const auto t = offset(cubeValues, edge);
+      const auto z = currentZ - 1;
+      if (const auto *uniformGrid = grid.uniformGrid()) {
+        mesh.vertices.push_back(
+            CubePoints{*uniformGrid, x, y, z}.edgePoint(edge, t));
+      } else {
+        mesh.vertices.push_back(
+            CubePoints{GridCoordinates{grid}, x, y, z}.edgePoint(edge, t));
+      }
+      if (cubeNormals != nullptr) {
+        mesh.normals.push_back(cubeNormals->edgeNormal(edge, t));
+      }
+    }
+    return id;
+  }
+
+  static size_t edgeAxis(cube::Edge edge) {
+    using namespace cube;
+    auto delta = toInt(endVertex(edge)) - toInt(startVertex(edge));
+    return delta == 1 ? X : (delta == 2 ? Y : Z);
+  }
+
+  static PlaneIds intersectedEdgeIds(const std::vector<std::uint32_t> &plane) {
+    PlaneIds edgeIds;
+    for (size_t i = 0; i < plane.size(); ++i) {
+      if (plane[i] != NO_VERTEX) {
+        edgeIds.emplace_back(i, plane[i]);
+      }
+    }
+    return edgeIds;
+  }
+
+private:
+  const Grid3D &grid;
+  const size_t xSize;
+  const size_t planeSize;
+  const size_t zBegin;
+  size_t currentZ;
+  // Vertex ids of the X edges followed by the ones of the Y edges, on the
+  // lower and upper planes of the current layer.
+  std::array<std::vector<std::uint32_t>, 2> planes;
+  std::vector<std::uint32_t> zEdges;
+  PlaneIds firstPlane;
+  PlaneIds lastPlane;
+};
 
-        for (size_t i = 0; i < trianglesOnEdges.size(); ++i) {
-          triangles.push_back(toTriangle3D(trianglesOnEdges[i]));
+/*!
+ * \fn mergeMeshSlabs
+ * \brief Merges the meshes of consecutive slabs. The vertices on the first
+ * plane of a slab are replaced by the same vertices of the previous slab, so
+ * that the result is the mesh that a single slab would have produced.
+ */
+static IndexedMesh mergeMeshSlabs(std::vector<MeshSlab> &slabs) {
+  IndexedMesh result = std::move(slabs.front().mesh);
+  std::vector<std::uint32_t> toResultId;
+  for (size_t iSlab = 1; iSlab < slabs.size(); ++iSlab) {
+    const auto &previousIds = slabs[iSlab - 1].lastPlaneIds();
+    const auto &firstIds = slabs[iSlab].firstPlaneIds();
+    const auto &mesh = slabs[iSlab].mesh;
+    toResultId.assign(mesh.vertices.size(), NO_VERTEX);
+    auto previous = previousIds.cbegin();
+    for (const auto &[index, id] : firstIds) {
+      while (previous != previousIds.cend() && previous->first < index) {
+        ++previous;
+      }
+      assert(previous != previousIds.cend() && previous->first == index);
+      toResultId[id] = previous->second;
+    }
+    for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+      if (toResultId[i] == NO_VERTEX) {
+        toResultId[i] = static_cast<std::uint32_t>(result.vertices.size());
+        result.vertices.push_back(mesh.vertices[i]);
+        if (!mesh.normals.empty()) {
+          result.normals.push_back(mesh.normals[i]);
         }
       }
     }
+    for (auto triangle : mesh.triangles) {
+      for (auto &id : triangle) {
+        id = toResultId[id];
+      }
+      result.triangles.push_back(triangle);
+    }
+    slabs[iSlab].translateLastPlaneIds(toResultId);
   }
-  triangles.shrink_to_fit();
-  return triangles;
+  return result;
+}
+
+template <typename TValue>
+IndexedMesh
+MarchingCubesImpl::isoSurfaceMesh(const Grid3D &grid,
+                                  const BasicTensor3D<TValue> &tensor,
+                                  double isoValue, bool withNormals,
+                                  IsoSurfaceProgress *progress) const {
+  assert(areGridAndTensorConsistent(grid, tensor));
+  if (progress != nullptr) {
+    progress->start((tensor.size(Y) - 1) * (tensor.size(Z) - 1));
+  }
+  const auto slabCount = slabCountOf(tensor.size(Z) - 1);
+  std::vector<MeshSlab> slabs;
+  slabs.reserve(slabCount);
+  for (size_t iSlab = 0; iSlab < slabCount; ++iSlab) {
+    slabs.emplace_back(grid, slabBounds(tensor, iSlab, slabCount).first);
+  }
+  pool->run(slabCount, [&](std::size_t iSlab) {
+    auto &slab = slabs[iSlab];
+    auto [zBegin, zEnd] = slabBounds(tensor, iSlab, slabCount);
+    const TensorRows<TValue> rows{tensor};
+    const auto *uniformGrid = grid.uniformGrid();
+    auto addCube = [&](size_t iX, size_t iY, size_t iZ, uint8_t configIndex,
+                       const std::array<double, VERTEX_COUNT> &cubeValues) {
+      if (!withNormals) {
+        slab.addCube(configIndex, iX, iY, cubeValues, nullptr);
+        return;
+      }
+      const auto cubeNormals =
+          uniformGrid != nullptr
+              ? CubeNormals{rows, *uniformGrid, configIndex, iX - 1, iY - 1,
+                            iZ - 1}
+              : CubeNormals{rows, GridCoordinates{grid}, configIndex, iX - 1,
+                            iY - 1, iZ - 1};
+      slab.addCube(configIndex, iX, iY, cubeValues, &cubeNormals);
+    };
+    slab.start();
+    for (auto iZ = zBegin; iZ < zEnd; ++iZ) {
+      slab.startLayer(iZ);
+      forEachCube(rows, isoValue, iZ, iZ + 1, addCube,
+                  finishRowOf(progress));
+    }
+    slab.finish();
+  });
+  return mergeMeshSlabs(slabs);
 }
 
-MarchingCubes::MarchingCubes() : pImpl{new MarchingCubesImpl()} {}
+MarchingCubes::MarchingCubes(std::size_t threadCount)
+    : pImpl{new MarchingCubesImpl(threadCount)} {}
 
 MarchingCubes::~MarchingCubes() = default;
 
-std::vector<Triangle3D> MarchingCubes::isoSurface(const Grid3D &grid,
-                                                  const Tensor3D &tensor,
-                                                  double isoValue) const {
-  return pImpl->isoSurface(grid, tensor, isoValue);
+std::size_t MarchingCubes::threadCount() const { return pImpl->threadCount(); }
+
+void MarchingCubes::setThreadCount(std::size_t threadCount) {
+  pImpl->setThreadCount(threadCount);
+}
+
+TriangleAllocation MarchingCubes::triangleAllocation() const {
+  return pImpl->triangleAllocation();
+}
+
+void MarchingCubes::setTriangleAllocation(TriangleAllocation allocation) {
+  pImpl->setTriangleAllocation(allocation);
+}
+
+template <typename TCoordinate, typename TValue>
+std::vector<BasicTriangle3D<TCoordinate>>
+MarchingCubes::isoSurface(const Grid3D &grid,
+                          const BasicTensor3D<TValue> &tensor,
+                          double isoValue) const {
+  return pImpl->isoSurface<TCoordinate>(grid, tensor, isoValue,
+                                        tensor.indexBox());
+}
+
+template <typename TCoordinate, typename TValue>
+std::vector<BasicTriangle3D<TCoordinate>>
+MarchingCubes::isoSurface(const Grid3D &grid,
+                          const BasicTensor3DView<TValue> &view,
+                          double isoValue) const {
+  return pImpl->isoSurface<TCoordinate>(grid, view, isoValue,
+                                        view.indexBox());
+}
+
+template <typename TCoordinate, typename TValue>
+std::vector<BasicTriangle3D<TCoordinate>>
+MarchingCubes::isoSurface(const Grid3D &grid,
+                          const BasicTensor3D<TValue> &tensor, double isoValue,
+                          const IndexBox &box) const {
+  return pImpl->isoSurface<TCoordinate>(grid, tensor, isoValue, box);
+}
+
+template <typename TCoordinate, typename TValue>
+std::vector<BasicTriangle3D<TCoordinate>>
+MarchingCubes::isoSurface(const Grid3D &grid,
+                          const BasicBrickedTensor3D<TValue> &tensor,
+                          double isoValue) const {
+  return pImpl->isoSurfaceOfBricks<TCoordinate>(grid, tensor, isoValue);
+}
+
+template <typename TCoordinate, typename TValue>
+std::vector<BasicTriangle3D<TCoordinate>>
+MarchingCubes::isoSurface(const Grid3D &grid,
+                          const BasicCompressedTensor3D<TValue> &tensor,
+                          double isoValue) const {
+  return pImpl->isoSurfaceOfBricks<TCoordinate>(grid, tensor, isoValue);
 }
 
+template <typename TCoordinate, typename TValue>
+void MarchingCubes::isoSurfaceToSink(const Grid3D &grid,
+                                     const BasicTensor3D<TValue> &tensor,
+                                     double isoValue, const IndexBox *box,
+                                     BasicTriangleSink<TCoordinate> &sink,
+                                     IsoSurfaceProgress *progress) const {
+  pImpl->isoSurface(grid, tensor, isoValue,
+                    box != nullptr ? *box : tensor.indexBox(), sink,
+                    progress);
+}
+
+template <typename TValue>
+std::vector<Triangle3D> MarchingCubes::isoSurfaceWithNormals(
+    const Grid3D &grid, const BasicTensor3D<TValue> &tensor, double isoValue,
+    std::vector<TriangleNormals> &normals) const {
+  return pImpl->isoSurfaceWithNormals(grid, tensor, isoValue, normals);
+}
+
+template <typename TValue>
+std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &grid,
+                          const BasicTensor3D<TValue> &tensor, double isoValue,
+                          IsoSurfaceProgress &progress) const {
+  return pImpl->isoSurface<double>(grid, tensor, isoValue, tensor.indexBox(),
+                                   &progress);
+}
+
+template <typename TValue>
+std::vector<Triangle3D> MarchingCubes::isoSurfaceWithNormals(
+    const Grid3D &grid, const BasicTensor3D<TValue> &tensor, double isoValue,
+    std::vector<TriangleNormals> &normals,
+    IsoSurfaceProgress &progress) const {
+  return pImpl->isoSurfaceWithNormals(grid, tensor, isoValue, normals,
+                                      &progress);
+}
+
+template <typename TValue>
+IndexedMesh MarchingCubes::isoSurfaceMesh(const Grid3D &grid,
+                                          const BasicTensor3D<TValue> &tensor,
+                                          double isoValue) const {
+  return pImpl->isoSurfaceMesh(grid, tensor, isoValue);
+}
+
+template <typename TValue>
+IndexedMesh
+MarchingCubes::isoSurfaceMeshWithNormals(const Grid3D &grid,
+                                         const BasicTensor3D<TValue> &tensor,
+                                         double isoValue) const {
+  return pImpl->isoSurfaceMesh(grid, tensor, isoValue, true);
+}
+
+template <typename TValue>
+IndexedMesh MarchingCubes::isoSurfaceMeshWithNormals(
+    const Grid3D &grid, const BasicTensor3D<TValue> &tensor, double isoValue,
+    IsoSurfaceProgress &progress) const {
+  return pImpl->isoSurfaceMesh(grid, tensor, isoValue, true, &progress);
+}
+
+template <typename TValue>
+std::vector<std::vector<Triangle3D>>
+MarchingCubes::isoSurfaces(const Grid3D &grid,
+                           const BasicTensor3D<TValue> &tensor,
+                           const std::vector<double> &isoValues) const {
+  return pImpl->isoSurfaces(grid, tensor, isoValues);
+}
+
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3D &, double) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DFloat &, double) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DUint8 &, double) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DInt16 &, double) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DUint16 &,
+                          double) const;
+
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const Tensor3D &,
+                                 double) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const Tensor3DFloat &,
+                                 double) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const Tensor3DUint8 &,
+                                 double) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const Tensor3DInt16 &,
+                                 double) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const Tensor3DUint16 &,
+                                 double) const;
+
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3D &, double,
+                          const IndexBox &) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DFloat &, double,
+                          const IndexBox &) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DUint8 &, double,
+                          const IndexBox &) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DInt16 &, double,
+                          const IndexBox &) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DUint16 &, double,
+                          const IndexBox &) const;
+
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const Tensor3D &, double,
+                                 const IndexBox &) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const Tensor3DFloat &, double,
+                                 const IndexBox &) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const Tensor3DUint8 &, double,
+                                 const IndexBox &) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const Tensor3DInt16 &, double,
+                                 const IndexBox &) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const Tensor3DUint16 &,
+                                 double, const IndexBox &) const;
+
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DView &, double) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DViewFloat &,
+                          double) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DViewUint8 &,
+                          double) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DViewInt16 &,
+                          double) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DViewUint16 &,
+                          double) const;
+
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const Tensor3DView &,
+                                 double) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const Tensor3DViewFloat &,
+                                 double) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const Tensor3DViewUint8 &,
+                                 double) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const Tensor3DViewInt16 &,
+                                 double) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const Tensor3DViewUint16 &,
+                                 double) const;
+
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const BrickedTensor3D &,
+                          double) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const BrickedTensor3DFloat &,
+                          double) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const BrickedTensor3DUint8 &,
+                          double) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const BrickedTensor3DInt16 &,
+                          double) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const BrickedTensor3DUint16 &,
+                          double) const;
+
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const BrickedTensor3D &,
+                                 double) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const BrickedTensor3DFloat &,
+                                 double) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const BrickedTensor3DUint8 &,
+                                 double) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const BrickedTensor3DInt16 &,
+                                 double) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &, const BrickedTensor3DUint16 &,
+                                 double) const;
+
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const CompressedTensor3DUint8 &,
+                          double) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const CompressedTensor3DInt16 &,
+                          double) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const CompressedTensor3DUint16 &,
+                          double) const;
+
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &,
+                                 const CompressedTensor3DUint8 &, double) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &,
+                                 const CompressedTensor3DInt16 &, double) const;
+template std::vector<Triangle3DFloat>
+MarchingCubes::isoSurface<float>(const Grid3D &,
+                                 const CompressedTensor3DUint16 &,
+                                 double) const;
+
+template void MarchingCubes::isoSurfaceToSink(const Grid3D &,
+                                              const Tensor3D &, double,
+                                              const IndexBox *, TriangleSink &,
+                                              IsoSurfaceProgress *) const;
+template void MarchingCubes::isoSurfaceToSink(const Grid3D &,
+                                              const Tensor3DFloat &, double,
+                                              const IndexBox *, TriangleSink &,
+                                              IsoSurfaceProgress *) const;
+template void MarchingCubes::isoSurfaceToSink(const Grid3D &,
+                                              const Tensor3DUint8 &, double,
+                                              const IndexBox *, TriangleSink &,
+                                              IsoSurfaceProgress *) const;
+template void MarchingCubes::isoSurfaceToSink(const Grid3D &,
+                                              const Tensor3DInt16 &, double,
+                                              const IndexBox *, TriangleSink &,
+                                              IsoSurfaceProgress *) const;
+template void MarchingCubes::isoSurfaceToSink(const Grid3D &,
+                                              const Tensor3DUint16 &, double,
+                                              const IndexBox *, TriangleSink &,
+                                              IsoSurfaceProgress *) const;
+template void MarchingCubes::isoSurfaceToSink(const Grid3D &,
+                                              const Tensor3D &, double,
+                                              const IndexBox *,
+                                              TriangleSinkFloat &,
+                                              IsoSurfaceProgress *) const;
+template void MarchingCubes::isoSurfaceToSink(const Grid3D &,
+                                              const Tensor3DFloat &, double,
+                                              const IndexBox *,
+                                              TriangleSinkFloat &,
+                                              IsoSurfaceProgress *) const;
+template void MarchingCubes::isoSurfaceToSink(const Grid3D &,
+                                              const Tensor3DUint8 &, double,
+                                              const IndexBox *,
+                                              TriangleSinkFloat &,
+                                              IsoSurfaceProgress *) const;
+template void MarchingCubes::isoSurfaceToSink(const Grid3D &,
+                                              const Tensor3DInt16 &, double,
+                                              const IndexBox *,
+                                              TriangleSinkFloat &,
+                                              IsoSurfaceProgress *) const;
+template void MarchingCubes::isoSurfaceToSink(const Grid3D &,
+                                              const Tensor3DUint16 &, double,
+                                              const IndexBox *,
+                                              TriangleSinkFloat &,
+                                              IsoSurfaceProgress *) const;
+
+template std::vector<Triangle3D>
+MarchingCubes::isoSurfaceWithNormals(const Grid3D &, const Tensor3D &, double,
+                                     std::vector<TriangleNormals> &) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurfaceWithNormals(const Grid3D &, const Tensor3DFloat &,
+                                     double,
+                                     std::vector<TriangleNormals> &) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurfaceWithNormals(const Grid3D &, const Tensor3DUint8 &,
+                                     double,
+                                     std::vector<TriangleNormals> &) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurfaceWithNormals(const Grid3D &, const Tensor3DInt16 &,
+                                     double,
+                                     std::vector<TriangleNormals> &) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurfaceWithNormals(const Grid3D &, const Tensor3DUint16 &,
+                                     double,
+                                     std::vector<TriangleNormals> &) const;
+
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3D &, double,
+                          IsoSurfaceProgress &) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DFloat &, double,
+                          IsoSurfaceProgress &) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DUint8 &, double,
+                          IsoSurfaceProgress &) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DInt16 &, double,
+                          IsoSurfaceProgress &) const;
+template std::vector<Triangle3D>
+MarchingCubes::isoSurface(const Grid3D &, const Tensor3DUint16 &, double,
+                          IsoSurfaceProgress &) const;
+
+template std::vector<Triangle3D> MarchingCubes::isoSurfaceWithNormals(
+    const Grid3D &, const Tensor3D &, double, std::vector<TriangleNormals> &,
+    IsoSurfaceProgress &) const;
+template std::vector<Triangle3D> MarchingCubes::isoSurfaceWithNormals(
+    const Grid3D &, const Tensor3DFloat &, double,
+    std::vector<TriangleNormals> &, IsoSurfaceProgress &) const;
+template std::vector<Triangle3D> MarchingCubes::isoSurfaceWithNormals(
+    const Grid3D &, const Tensor3DUint8 &, double,
+    std::vector<TriangleNormals> &, IsoSurfaceProgress &) const;
+template std::vector<Triangle3D> MarchingCubes::isoSurfaceWithNormals(
+    const Grid3D &, const Tensor3DInt16 &, double,
+    std::vector<TriangleNormals> &, IsoSurfaceProgress &) const;
+template std::vector<Triangle3D> MarchingCubes::isoSurfaceWithNormals(
+    const Grid3D &, const Tensor3DUint16 &, double,
+    std::vector<TriangleNormals> &, IsoSurfaceProgress &) const;
+
+template IndexedMesh MarchingCubes::isoSurfaceMesh(const Grid3D &,
+                                                   const Tensor3D &,
+                                                   double) const;
+template IndexedMesh MarchingCubes::isoSurfaceMesh(const Grid3D &,
+                                                   const Tensor3DFloat &,
+                                                   double) const;
+template IndexedMesh MarchingCubes::isoSurfaceMesh(const Grid3D &,
+                                                   const Tensor3DUint8 &,
+                                                   double) const;
+template IndexedMesh MarchingCubes::isoSurfaceMesh(const Grid3D &,
+                                                   const Tensor3DInt16 &,
+                                                   double) const;
+template IndexedMesh MarchingCubes::isoSurfaceMesh(const Grid3D &,
+                                                   const Tensor3DUint16 &,
+                                                   double) const;
+template IndexedMesh
+MarchingCubes::isoSurfaceMeshWithNormals(const Grid3D &, const Tensor3D &,
+                                         double) const;
+template IndexedMesh
+MarchingCubes::isoSurfaceMeshWithNormals(const Grid3D &, const Tensor3DFloat &,
+                                         double) const;
+template IndexedMesh
+MarchingCubes::isoSurfaceMeshWithNormals(const Grid3D &, const Tensor3DUint8 &,
+                                         double) const;
+template IndexedMesh
+MarchingCubes::isoSurfaceMeshWithNormals(const Grid3D &, const Tensor3DInt16 &,
+                                         double) const;
+template IndexedMesh
+MarchingCubes::isoSurfaceMeshWithNormals(const Grid3D &, const Tensor3DUint16 &,
+                                         double) const;
+template IndexedMesh MarchingCubes::isoSurfaceMeshWithNormals(
+    const Grid3D &, const Tensor3D &, double, IsoSurfaceProgress &) const;
+template IndexedMesh MarchingCubes::isoSurfaceMeshWithNormals(
+    const Grid3D &, const Tensor3DFloat &, double, IsoSurfaceProgress &) const;
+template IndexedMesh MarchingCubes::isoSurfaceMeshWithNormals(
+    const Grid3D &, const Tensor3DUint8 &, double, IsoSurfaceProgress &) const;
+template IndexedMesh MarchingCubes::isoSurfaceMeshWithNormals(
+    const Grid3D &, const Tensor3DInt16 &, double, IsoSurfaceProgress &) const;
+template IndexedMesh MarchingCubes::isoSurfaceMeshWithNormals(
+    const Grid3D &, const Tensor3DUint16 &, double, IsoSurfaceProgress &) const;
+
+template std::vector<std::vector<Triangle3D>>
+MarchingCubes::isoSurfaces(const Grid3D &, const Tensor3D &,
+                           const std::vector<double> &) const;
+template std::vector<std::vector<Triangle3D>>
+MarchingCubes::isoSurfaces(const Grid3D &, const Tensor3DFloat &,
+                           const std::vector<double> &) const;
+template std::vector<std::vector<Triangle3D>>
+MarchingCubes::isoSurfaces(const Grid3D &, const Tensor3DUint8 &,
+                           const std::vector<double> &) const;
+template std::vector<std::vector<Triangle3D>>
+MarchingCubes::isoSurfaces(const Grid3D &, const Tensor3DInt16 &,
+                           const std::vector<double> &) const;
+template std::vector<std::vector<Triangle3D>>
+MarchingCubes::isoSurfaces(const Grid3D &, const Tensor3DUint16 &,
+                           const std::vector<double> &) const;
+
 } // namespace marchingcubes
@@ -9,33 +9,320 @@
 #pragma once
 
 #include "marching-cubes/Geometry3D.hpp"
+#include "marching-cubes/IndexedMesh.hpp"
+#include "marching-cubes/IsoSurfaceJob.hpp"
 #include "marching-cubes/Triangle.hpp"
+#include "marching-cubes/TriangleSink.hpp"
 
+#include <future>
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 namespace marchingcubes {
 
 class Grid3D;
-class Tensor3D;
-using Triangle3D = triangle::Type<Point3D>;
+struct IndexBox;
+template <typename TValue> class BasicTensor3D;
+template <typename TValue> class BasicTensor3DView;
+template <typename TValue> class BasicBrickedTensor3D;
+template <typename TValue> class BasicCompressedTensor3D;
+
+/*!
+ * \enum TriangleAllocation
+ * \brief The TriangleAllocation enum defines how MarchingCubes::isoSurface
+ * allocates the vector of triangles it returns.
+ *
+ * - Growing: the triangles are calculated in one pass, and appended to
+ *   vectors that grow as required.
+ * - CountThenFill: a first pass counts the triangles of each cube from its
+ *   configuration, then a second pass writes the triangles into a vector
+ *   allocated with the exact size. It avoids the reallocations, and the
+ *   temporary doubling of memory, at the cost of classifying each cube twice.
+ */
+enum class TriangleAllocation { Growing, CountThenFill };
+
+/*!
+ * \class TrianglesWithNormals
+ * \brief The class TrianglesWithNormals stores the result of
+ * MarchingCubes::isoSurfaceWithNormalsAsync: normals[i] belongs to
+ * triangles[i].
+ */
+struct TrianglesWithNormals {
+  std::vector<Triangle3D> triangles;
+  std::vector<TriangleNormals> normals;
+};
 
 /*!
  * \class MarchingCubes
  * \brief The MarchingCubes class calculates isosurfaces as triangles for a
  * given 3D tensor applied on a given 3D grid domain.
  *
+ * When the thread count is greater than 1, the tensor is split into Z slabs
+ * that are processed in parallel. The triangles of the slabs are merged in Z
+ * order, so the result does not depend on the thread count.
+ *
  * Note that this class hides some dependencies by using the private
  * implementation idiom.
  */
 class MarchingCubes {
 
 public:
-  MarchingCubes();
+  explicit MarchingCubes(std::size_t threadCount = 1);
   ~MarchingCubes();
 
-  std::vector<Triangle3D> isoSurface(const Grid3D &grid, const Tensor3D &tensor,
-                                     double isoValue) const;
+  /*!
+   * The number of threads of the calculations, at least 1: the constructor
+   * and setThreadCount throw std::invalid_argument for 0.
+   */
+  std::size_t threadCount() const;
+  void setThreadCount(std::size_t threadCount);
+
+  TriangleAllocation triangleAllocation() const;
+  void setTriangleAllocation(TriangleAllocation allocation);
+
+  /*!
+   * Calculates the isosurface of tensor for isoValue. TValue is one of the
+   * value types of BasicTensor3D: the cubes are classified with the values in
+   * their native type, which are converted to double only to interpolate the
+   * intersection points.
+   *
+   * TCoordinate is the type of the coordinates of the triangles, double or
+   * float: isoSurface<float> interpolates the intersection points in single
+   * precision, and returns triangles of half the size, for instance to pass
+   * them to OpenGL.
+   */
+  template <typename TCoordinate = double, typename TValue>
+  std::vector<BasicTriangle3D<TCoordinate>>
+  isoSurface(const Grid3D &grid, const BasicTensor3D<TValue> &tensor,
+             double isoValue) const;
+
+  /*!
+   * Calculates the isosurface of the values of view for isoValue, in place:
+   * the values are not copied, whatever their layout. The rows whose values
+   * are not contiguous, i.e. when view.stride(X) != 1, are gathered one at a
+   * time before being classified.
+   */
+  template <typename TCoordinate = double, typename TValue>
+  std::vector<BasicTriangle3D<TCoordinate>>
+  isoSurface(const Grid3D &grid, const BasicTensor3DView<TValue> &view,
+             double isoValue) const;
+
+  /*!
+   * Calculates the isosurface of a bricked tensor for isoValue, brick by
+   * brick: the bricks whose values are all on the same side of isoValue are
+   * skipped, and each brick is traversed in its own values. The triangles
+   * are the same as the ones of the tensor, but in the order of the bricks,
+   * and in Z, Y, X order within a brick. With several threads, each thread
+   * calculates the bricks of its own Z layers of bricks.
+   */
+  template <typename TCoordinate = double, typename TValue>
+  std::vector<BasicTriangle3D<TCoordinate>>
+  isoSurface(const Grid3D &grid, const BasicBrickedTensor3D<TValue> &tensor,
+             double isoValue) const;
+
+  /*!
+   * Calculates the isosurface of a compressed tensor for isoValue, like for
+   * a bricked tensor: the bricks that may intersect the isosurface are
+   * decompressed one at a time into a buffer of each thread, and the
+   * triangles are in the same order.
+   */
+  template <typename TCoordinate = double, typename TValue>
+  std::vector<BasicTriangle3D<TCoordinate>>
+  isoSurface(const Grid3D &grid,
+             const BasicCompressedTensor3D<TValue> &tensor,
+             double isoValue) const;
+
+  /*!
+   * Calculates the isosurface of tensor for isoValue in the cells of box only,
+   * without copying the values of the box: the time is proportional to the
+   * size of the box rather than to the size of the tensor. The triangles are
+   * the ones of the whole isosurface that lie in the box, in the same order.
+   *
+   * The min-max hierarchy of the tensor is only used when box is the whole
+   * tensor. Throws std::invalid_argument if box is not inside the tensor.
+   */
+  template <typename TCoordinate = double, typename TValue>
+  std::vector<BasicTriangle3D<TCoordinate>>
+  isoSurface(const Grid3D &grid, const BasicTensor3D<TValue> &tensor,
+             double isoValue, const IndexBox &box) const;
+
+  /*!
+   * Calculates the isosurface of tensor for isoValue, and passes its
+   * triangles to sink in batches, in the order of the vector returned by
+   * isoSurface, without storing the whole isosurface. With several threads,
+   * each Z slab is calculated in its own buffer, and the buffers are passed
+   * to sink in Z order. The vector returned by isoSurface with the Growing
+   * allocation is filled by the same calculation.
+   */
+  template <typename TCoordinate = double, typename TValue>
+  void isoSurface(const Grid3D &grid, const BasicTensor3D<TValue> &tensor,
+                  double isoValue, BasicTriangleSink<TCoordinate> &sink) const {
+    isoSurfaceToSink(grid, tensor, isoValue, nullptr, sink, nullptr);
+  }
+
+  /*!
+   * Same as above in the cells of box only, see isoSurface(grid, tensor,
+   * isoValue, box).
+   */
+  template <typename TCoordinate = double, typename TValue>
+  void isoSurface(const Grid3D &grid, const BasicTensor3D<TValue> &tensor,
+                  double isoValue, const IndexBox &box,
+                  BasicTriangleSink<TCoordinate> &sink) const {
+    isoSurfaceToSink(grid, tensor, isoValue, &box, sink, nullptr);
+  }
+
+  /*!
+   * Same as above, and counts the rows of cubes in progress, see
+   * isoSurface(grid, tensor, isoValue, progress).
+   */
+  template <typename TCoordinate = double, typename TValue>
+  void isoSurface(const Grid3D &grid, const BasicTensor3D<TValue> &tensor,
+                  double isoValue, const IndexBox &box,
+                  BasicTriangleSink<TCoordinate> &sink,
+                  IsoSurfaceProgress &progress) const {
+    isoSurfaceToSink(grid, tensor, isoValue, &box, sink, &progress);
+  }
+
+  /*!
+   * Same as above for any sink with a member emitBatch(triangles, count) or
+   * emit(triangle), see TriangleSinkAdapter.
+   */
+  template <typename TValue, typename TSink>
+  std::enable_if_t<internal::IS_ADAPTABLE_SINK<std::decay_t<TSink>>>
+  isoSurface(const Grid3D &grid, const BasicTensor3D<TValue> &tensor,
+             double isoValue, TSink &&sink) const {
+    TriangleSinkAdapter<std::remove_reference_t<TSink>> adapter{sink};
+    isoSurface(grid, tensor, isoValue, static_cast<TriangleSink &>(adapter));
+  }
+
+  /*!
+   * Calculates the same isosurface as isoSurface, and stores in normals the
+   * unit normals of the isosurface at the vertices of its triangles: normals[i]
+   * belongs to the triangle i. They are interpolated from the gradients of the
+   * values at the vertices of the cubes, calculated by central differences in
+   * the same pass as the triangles, and point towards the greater values.
+   */
+  template <typename TValue>
+  std::vector<Triangle3D>
+  isoSurfaceWithNormals(const Grid3D &grid,
+                        const BasicTensor3D<TValue> &tensor, double isoValue,
+                        std::vector<TriangleNormals> &normals) const;
+
+  /*!
+   * Calculates the same isosurface as isoSurface, but returns it as an
+   * IndexedMesh: the intersection of the isosurface with a grid edge is
+   * calculated once, and is shared by all the triangles that use it.
+   */
+  template <typename TValue>
+  IndexedMesh isoSurfaceMesh(const Grid3D &grid,
+                             const BasicTensor3D<TValue> &tensor,
+                             double isoValue) const;
+
+  /*!
+   * Same as isoSurfaceMesh, and stores in the normals of the mesh the normal
+   * of the isosurface at each vertex, as calculated by isoSurfaceWithNormals.
+   * This mesh can be given directly to QuadricDecimation.
+   */
+  template <typename TValue>
+  IndexedMesh isoSurfaceMeshWithNormals(const Grid3D &grid,
+                                        const BasicTensor3D<TValue> &tensor,
+                                        double isoValue) const;
+
+  /*!
+   * Calculates the isosurfaces of tensor for several isovalues, such as the
+   * skin and the bone of a CT series, in one pass over the tensor: the
+   * values of each row are classified against all the isovalues while they
+   * are in cache. The isosurface of isoValues[i] is returned at index i, and
+   * is the same as isoSurface(grid, tensor, isoValues[i]).
+   */
+  template <typename TValue>
+  std::vector<std::vector<Triangle3D>>
+  isoSurfaces(const Grid3D &grid, const BasicTensor3D<TValue> &tensor,
+              const std::vector<double> &isoValues) const;
+
+  /*!
+   * Same as isoSurface(grid, tensor, isoValue), and counts the rows of cubes
+   * in progress as they are done: progress is checked between the rows, and
+   * the calculation throws IsoSurfaceCancelled once its token is cancelled.
+   */
+  template <typename TValue>
+  std::vector<Triangle3D> isoSurface(const Grid3D &grid,
+                                     const BasicTensor3D<TValue> &tensor,
+                                     double isoValue,
+                                     IsoSurfaceProgress &progress) const;
+
+  /*!
+   * Same as isoSurfaceWithNormals, with a progress, see above.
+   */
+  template <typename TValue>
+  std::vector<Triangle3D>
+  isoSurfaceWithNormals(const Grid3D &grid,
+                        const BasicTensor3D<TValue> &tensor, double isoValue,
+                        std::vector<TriangleNormals> &normals,
+                        IsoSurfaceProgress &progress) const;
+
+  /*!
+   * Same as isoSurfaceMeshWithNormals, with a progress, see above.
+   */
+  template <typename TValue>
+  IndexedMesh isoSurfaceMeshWithNormals(const Grid3D &grid,
+                                        const BasicTensor3D<TValue> &tensor,
+                                        double isoValue,
+                                        IsoSurfaceProgress &progress) const;
+
+  /*!
+   * Starts the calculation of isoSurface(grid, tensor, isoValue) on a thread
+   * of its own, and returns at once the job that reports its progress and
+   * returns its triangles. Cancelling token, or the job, stops the
+   * calculation at the end of its current rows of cubes.
+   *
+   * grid, tensor and this object must outlive the job, and the thread count
+   * must not be changed while the job runs.
+   */
+  template <typename TValue>
+  IsoSurfaceJob<std::vector<Triangle3D>> isoSurfaceAsync(
+      const Grid3D &grid, const BasicTensor3D<TValue> &tensor,
+      double isoValue,
+      std::shared_ptr<CancellationToken> token =
+          std::make_shared<CancellationToken>()) const {
+    auto progress = std::make_shared<IsoSurfaceProgress>(token);
+    auto result = std::async(std::launch::async, [=, &grid, &tensor] {
+      return isoSurface(grid, tensor, isoValue, *progress);
+    });
+    return {std::move(token), std::move(progress), std::move(result)};
+  }
+
+  /*!
+   * Same as isoSurfaceAsync for isoSurfaceWithNormals.
+   */
+  template <typename TValue>
+  IsoSurfaceJob<TrianglesWithNormals> isoSurfaceWithNormalsAsync(
+      const Grid3D &grid, const BasicTensor3D<TValue> &tensor,
+      double isoValue,
+      std::shared_ptr<CancellationToken> token =
+          std::make_shared<CancellationToken>()) const {
+    auto progress = std::make_shared<IsoSurfaceProgress>(token);
+    auto result = std::async(std::launch::async, [=, &grid, &tensor] {
+      TrianglesWithNormals surface;
+      surface.triangles = isoSurfaceWithNormals(grid, tensor, isoValue,
+                                                surface.normals, *progress);
+      return surface;
+    });
+    return {std::move(token), std::move(progress), std::move(result)};
+  }
+
+private:
+  /*!
+   * The sink overloads of isoSurface, on the whole tensor when box is null,
+   * and without progress when progress is null.
+   */
+  template <typename TCoordinate, typename TValue>
+  void isoSurfaceToSink(const Grid3D &grid,
+                        const BasicTensor3D<TValue> &tensor, double isoValue,
+                        const IndexBox *box,
+                        BasicTriangleSink<TCoordinate> &sink,
+                        IsoSurfaceProgress *progress) const;
 
 private:
   const std::unique_ptr<class MarchingCubesImpl> pImpl;
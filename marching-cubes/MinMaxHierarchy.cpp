@@ -0,0 +1,148 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/MinMaxHierarchy.hpp"
+
+#include "marching-cubes/Tensor3D.hpp"
+
+#include <algorithm>
+
+namespace marchingcubes {
+
+static size_t ceilDiv(size_t numerator, size_t denominator) {
+  return (numerator + denominator - 1) / denominator;
+}
+
+template <typename TValue>
+MinMaxHierarchy::MinMaxHierarchy(const BasicTensor3D<TValue> &tensor,
+                                 size_t brickSize)
+    : mBrickSize{brickSize}, cubeCount{{tensor.size(X) - 1, tensor.size(Y) - 1,
+                                        tensor.size(Z) - 1}} {
+  assert(brickSize > 0);
+  Level level0;
+  for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    level0.brickCount[iDim] =
+        std::max<size_t>(1, ceilDiv(cubeCount[iDim], brickSize));
+  }
+  level0.minMax.resize(level0.brickCount[X] * level0.brickCount[Y] *
+                       level0.brickCount[Z]);
+  // The cubes of a brick use the values up to the first value of the next
+  // brick, so the bricks overlap by one value.
+  auto lastValue = [&](size_t brick, size_t dimIndex) {
+    return std::min((brick + 1) * brickSize, tensor.size(dimIndex) - 1);
+  };
+  for (size_t bz = 0; bz < level0.brickCount[Z]; ++bz) {
+    for (size_t by = 0; by < level0.brickCount[Y]; ++by) {
+      for (size_t bx = 0; bx < level0.brickCount[X]; ++bx) {
+        auto min = static_cast<double>(
+            tensor.value(bx * brickSize, by * brickSize, bz * brickSize));
+        auto max = min;
+        for (auto z = bz * brickSize; z <= lastValue(bz, Z); ++z) {
+          for (auto y = by * brickSize; y <= lastValue(by, Y); ++y) {
+            for (auto x = bx * brickSize; x <= lastValue(bx, X); ++x) {
+              auto value = static_cast<double>(tensor.value(x, y, z));
+              min = std::min(min, value);
+              max = std::max(max, value);
+            }
+          }
+        }
+        level0.minMax[level0.index(bx, by, bz)] = std::make_pair(min, max);
+      }
+    }
+  }
+  levels.push_back(std::move(level0));
+
+  auto isLastLevel = [](const Level &level) {
+    return level.brickCount[X] == 1 && level.brickCount[Y] == 1 &&
+           level.brickCount[Z] == 1;
+  };
+  while (!isLastLevel(levels.back())) {
+    const auto &finer = levels.back();
+    Level coarser;
+    for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+      coarser.brickCount[iDim] = ceilDiv(finer.brickCount[iDim], 2);
+    }
+    coarser.minMax.reserve(coarser.brickCount[X] * coarser.brickCount[Y] *
+                           coarser.brickCount[Z]);
+    for (size_t bz = 0; bz < coarser.brickCount[Z]; ++bz) {
+      for (size_t by = 0; by < coarser.brickCount[Y]; ++by) {
+        for (size_t bx = 0; bx < coarser.brickCount[X]; ++bx) {
+          auto minMax = finer.minMax[finer.index(2 * bx, 2 * by, 2 * bz)];
+          for (auto z = 2 * bz; z < std::min(2 * bz + 2, finer.brickCount[Z]);
+               ++z) {
+            for (auto y = 2 * by;
+                 y < std::min(2 * by + 2, finer.brickCount[Y]); ++y) {
+              for (auto x = 2 * bx;
+                   x < std::min(2 * bx + 2, finer.brickCount[X]); ++x) {
+                const auto &child = finer.minMax[finer.index(x, y, z)];
+                minMax.first = std::min(minMax.first, child.first);
+                minMax.second = std::max(minMax.second, child.second);
+              }
+            }
+          }
+          coarser.minMax.push_back(minMax);
+        }
+      }
+    }
+    levels.push_back(std::move(coarser));
+  }
+}
+
+template MinMaxHierarchy::MinMaxHierarchy(const Tensor3D &, size_t);
+template MinMaxHierarchy::MinMaxHierarchy(const Tensor3DFloat &, size_t);
+template MinMaxHierarchy::MinMaxHierarchy(const Tensor3DUint8 &, size_t);
+template MinMaxHierarchy::MinMaxHierarchy(const Tensor3DInt16 &, size_t);
+template MinMaxHierarchy::MinMaxHierarchy(const Tensor3DUint16 &, size_t);
+
+std::pair<double, double> MinMaxHierarchy::minMax(size_t level, size_t bx,
+                                                  size_t by, size_t bz) const {
+  const auto &currentLevel = levels.at(level);
+  assert(bx < currentLevel.brickCount[X]);
+  assert(by < currentLevel.brickCount[Y]);
+  assert(bz < currentLevel.brickCount[Z]);
+  return currentLevel.minMax[currentLevel.index(bx, by, bz)];
+}
+
+void MinMaxHierarchy::intersectingXRanges(
+    size_t y, size_t z, double isoValue,
+    std::vector<std::pair<size_t, size_t>> &xRanges) const {
+  assert(y < cubeCount[Y]);
+  assert(z < cubeCount[Z]);
+  xRanges.clear();
+  const auto topLevel = levels.size() - 1;
+  for (size_t bx = 0; bx < levels[topLevel].brickCount[X]; ++bx) {
+    addXRanges(topLevel, bx, y, z, isoValue, xRanges);
+  }
+}
+
+void MinMaxHierarchy::addXRanges(
+    size_t level, size_t bx, size_t y, size_t z, double isoValue,
+    std::vector<std::pair<size_t, size_t>> &xRanges) const {
+  const auto by = (y / mBrickSize) >> level;
+  const auto bz = (z / mBrickSize) >> level;
+  if (!mayIntersect(level, bx, by, bz, isoValue)) {
+    return;
+  }
+  if (level > 0) {
+    const auto childCount = levels[level - 1].brickCount[X];
+    for (auto child = 2 * bx; child < std::min(2 * bx + 2, childCount);
+         ++child) {
+      addXRanges(level - 1, child, y, z, isoValue, xRanges);
+    }
+    return;
+  }
+  const auto xBegin = bx * mBrickSize;
+  const auto xEnd = std::min(xBegin + mBrickSize, cubeCount[X]);
+  if (!xRanges.empty() && xRanges.back().second == xBegin) {
+    xRanges.back().second = xEnd;
+  } else {
+    xRanges.emplace_back(xBegin, xEnd);
+  }
+}
+
+} // namespace marchingcubes
@@ -0,0 +1,92 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include "marching-cubes/Geometry3D.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace marchingcubes {
+
+template <typename TValue> class BasicTensor3D;
+
+/*!
+ * \class MinMaxHierarchy
+ * \brief The class MinMaxHierarchy stores the min and max values of the
+ * cubes of a BasicTensor3D grouped into bricks, so that the bricks that cannot
+ * intersect an isosurface can be skipped.
+ *
+ * At level 0, a brick contains brickSize^3 cubes: the brick (bx, by, bz)
+ * contains the cubes whose vertex 0 has the indices
+ * [bx * brickSize, (bx + 1) * brickSize) x [by * brickSize, ...) x ...
+ * A brick of level l + 1 groups 2x2x2 bricks of level l. The last level
+ * contains one single brick.
+ */
+class MinMaxHierarchy {
+
+public:
+  template <typename TValue>
+  explicit MinMaxHierarchy(const BasicTensor3D<TValue> &tensor,
+                           size_t brickSize = 8);
+
+public:
+  size_t brickSize() const { return mBrickSize; }
+  size_t levelCount() const { return levels.size(); }
+  size_t brickCount(size_t level, size_t dimIndex) const {
+    return levels.at(level).brickCount[dimIndex];
+  }
+
+  /*!
+   * Returns the min and max of the values on the cubes of the given brick.
+   */
+  std::pair<double, double> minMax(size_t level, size_t bx, size_t by,
+                                   size_t bz) const;
+
+  /*!
+   * Returns false when no cube of the given brick can intersect the
+   * isosurface for isoValue, i.e. when all the values of the brick are
+   * either less than isoValue, or greater than or equal to isoValue.
+   */
+  bool mayIntersect(size_t level, size_t bx, size_t by, size_t bz,
+                    double isoValue) const {
+    auto [min, max] = minMax(level, bx, by, bz);
+    return min < isoValue && isoValue <= max;
+  }
+
+  /*!
+   * Replaces the content of xRanges by the [xBegin, xEnd) ranges of X
+   * indices of the cubes that may intersect the isosurface, for the row of
+   * cubes whose vertex 0 has the Y and Z indices y and z.
+   */
+  void
+  intersectingXRanges(size_t y, size_t z, double isoValue,
+                      std::vector<std::pair<size_t, size_t>> &xRanges) const;
+
+private:
+  struct Level {
+    std::array<size_t, DIM_COUNT> brickCount;
+    std::vector<std::pair<double, double>> minMax;
+
+    size_t index(size_t bx, size_t by, size_t bz) const {
+      return bx + brickCount[X] * (by + brickCount[Y] * bz);
+    }
+  };
+
+  void addXRanges(size_t level, size_t bx, size_t y, size_t z,
+                  double isoValue,
+                  std::vector<std::pair<size_t, size_t>> &xRanges) const;
+
+private:
+  const size_t mBrickSize;
+  const std::array<size_t, DIM_COUNT> cubeCount;
+  std::vector<Level> levels;
+};
+
+} // namespace marchingcubes
@@ -0,0 +1,791 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/QuadricDecimation.hpp"
+
+#include "marching-cubes/IsoSurfaceJob.hpp"
+
+#include "marching-cubes/ThreadPool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+namespace marchingcubes {
+
+static Vector3D difference(const Point3D &lhs, const Point3D &rhs) {
+  return {{lhs[X] - rhs[X], lhs[Y] - rhs[Y], lhs[Z] - rhs[Z]}};
+}
+
+static Vector3D cross(const Vector3D &lhs, const Vector3D &rhs) {
+  return {{lhs[Y] * rhs[Z] - lhs[Z] * rhs[Y],
+           lhs[Z] * rhs[X] - lhs[X] * rhs[Z],
+           lhs[X] * rhs[Y] - lhs[Y] * rhs[X]}};
+}
+
+static double dot(const Vector3D &lhs, const Vector3D &rhs) {
+  return lhs[X] * rhs[X] + lhs[Y] * rhs[Y] + lhs[Z] * rhs[Z];
+}
+
+static Vector3D triangleNormal(const Point3D &a, const Point3D &b,
+                               const Point3D &c) {
+  return cross(difference(b, a), difference(c, a));
+}
+
+/*!
+ * \class Quadric
+ * \brief The class Quadric stores the symmetric 4x4 matrix Q of a sum of
+ * squared distances to planes: the sum for the point p is (p, 1)^T Q (p, 1).
+ */
+class Quadric {
+
+public:
+  Quadric() { coefficients.fill(0.0); }
+
+  /*!
+   * Returns the quadric of the squared distance to the plane of the point
+   * through which passes the plane of unit normal normal.
+   */
+  static Quadric ofPlane(const Vector3D &normal, const Point3D &point) {
+    const auto d = -dot(normal, point);
+    Quadric quadric;
+    quadric.coefficients = {{normal[X] * normal[X], normal[X] * normal[Y],
+                             normal[X] * normal[Z], normal[X] * d,
+                             normal[Y] * normal[Y], normal[Y] * normal[Z],
+                             normal[Y] * d, normal[Z] * normal[Z],
+                             normal[Z] * d, d * d}};
+    return quadric;
+  }
+
+public:
+  Quadric &operator+=(const Quadric &other) {
+    for (size_t i = 0; i < coefficients.size(); ++i) {
+      coefficients[i] += other.coefficients[i];
+    }
+    return *this;
+  }
+
+  double error(const Point3D &p) const {
+    const auto &q = coefficients;
+    const auto value = q[0] * p[X] * p[X] + 2.0 * q[1] * p[X] * p[Y] +
+                       2.0 * q[2] * p[X] * p[Z] + 2.0 * q[3] * p[X] +
+                       q[4] * p[Y] * p[Y] + 2.0 * q[5] * p[Y] * p[Z] +
+                       2.0 * q[6] * p[Y] + q[7] * p[Z] * p[Z] +
+                       2.0 * q[8] * p[Z] + q[9];
+    // The rounding errors may make it slightly negative.
+    return std::max(0.0, value);
+  }
+
+  /*!
+   * Calculates in minimum the point that minimizes the error, and returns
+   * false when it is not unique, e.g. when all the planes are parallel.
+   */
+  bool minimize(Point3D &minimum) const {
+    const auto &q = coefficients;
+    // Solves A p = -b by Cramer's rule, with A = [q0 q1 q2; q1 q4 q5;
+    // q2 q5 q7] and b = (q3, q6, q8).
+    const auto minor0 = q[4] * q[7] - q[5] * q[5];
+    const auto minor1 = q[1] * q[7] - q[5] * q[2];
+    const auto minor2 = q[1] * q[5] - q[4] * q[2];
+    const auto determinant = q[0] * minor0 - q[1] * minor1 + q[2] * minor2;
+    const auto scale = q[0] + q[4] + q[7];
+    if (std::abs(determinant) <=
+        DETERMINANT_TOLERANCE * scale * scale * scale) {
+      return false;
+    }
+    const auto bX = -q[3];
+    const auto bY = -q[6];
+    const auto bZ = -q[8];
+    minimum[X] = (bX * minor0 - q[1] * (bY * q[7] - q[5] * bZ) +
+                  q[2] * (bY * q[5] - q[4] * bZ)) /
+                 determinant;
+    minimum[Y] = (q[0] * (bY * q[7] - q[5] * bZ) - bX * minor1 +
+                  q[2] * (q[1] * bZ - bY * q[2])) /
+                 determinant;
+    minimum[Z] = (q[0] * (q[4] * bZ - q[5] * bY) -
+                  q[1] * (q[1] * bZ - q[5] * bX) + bX * minor2) /
+                 determinant;
+    return true;
+  }
+
+private:
+  // Relative to the cube of the trace of A.
+  static constexpr double DETERMINANT_TOLERANCE = 1e-10;
+
+  // The upper triangle of Q, row by row.
+  std::array<double, 10> coefficients;
+};
+
+/*!
+ * \class Collapse
+ * \brief The class Collapse is the candidate collapse of the edge (kept,
+ * removed) into position, valid as long as the versions of the 2 vertices
+ * have not changed.
+ */
+struct Collapse {
+  double cost;
+  std::uint32_t kept;
+  std::uint32_t removed;
+  std::uint32_t keptVersion;
+  std::uint32_t removedVersion;
+  Point3D position;
+
+  bool operator>(const Collapse &other) const { return cost > other.cost; }
+};
+
+using CollapseQueue =
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>>;
+
+/*!
+ * The number of steps of a loop between 2 checks of the cancellation token.
+ */
+constexpr size_t CANCELLATION_CHECK_PERIOD = 4096;
+
+/*!
+ * Throws IsoSurfaceCancelled if token is not null and is cancelled, at every
+ * CANCELLATION_CHECK_PERIOD-th step of a loop.
+ */
+static void checkCancellation(const CancellationToken *token,
+                              size_t iStep = 0) {
+  if (token != nullptr && iStep % CANCELLATION_CHECK_PERIOD == 0 &&
+      token->isCancelled()) {
+    throw IsoSurfaceCancelled{};
+  }
+}
+
+/*!
+ * \class Decimation
+ * \brief The class Decimation holds the state of QuadricDecimation::decimate
+ * shared by the slabs.
+ *
+ * Each vertex that is not locked belongs to the only slab of its triangles,
+ * so the slabs read and write disjoint vertices and triangles.
+ */
+class Decimation {
+
+public:
+  static constexpr std::uint32_t LOCKED =
+      std::numeric_limits<std::uint32_t>::max();
+
+public:
+  Decimation(const IndexedMesh &mesh, size_t slabCount)
+      : vertices{mesh.vertices}, triangles{mesh.triangles},
+        normals{mesh.normals}, vertexSlabs(mesh.vertices.size(), NO_SLAB),
+        quadrics(mesh.vertices.size()),
+        vertexTriangles(mesh.vertices.size()),
+        versions(mesh.vertices.size(), 0),
+        removedVertices(mesh.vertices.size(), false),
+        removedTriangles(mesh.triangles.size(), false),
+        slabTriangles(slabCount), slabCandidates(slabCount),
+        slabTriangleCounts(slabCount, 0) {
+    assignSlabs();
+  }
+
+public:
+  size_t slabCount() const { return slabTriangles.size(); }
+
+  /*!
+   * Returns the number of remaining triangles of the slab.
+   */
+  size_t slabTriangleCount(size_t iSlab) const {
+    return slabTriangleCounts[iSlab];
+  }
+
+  /*!
+   * Returns the number of triangles with a vertex shared by several slabs.
+   */
+  size_t seamTriangleCount() const { return seamCount; }
+
+  /*!
+   * Locks the boundary of the slab, and calculates the quadrics of its
+   * vertices and the collapses of its edges. Throws IsoSurfaceCancelled once
+   * token, if any, is cancelled.
+   */
+  void prepareSlab(size_t iSlab, const CancellationToken *token);
+
+  /*!
+   * Collapses the edges of the slab, the cheapest first, until targetCount
+   * triangles remain, or the cheapest collapse costs more than maxCost.
+   * Throws IsoSurfaceCancelled once token, if any, is cancelled.
+   */
+  void decimateSlab(size_t iSlab, size_t targetCount, double maxCost,
+                    const CancellationToken *token);
+
+  /*!
+   * Returns the cost of the cheapest collapse of the slab, or infinity.
+   */
+  double nextCost(size_t iSlab);
+
+  /*!
+   * Merges the slabs into one, and unlocks the vertices shared by several
+   * slabs that are not on the boundary of the mesh, so that the collapses
+   * of the edges on the seams between the slabs may follow. Throws
+   * IsoSurfaceCancelled once token, if any, is cancelled.
+   */
+  void mergeSlabs(const CancellationToken *token);
+
+  IndexedMesh result() const;
+
+private:
+  static constexpr std::uint32_t NO_SLAB = LOCKED - 1;
+
+  void assignSlabs();
+  void lockDegenerateTriangles();
+  void lockBoundary(std::uint32_t slab);
+  Quadric planeQuadric(std::uint32_t iTriangle) const;
+  void addCandidates(std::uint32_t slab, const CancellationToken *token);
+  bool isFree(std::uint32_t vertex, std::uint32_t slab) const {
+    return vertexSlabs[vertex] == slab;
+  }
+  Collapse evaluate(std::uint32_t kept, std::uint32_t removed) const;
+  bool canCollapse(const Collapse &collapse);
+  size_t collapse(const Collapse &collapse);
+  void neighboursOf(std::uint32_t vertex, std::vector<std::uint32_t> &result);
+
+private:
+  std::vector<Point3D> vertices;
+  std::vector<IndexedTriangle> triangles;
+  std::vector<Vector3D> normals;
+  // The slab of each vertex, or LOCKED.
+  std::vector<std::uint32_t> vertexSlabs;
+  std::vector<Quadric> quadrics;
+  // The remaining triangles of each vertex that is not locked.
+  std::vector<std::vector<std::uint32_t>> vertexTriangles;
+  std::vector<std::uint32_t> versions;
+  std::vector<char> removedVertices;
+  std::vector<char> removedTriangles;
+  std::vector<std::vector<std::uint32_t>> slabTriangles;
+  std::vector<CollapseQueue> slabCandidates;
+  std::vector<size_t> slabTriangleCounts;
+  size_t seamCount = 0;
+};
+
+void Decimation::assignSlabs() {
+  Point3D min = vertices.front();
+  Point3D max = vertices.front();
+  for (const auto &vertex : vertices) {
+    for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+      min[iDim] = std::min(min[iDim], vertex[iDim]);
+      max[iDim] = std::max(max[iDim], vertex[iDim]);
+    }
+  }
+  size_t axis = X;
+  for (size_t iDim = Y; iDim < DIM_COUNT; ++iDim) {
+    if (max[iDim] - min[iDim] > max[axis] - min[axis]) {
+      axis = iDim;
+    }
+  }
+  const auto extent = max[axis] - min[axis];
+  for (size_t iTriangle = 0; iTriangle < triangles.size(); ++iTriangle) {
+    const auto &triangle = triangles[iTriangle];
+    const auto center = (vertices[triangle[0]][axis] +
+                         vertices[triangle[1]][axis] +
+                         vertices[triangle[2]][axis]) /
+                        3.0;
+    const auto slab = static_cast<std::uint32_t>(
+        extent > 0.0 ? std::min(slabCount() - 1,
+                                static_cast<size_t>((center - min[axis]) /
+                                                    extent * slabCount()))
+                     : 0);
+    slabTriangles[slab].push_back(static_cast<std::uint32_t>(iTriangle));
+    for (auto vertex : triangle) {
+      auto &vertexSlab = vertexSlabs[vertex];
+      vertexSlab = vertexSlab == NO_SLAB || vertexSlab == slab ? slab : LOCKED;
+    }
+  }
+  seamCount = static_cast<size_t>(std::count_if(
+      triangles.begin(), triangles.end(), [this](const auto &triangle) {
+        return std::any_of(
+            triangle.begin(), triangle.end(),
+            [this](auto vertex) { return vertexSlabs[vertex] == LOCKED; });
+      }));
+  lockDegenerateTriangles();
+}
+
+void Decimation::lockDegenerateTriangles() {
+  // The triangles that use a vertex twice, e.g. where the isosurface goes
+  // through a point of the grid, are left as they are.
+  for (size_t iTriangle = 0; iTriangle < triangles.size(); ++iTriangle) {
+    const auto &triangle = triangles[iTriangle];
+    if (!removedTriangles[iTriangle] &&
+        (triangle[0] == triangle[1] || triangle[1] == triangle[2] ||
+         triangle[2] == triangle[0])) {
+      for (auto vertex : triangle) {
+        vertexSlabs[vertex] = LOCKED;
+      }
+    }
+  }
+}
+
+void Decimation::lockBoundary(std::uint32_t slab) {
+  // The edges with a free vertex are only in the triangles of the slab: an
+  // edge that is not in exactly 2 of them is on the boundary of the mesh, or
+  // is non-manifold.
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+  for (auto iTriangle : slabTriangles[slab]) {
+    const auto &triangle = triangles[iTriangle];
+    for (size_t i = 0; i < triangle::POINT_COUNT; ++i) {
+      const auto a = triangle[i];
+      const auto b = triangle[(i + 1) % triangle::POINT_COUNT];
+      if (isFree(a, slab) || isFree(b, slab)) {
+        edges.emplace_back(std::min(a, b), std::max(a, b));
+      }
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  std::vector<std::uint32_t> boundaryVertices;
+  for (size_t begin = 0, end = 0; begin < edges.size(); begin = end) {
+    while (end < edges.size() && edges[end] == edges[begin]) {
+      ++end;
+    }
+    if (end - begin != 2) {
+      boundaryVertices.push_back(edges[begin].first);
+      boundaryVertices.push_back(edges[begin].second);
+    }
+  }
+  for (auto vertex : boundaryVertices) {
+    if (isFree(vertex, slab)) {
+      vertexSlabs[vertex] = LOCKED;
+    }
+  }
+}
+
+Collapse Decimation::evaluate(std::uint32_t kept,
+                              std::uint32_t removed) const {
+  auto quadric = quadrics[kept];
+  quadric += quadrics[removed];
+  const auto &p0 = vertices[kept];
+  const auto &p1 = vertices[removed];
+  const Point3D middle{{0.5 * (p0[X] + p1[X]), 0.5 * (p0[Y] + p1[Y]),
+                        0.5 * (p0[Z] + p1[Z])}};
+  Collapse result{0.0, kept, removed, versions[kept], versions[removed], {}};
+  // The optimal point is discarded when it is far from the edge, where the
+  // quadric is ill-conditioned.
+  const auto edge = difference(p1, p0);
+  Point3D optimum;
+  if (quadric.minimize(optimum)) {
+    const auto offset = difference(optimum, middle);
+    if (dot(offset, offset) <= dot(edge, edge)) {
+      result.position = optimum;
+      result.cost = quadric.error(optimum);
+      return result;
+    }
+  }
+  result.position = middle;
+  result.cost = quadric.error(middle);
+  for (const auto &candidate : {p0, p1}) {
+    const auto cost = quadric.error(candidate);
+    if (cost < result.cost) {
+      result.position = candidate;
+      result.cost = cost;
+    }
+  }
+  return result;
+}
+
+void Decimation::neighboursOf(std::uint32_t vertex,
+                              std::vector<std::uint32_t> &result) {
+  result.clear();
+  for (auto iTriangle : vertexTriangles[vertex]) {
+    for (auto other : triangles[iTriangle]) {
+      if (other != vertex) {
+        result.push_back(other);
+      }
+    }
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+bool Decimation::canCollapse(const Collapse &collapse) {
+  const auto &keptTriangles = vertexTriangles[collapse.kept];
+  const auto edgeTriangleCount =
+      std::count_if(keptTriangles.begin(), keptTriangles.end(),
+                    [this, &collapse](std::uint32_t iTriangle) {
+                      const auto &triangle = triangles[iTriangle];
+                      return std::count(triangle.begin(), triangle.end(),
+                                        collapse.removed) > 0;
+                    });
+  if (edgeTriangleCount != 2) {
+    return false;
+  }
+  // Link condition: the 2 vertices have exactly the 2 opposite vertices of
+  // the edge as common neighbours, otherwise the collapse would pinch the
+  // mesh.
+  thread_local std::vector<std::uint32_t> keptNeighbours;
+  thread_local std::vector<std::uint32_t> removedNeighbours;
+  neighboursOf(collapse.kept, keptNeighbours);
+  neighboursOf(collapse.removed, removedNeighbours);
+  size_t commonCount = 0;
+  for (auto neighbour : keptNeighbours) {
+    commonCount += std::binary_search(removedNeighbours.begin(),
+                                      removedNeighbours.end(), neighbour);
+  }
+  if (commonCount != 2) {
+    return false;
+  }
+  // The triangles that remain must not flip.
+  for (auto vertex : {collapse.kept, collapse.removed}) {
+    for (auto iTriangle : vertexTriangles[vertex]) {
+      auto triangle = triangles[iTriangle];
+      const auto hasKept = std::count(triangle.begin(), triangle.end(),
+                                      collapse.kept) > 0;
+      const auto hasRemoved = std::count(triangle.begin(), triangle.end(),
+                                         collapse.removed) > 0;
+      if (hasKept && hasRemoved) {
+        continue;
+      }
+      const auto before = triangleNormal(vertices[triangle[0]],
+                                         vertices[triangle[1]],
+                                         vertices[triangle[2]]);
+      std::array<Point3D, triangle::POINT_COUNT> points;
+      for (size_t i = 0; i < triangle::POINT_COUNT; ++i) {
+        points[i] = triangle[i] == vertex ? collapse.position
+                                          : vertices[triangle[i]];
+      }
+      const auto after = triangleNormal(points[0], points[1], points[2]);
+      if (dot(before, before) > 0.0 && dot(before, after) <= 0.0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+size_t Decimation::collapse(const Collapse &collapse) {
+  const auto kept = collapse.kept;
+  const auto removed = collapse.removed;
+  size_t removedCount = 0;
+  auto &keptTriangles = vertexTriangles[kept];
+  for (auto iTriangle : vertexTriangles[removed]) {
+    auto &triangle = triangles[iTriangle];
+    if (std::count(triangle.begin(), triangle.end(), kept) > 0) {
+      // A triangle of the edge, which degenerates.
+      removedTriangles[iTriangle] = true;
+      ++removedCount;
+      for (auto vertex : triangle) {
+        if (vertex != kept && vertex != removed &&
+            vertexSlabs[vertex] != LOCKED) {
+          auto &others = vertexTriangles[vertex];
+          others.erase(std::remove(others.begin(), others.end(), iTriangle),
+                       others.end());
+        }
+      }
+    } else {
+      std::replace(triangle.begin(), triangle.end(), removed, kept);
+      keptTriangles.push_back(iTriangle);
+    }
+  }
+  keptTriangles.erase(std::remove_if(keptTriangles.begin(),
+                                     keptTriangles.end(),
+                                     [this](std::uint32_t iTriangle) {
+                                       return removedTriangles[iTriangle];
+                                     }),
+                      keptTriangles.end());
+  vertexTriangles[removed].clear();
+  vertexTriangles[removed].shrink_to_fit();
+  removedVertices[removed] = true;
+
+  vertices[kept] = collapse.position;
+  quadrics[kept] += quadrics[removed];
+  if (!normals.empty()) {
+    auto &normal = normals[kept];
+    for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+      normal[iDim] += normals[removed][iDim];
+    }
+    const auto norm = std::sqrt(dot(normal, normal));
+    if (norm > 0.0) {
+      for (auto &coordinate : normal) {
+        coordinate /= norm;
+      }
+    }
+  }
+  ++versions[kept];
+  return removedCount;
+}
+
+Quadric Decimation::planeQuadric(std::uint32_t iTriangle) const {
+  const auto &triangle = triangles[iTriangle];
+  auto normal = triangleNormal(vertices[triangle[0]], vertices[triangle[1]],
+                               vertices[triangle[2]]);
+  const auto norm = std::sqrt(dot(normal, normal));
+  if (norm == 0.0) {
+    return {};
+  }
+  for (auto &coordinate : normal) {
+    coordinate /= norm;
+  }
+  return Quadric::ofPlane(normal, vertices[triangle[0]]);
+}
+
+void Decimation::addCandidates(std::uint32_t slab,
+                               const CancellationToken *token) {
+  auto &candidates = slabCandidates[slab];
+  const auto &slabTriangleIds = slabTriangles[slab];
+  for (size_t i = 0; i < slabTriangleIds.size(); ++i) {
+    checkCancellation(token, i);
+    const auto &triangle = triangles[slabTriangleIds[i]];
+    for (size_t iPoint = 0; iPoint < triangle::POINT_COUNT; ++iPoint) {
+      const auto a = triangle[iPoint];
+      const auto b = triangle[(iPoint + 1) % triangle::POINT_COUNT];
+      // Each interior edge is in 2 triangles, in opposite directions in a
+      // consistently oriented mesh: it is evaluated once or twice.
+      if (a < b && isFree(a, slab) && isFree(b, slab)) {
+        candidates.push(evaluate(a, b));
+      }
+    }
+  }
+}
+
+void Decimation::prepareSlab(size_t iSlab, const CancellationToken *token) {
+  const auto slab = static_cast<std::uint32_t>(iSlab);
+  checkCancellation(token);
+  lockBoundary(slab);
+  const auto &slabTriangleIds = slabTriangles[slab];
+  for (size_t i = 0; i < slabTriangleIds.size(); ++i) {
+    checkCancellation(token, i);
+    const auto iTriangle = slabTriangleIds[i];
+    const auto quadric = planeQuadric(iTriangle);
+    for (auto vertex : triangles[iTriangle]) {
+      if (isFree(vertex, slab)) {
+        quadrics[vertex] += quadric;
+        vertexTriangles[vertex].push_back(iTriangle);
+      }
+    }
+  }
+  addCandidates(slab, token);
+  slabTriangleCounts[slab] = slabTriangleIds.size();
+}
+
+void Decimation::mergeSlabs(const CancellationToken *token) {
+  std::vector<std::uint32_t> remainingTriangles;
+  std::vector<char> unlockedVertices(vertices.size(), false);
+  for (size_t iTriangle = 0; iTriangle < triangles.size(); ++iTriangle) {
+    if (removedTriangles[iTriangle]) {
+      continue;
+    }
+    remainingTriangles.push_back(static_cast<std::uint32_t>(iTriangle));
+    for (auto vertex : triangles[iTriangle]) {
+      if (vertexSlabs[vertex] == LOCKED) {
+        unlockedVertices[vertex] = true;
+      }
+      vertexSlabs[vertex] = 0;
+    }
+  }
+  slabTriangleCounts.assign(1, remainingTriangles.size());
+  slabTriangles.assign(1, std::move(remainingTriangles));
+  slabCandidates.assign(1, {});
+  // The vertices on the boundary of the mesh, or of degenerate triangles,
+  // are locked again.
+  checkCancellation(token);
+  lockDegenerateTriangles();
+  lockBoundary(0);
+  checkCancellation(token);
+  // The quadrics and the triangles of the free vertices are up to date,
+  // those of the unlocked vertices are calculated from their remaining
+  // triangles.
+  for (auto iTriangle : slabTriangles[0]) {
+    const auto quadric = planeQuadric(iTriangle);
+    for (auto vertex : triangles[iTriangle]) {
+      if (unlockedVertices[vertex] && isFree(vertex, 0)) {
+        quadrics[vertex] += quadric;
+        vertexTriangles[vertex].push_back(iTriangle);
+      }
+    }
+  }
+  addCandidates(0, token);
+}
+
+double Decimation::nextCost(size_t iSlab) {
+  auto &candidates = slabCandidates[iSlab];
+  while (!candidates.empty()) {
+    const auto &candidate = candidates.top();
+    if (!removedVertices[candidate.kept] &&
+        !removedVertices[candidate.removed] &&
+        versions[candidate.kept] == candidate.keptVersion &&
+        versions[candidate.removed] == candidate.removedVersion) {
+      return candidate.cost;
+    }
+    candidates.pop(); // Outdated by a previous collapse.
+  }
+  return std::numeric_limits<double>::infinity();
+}
+
+void Decimation::decimateSlab(size_t iSlab, size_t targetCount,
+                              double maxCost,
+                              const CancellationToken *token) {
+  const auto slab = static_cast<std::uint32_t>(iSlab);
+  auto &candidates = slabCandidates[slab];
+  auto &triangleCount = slabTriangleCounts[slab];
+  std::vector<std::uint32_t> neighbours;
+  for (size_t iCandidate = 0;
+       triangleCount > targetCount && nextCost(slab) <= maxCost;
+       ++iCandidate) {
+    checkCancellation(token, iCandidate);
+    const auto candidate = candidates.top();
+    candidates.pop();
+    if (!canCollapse(candidate)) {
+      continue;
+    }
+    triangleCount -= collapse(candidate);
+    neighboursOf(candidate.kept, neighbours);
+    for (auto neighbour : neighbours) {
+      if (isFree(neighbour, slab)) {
+        candidates.push(evaluate(candidate.kept, neighbour));
+      }
+    }
+  }
+}
+
+IndexedMesh Decimation::result() const {
+  IndexedMesh mesh;
+  std::vector<std::uint32_t> newIndices(vertices.size(), LOCKED);
+  std::vector<char> used(vertices.size(), false);
+  for (size_t iTriangle = 0; iTriangle < triangles.size(); ++iTriangle) {
+    if (!removedTriangles[iTriangle]) {
+      for (auto vertex : triangles[iTriangle]) {
+        used[vertex] = true;
+      }
+    }
+  }
+  for (size_t vertex = 0; vertex < vertices.size(); ++vertex) {
+    if (used[vertex]) {
+      newIndices[vertex] = static_cast<std::uint32_t>(mesh.vertices.size());
+      mesh.vertices.push_back(vertices[vertex]);
+      if (!normals.empty()) {
+        mesh.normals.push_back(normals[vertex]);
+      }
+    }
+  }
+  for (size_t iTriangle = 0; iTriangle < triangles.size(); ++iTriangle) {
+    if (!removedTriangles[iTriangle]) {
+      const auto &triangle = triangles[iTriangle];
+      mesh.triangles.push_back(IndexedTriangle{{newIndices[triangle[0]],
+                                                newIndices[triangle[1]],
+                                                newIndices[triangle[2]]}});
+    }
+  }
+  return mesh;
+}
+
+/*!
+ * Collapses the edges of the slabs of decimation in passes, up to a cost
+ * threshold that grows from pass to pass, so that the edges are collapsed
+ * in nearly the same order as with a single slab. Each slab removes at most
+ * its share of the triangles in excess. It stops when targetCount triangles
+ * remain, or when the cheapest collapse costs more than maxCost.
+ */
+static void decimatePasses(Decimation &decimation, ThreadPool &pool,
+                           size_t targetCount, double maxCost,
+                           const CancellationToken *token) {
+  const auto slabCount = decimation.slabCount();
+  double threshold = 0.0;
+  while (true) {
+    size_t triangleCount = 0;
+    for (size_t iSlab = 0; iSlab < slabCount; ++iSlab) {
+      triangleCount += decimation.slabTriangleCount(iSlab);
+    }
+    if (triangleCount <= targetCount) {
+      break;
+    }
+    const auto excess = triangleCount - targetCount;
+    pool.run(slabCount, [&](std::size_t iSlab) {
+      const auto slabTriangleCount = decimation.slabTriangleCount(iSlab);
+      const auto slabExcess =
+          std::min(slabTriangleCount,
+                   (excess * slabTriangleCount + triangleCount - 1) /
+                       triangleCount);
+      decimation.decimateSlab(iSlab, slabTriangleCount - slabExcess,
+                              threshold, token);
+    });
+    auto nextCost = std::numeric_limits<double>::infinity();
+    for (size_t iSlab = 0; iSlab < slabCount; ++iSlab) {
+      nextCost = std::min(nextCost, decimation.nextCost(iSlab));
+    }
+    if (nextCost == std::numeric_limits<double>::infinity() ||
+        nextCost > maxCost) {
+      break; // No collapse left.
+    }
+    threshold = std::min(maxCost, std::max(2.0 * threshold, nextCost));
+  }
+}
+
+/*!
+ * Returns a pool of threadCount threads, or throws std::invalid_argument if
+ * threadCount is 0.
+ */
+static std::unique_ptr<ThreadPool> createPool(std::size_t threadCount) {
+  if (threadCount == 0) {
+    throw std::invalid_argument("The thread count must be at least 1");
+  }
+  return std::make_unique<ThreadPool>(threadCount);
+}
+
+QuadricDecimation::QuadricDecimation(std::size_t threadCount)
+    : pool{createPool(threadCount)},
+      error{std::numeric_limits<double>::infinity()} {}
+
+QuadricDecimation::~QuadricDecimation() = default;
+
+std::size_t QuadricDecimation::threadCount() const {
+  return pool->threadCount();
+}
+
+void QuadricDecimation::setThreadCount(std::size_t threadCount) {
+  if (threadCount != pool->threadCount()) {
+    pool = createPool(threadCount);
+  }
+}
+
+IndexedMesh QuadricDecimation::decimate(const IndexedMesh &mesh) const {
+  return decimate(mesh, nullptr);
+}
+
+IndexedMesh QuadricDecimation::decimate(const IndexedMesh &mesh,
+                                        const CancellationToken &token) const {
+  return decimate(mesh, &token);
+}
+
+IndexedMesh QuadricDecimation::decimate(const IndexedMesh &mesh,
+                                        const CancellationToken *token) const {
+  assert(mesh.normals.empty() || mesh.normals.size() == mesh.vertices.size());
+  if (mesh.triangles.empty() || mesh.triangles.size() <= targetCount) {
+    return mesh;
+  }
+  // The copy of the mesh and the preparation of the slabs take a noticeable
+  // part of the time of a large mesh, so they check token too.
+  checkCancellation(token);
+  Decimation decimation{mesh, pool->threadCount()};
+  checkCancellation(token);
+  pool->run(decimation.slabCount(), [&](std::size_t iSlab) {
+    decimation.prepareSlab(iSlab, token);
+  });
+  if (decimation.slabCount() == 1) {
+    decimatePasses(decimation, *pool, targetCount, error, token);
+    return decimation.result();
+  }
+  // The slabs are first reduced to their share of the target, except the
+  // triangles of the seams between them, whose shared vertices are locked.
+  // The slabs are then merged, and the seams are decimated on one thread
+  // with the rest of the mesh, so that the result does not depend much on
+  // the number of slabs.
+  const auto triangleCount = mesh.triangles.size();
+  const auto seamCount = decimation.seamTriangleCount();
+  decimatePasses(decimation, *pool,
+                 targetCount + seamCount -
+                     seamCount * targetCount / triangleCount,
+                 error, token);
+  decimation.mergeSlabs(token);
+  decimatePasses(decimation, *pool, targetCount, error, token);
+  return decimation.result();
+}
+
+} // namespace marchingcubes
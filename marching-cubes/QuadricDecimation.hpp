@@ -0,0 +1,102 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include "marching-cubes/IndexedMesh.hpp"
+
+#include <cstddef>
+#include <memory>
+
+namespace marchingcubes {
+
+class CancellationToken;
+class ThreadPool;
+
+/*!
+ * \class QuadricDecimation
+ * \brief The QuadricDecimation class reduces the number of triangles of an
+ * IndexedMesh by collapsing its edges, the cheapest first, as measured by the
+ * quadric error metric of Garland and Heckbert.
+ *
+ * The quadric of a vertex sums the squared distances to the planes of its
+ * triangles. Collapsing an edge merges its 2 vertices into the point that
+ * minimizes the sum of their quadrics, so the many small coplanar triangles
+ * of an isosurface collapse at no cost, and the curved parts are kept. A
+ * collapse is rejected when it would flip a triangle or make the mesh
+ * non-manifold.
+ *
+ * When the thread count is greater than 1, the mesh is split into as many
+ * slabs along the longest axis of its bounding box, which are decimated in
+ * parallel. The vertices shared by several slabs are locked, like the
+ * vertices on the boundary of the mesh, so that the slabs stay stitched
+ * together, and each slab is reduced in proportion to its triangles, except
+ * its triangles on the seams. The slabs are then merged, and a last pass on
+ * one thread decimates the seams with the rest of the mesh, so that the
+ * result hardly depends on the thread count.
+ *
+ * The decimation stops when the mesh has targetTriangleCount() triangles,
+ * or when the cheapest collapse would exceed maxError(). The normals of the
+ * mesh, if any, are averaged by the collapses.
+ */
+class QuadricDecimation {
+
+public:
+  explicit QuadricDecimation(std::size_t threadCount = 1);
+  ~QuadricDecimation();
+
+public:
+  /*!
+   * The number of threads of the calculations, at least 1: the constructor
+   * and setThreadCount throw std::invalid_argument for 0.
+   */
+  std::size_t threadCount() const;
+  void setThreadCount(std::size_t threadCount);
+
+  /*!
+   * The number of triangles at which the decimation stops, 0 by default: the
+   * decimation then only stops on maxError().
+   */
+  std::size_t targetTriangleCount() const { return targetCount; }
+  void setTargetTriangleCount(std::size_t triangleCount) {
+    targetCount = triangleCount;
+  }
+
+  /*!
+   * The maximal quadric error of a collapse, i.e. the sum of the squared
+   * distances from the merged vertex to the planes of the original triangles
+   * around it. It is infinite by default.
+   */
+  double maxError() const { return error; }
+  void setMaxError(double maxError) { error = maxError; }
+
+  /*!
+   * Returns the decimated mesh. Its triangles are the remaining triangles of
+   * mesh in the same order, and its vertices the remaining vertices in the
+   * same order.
+   */
+  IndexedMesh decimate(const IndexedMesh &mesh) const;
+
+  /*!
+   * Same as decimate(mesh), and throws IsoSurfaceCancelled once token is
+   * cancelled, e.g. when the isosurface being decimated is no longer needed.
+   */
+  IndexedMesh decimate(const IndexedMesh &mesh,
+                       const CancellationToken &token) const;
+
+private:
+  IndexedMesh decimate(const IndexedMesh &mesh,
+                       const CancellationToken *token) const;
+
+private:
+  std::unique_ptr<ThreadPool> pool;
+  std::size_t targetCount = 0;
+  double error;
+};
+
+} // namespace marchingcubes
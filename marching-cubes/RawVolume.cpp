@@ -0,0 +1,235 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/RawVolume.hpp"
+
+#include "marching-cubes/MappedFile.hpp"
+#include "marching-cubes/Tensor3D.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+namespace marchingcubes {
+
+constexpr char MAGIC[] = "MCVOLUME";
+constexpr std::size_t MAGIC_SIZE = sizeof(MAGIC) - 1;
+constexpr std::uint32_t VERSION = 1;
+
+// The offsets of the fields of the header.
+constexpr std::size_t VERSION_OFFSET = 8;
+constexpr std::size_t SCALAR_TYPE_OFFSET = 12;
+constexpr std::size_t BYTE_ORDER_OFFSET = 13;
+constexpr std::size_t SIZE_OFFSET = 16;
+
+using HeaderBytes = std::array<unsigned char, RawVolumeHeader::SIZE>;
+
+ByteOrder nativeByteOrder() {
+  const std::uint16_t one = 1;
+  unsigned char firstByte;
+  std::memcpy(&firstByte, &one, 1);
+  return firstByte == 1 ? ByteOrder::LittleEndian : ByteOrder::BigEndian;
+}
+
+static std::uint64_t readLittleEndian(const HeaderBytes &bytes,
+                                      std::size_t offset,
+                                      std::size_t byteCount) {
+  std::uint64_t value = 0;
+  for (std::size_t i = 0; i < byteCount; ++i) {
+    value |= std::uint64_t{bytes[offset + i]} << (8 * i);
+  }
+  return value;
+}
+
+static void writeLittleEndian(HeaderBytes &bytes, std::size_t offset,
+                              std::size_t byteCount, std::uint64_t value) {
+  for (std::size_t i = 0; i < byteCount; ++i) {
+    bytes[offset + i] = static_cast<unsigned char>(value >> (8 * i));
+  }
+}
+
+static std::system_error systemError(const std::string &what) {
+  return std::system_error(errno, std::generic_category(), what);
+}
+
+static std::size_t scalarSize(ScalarType scalarType) {
+  switch (scalarType) {
+  case ScalarType::Uint8:
+    return 1;
+  case ScalarType::Int16:
+  case ScalarType::Uint16:
+    return 2;
+  case ScalarType::Float:
+    return 4;
+  case ScalarType::Double:
+    return 8;
+  }
+  return 0;
+}
+
+static RawVolumeHeader readHeader(std::istream &stream,
+                                  const std::string &path) {
+  HeaderBytes bytes;
+  if (!stream.read(reinterpret_cast<char *>(bytes.data()), bytes.size())) {
+    throw std::runtime_error(path + " is too short for a raw volume");
+  }
+  if (std::memcmp(bytes.data(), MAGIC, MAGIC_SIZE) != 0) {
+    throw std::runtime_error(path + " is not a raw volume");
+  }
+  const auto version = readLittleEndian(bytes, VERSION_OFFSET, 4);
+  if (version != VERSION) {
+    throw std::runtime_error(path + ": unsupported raw volume version " +
+                             std::to_string(version));
+  }
+  RawVolumeHeader header;
+  header.scalarType = static_cast<ScalarType>(bytes[SCALAR_TYPE_OFFSET]);
+  if (scalarSize(header.scalarType) == 0) {
+    throw std::runtime_error(path + ": invalid scalar type " +
+                             std::to_string(bytes[SCALAR_TYPE_OFFSET]));
+  }
+  header.byteOrder = static_cast<ByteOrder>(bytes[BYTE_ORDER_OFFSET]);
+  if (header.byteOrder != ByteOrder::LittleEndian &&
+      header.byteOrder != ByteOrder::BigEndian) {
+    throw std::runtime_error(path + ": invalid byte order " +
+                             std::to_string(bytes[BYTE_ORDER_OFFSET]));
+  }
+  for (std::size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    header.size[iDim] = static_cast<std::size_t>(
+        readLittleEndian(bytes, SIZE_OFFSET + 8 * iDim, 8));
+    if (header.size[iDim] == 0) {
+      throw std::runtime_error(path + ": empty raw volume");
+    }
+  }
+  // The byte count of the values must not overflow.
+  auto maxCount = std::numeric_limits<std::size_t>::max() /
+                  scalarSize(header.scalarType) / header.size[X];
+  if (header.size[Y] > maxCount ||
+      header.size[Z] > maxCount / header.size[Y]) {
+    throw std::runtime_error(path + ": raw volume too large");
+  }
+  return header;
+}
+
+static std::ifstream openInput(const std::string &path) {
+  std::ifstream stream{path, std::ios::binary};
+  if (!stream) {
+    throw systemError("Cannot open " + path);
+  }
+  return stream;
+}
+
+RawVolumeHeader readRawVolumeHeader(const std::string &path) {
+  auto stream = openInput(path);
+  return readHeader(stream, path);
+}
+
+template <typename TValue> static void swapBytes(std::vector<TValue> &values) {
+  for (auto &value : values) {
+    auto *bytes = reinterpret_cast<unsigned char *>(&value);
+    std::reverse(bytes, bytes + sizeof(TValue));
+  }
+}
+
+template <typename TValue>
+BasicTensor3D<TValue> openRawVolume(const std::string &path) {
+  auto stream = openInput(path);
+  const auto header = readHeader(stream, path);
+  if (header.scalarType != scalarTypeOf<TValue>()) {
+    throw std::invalid_argument(
+        path + ": values of scalar type " +
+        std::to_string(static_cast<int>(header.scalarType)) + " instead of " +
+        std::to_string(static_cast<int>(scalarTypeOf<TValue>())));
+  }
+  const auto count = header.size[X] * header.size[Y] * header.size[Z];
+  const auto byteCount = count * sizeof(TValue);
+  if (header.byteOrder == nativeByteOrder()) {
+    stream.close();
+    auto file = std::make_shared<const MappedFile>(path);
+    if (file->size() < RawVolumeHeader::SIZE + byteCount) {
+      throw std::runtime_error(path + " is shorter than its values");
+    }
+    return BasicTensor3D<TValue>{header.size[X], header.size[Y],
+                                 header.size[Z], std::move(file),
+                                 RawVolumeHeader::SIZE};
+  }
+  std::vector<TValue> values(count);
+  if (!stream.read(reinterpret_cast<char *>(values.data()),
+                   static_cast<std::streamsize>(byteCount))) {
+    throw std::runtime_error(path + " is shorter than its values");
+  }
+  swapBytes(values);
+  return BasicTensor3D<TValue>{header.size[X], header.size[Y], header.size[Z],
+                               std::move(values)};
+}
+
+/*!
+ * The number of values that are swapped at once when a tensor is written in
+ * the other byte order.
+ */
+constexpr std::size_t WRITE_CHUNK_SIZE = 1 << 16;
+
+template <typename TValue>
+void writeRawVolume(const std::string &path,
+                    const BasicTensor3D<TValue> &tensor, ByteOrder byteOrder) {
+  std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+  if (!stream) {
+    throw systemError("Cannot create " + path);
+  }
+  HeaderBytes bytes{};
+  std::memcpy(bytes.data(), MAGIC, MAGIC_SIZE);
+  writeLittleEndian(bytes, VERSION_OFFSET, 4, VERSION);
+  bytes[SCALAR_TYPE_OFFSET] =
+      static_cast<unsigned char>(scalarTypeOf<TValue>());
+  bytes[BYTE_ORDER_OFFSET] = static_cast<unsigned char>(byteOrder);
+  for (std::size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    writeLittleEndian(bytes, SIZE_OFFSET + 8 * iDim, 8, tensor.size(iDim));
+  }
+  stream.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+  const auto values = tensor.allValues();
+  if (byteOrder == nativeByteOrder()) {
+    stream.write(reinterpret_cast<const char *>(values.data()),
+                 static_cast<std::streamsize>(values.size() * sizeof(TValue)));
+  } else {
+    std::vector<TValue> chunk;
+    for (std::size_t begin = 0; begin < values.size();
+         begin += WRITE_CHUNK_SIZE) {
+      const auto end = std::min(values.size(), begin + WRITE_CHUNK_SIZE);
+      chunk.assign(values.begin() + begin, values.begin() + end);
+      swapBytes(chunk);
+      stream.write(reinterpret_cast<const char *>(chunk.data()),
+                   static_cast<std::streamsize>(chunk.size() * sizeof(TValue)));
+    }
+  }
+  if (!stream.flush()) {
+    throw systemError("Cannot write " + path);
+  }
+}
+
+template BasicTensor3D<double> openRawVolume(const std::string &);
+template BasicTensor3D<float> openRawVolume(const std::string &);
+template BasicTensor3D<std::uint8_t> openRawVolume(const std::string &);
+template BasicTensor3D<std::int16_t> openRawVolume(const std::string &);
+template BasicTensor3D<std::uint16_t> openRawVolume(const std::string &);
+
+template void writeRawVolume(const std::string &, const Tensor3D &, ByteOrder);
+template void writeRawVolume(const std::string &, const Tensor3DFloat &,
+                             ByteOrder);
+template void writeRawVolume(const std::string &, const Tensor3DUint8 &,
+                             ByteOrder);
+template void writeRawVolume(const std::string &, const Tensor3DInt16 &,
+                             ByteOrder);
+template void writeRawVolume(const std::string &, const Tensor3DUint16 &,
+                             ByteOrder);
+
+} // namespace marchingcubes
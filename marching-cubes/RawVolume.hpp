@@ -0,0 +1,111 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include "marching-cubes/Geometry3D.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace marchingcubes {
+
+template <typename TValue> class BasicTensor3D;
+
+/*!
+ * \enum ScalarType
+ * \brief The ScalarType enum lists the value types of BasicTensor3D.
+ */
+enum class ScalarType : std::uint8_t { Uint8, Int16, Uint16, Float, Double };
+
+/*!
+ * Returns the ScalarType of TValue.
+ */
+template <typename TValue> constexpr ScalarType scalarTypeOf() {
+  if constexpr (std::is_same_v<TValue, std::uint8_t>) {
+    return ScalarType::Uint8;
+  } else if constexpr (std::is_same_v<TValue, std::int16_t>) {
+    return ScalarType::Int16;
+  } else if constexpr (std::is_same_v<TValue, std::uint16_t>) {
+    return ScalarType::Uint16;
+  } else if constexpr (std::is_same_v<TValue, float>) {
+    return ScalarType::Float;
+  } else {
+    static_assert(std::is_same_v<TValue, double>, "Unsupported value type");
+    return ScalarType::Double;
+  }
+}
+
+/*!
+ * \enum ByteOrder
+ * \brief The ByteOrder enum defines the order of the bytes of the values of a
+ * raw volume file.
+ */
+enum class ByteOrder : std::uint8_t { LittleEndian, BigEndian };
+
+/*!
+ * Returns the byte order of the values in memory.
+ */
+ByteOrder nativeByteOrder();
+
+/*!
+ * \class RawVolumeHeader
+ * \brief The class RawVolumeHeader describes the values of a raw volume file.
+ *
+ * A raw volume file starts with a header of RawVolumeHeader::SIZE bytes:
+ * - the magic "MCVOLUME" (8 bytes),
+ * - the format version (4 bytes), currently 1,
+ * - the ScalarType of the values (1 byte),
+ * - the ByteOrder of the values (1 byte),
+ * - 2 bytes set to 0,
+ * - the sizes of the tensor along X, Y and Z (3 x 8 bytes),
+ * - 24 bytes set to 0.
+ * The integers of the header are little-endian. The header is followed by
+ * the values, in the order of BasicTensor3D: X first, then Y, then Z.
+ */
+struct RawVolumeHeader {
+  static constexpr std::size_t SIZE = 64;
+
+  std::array<std::size_t, DIM_COUNT> size;
+  ScalarType scalarType;
+  ByteOrder byteOrder;
+};
+
+/*!
+ * Reads the header of the raw volume file at path. Throws std::system_error
+ * if the file cannot be read, and std::runtime_error if it is not a raw
+ * volume file.
+ */
+RawVolumeHeader readRawVolumeHeader(const std::string &path);
+
+/*!
+ * Opens the raw volume file at path as a tensor. When the values are stored
+ * in the native byte order, the file is mapped in memory and the tensor reads
+ * them in place: the file opens without reading it, its pages are loaded as
+ * the tensor is traversed, and they are shared with the other processes that
+ * open it. Otherwise, the values are read and their bytes are swapped.
+ *
+ * Throws std::invalid_argument if the values of the file are not of type
+ * TValue, and the exceptions of readRawVolumeHeader. The file is also
+ * rejected if it is shorter than the values of its header.
+ */
+template <typename TValue>
+BasicTensor3D<TValue> openRawVolume(const std::string &path);
+
+/*!
+ * Writes tensor to a raw volume file at path, with its values in the given
+ * byte order. Throws std::system_error if the file cannot be written.
+ */
+template <typename TValue>
+void writeRawVolume(const std::string &path,
+                    const BasicTensor3D<TValue> &tensor,
+                    ByteOrder byteOrder = nativeByteOrder());
+
+} // namespace marchingcubes
@@ -0,0 +1,202 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/SignBits.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace marchingcubes {
+
+/*!
+ * \fn lowBits
+ * \brief Returns a SignWord whose count lowest bits are set.
+ */
+static SignWord lowBits(std::size_t count) {
+  return count == SIGN_WORD_BITS ? ~SignWord{0}
+                                 : (SignWord{1} << count) - 1;
+}
+
+/*!
+ * \fn scalarSignBits
+ * \brief Sets the bits [first, count) of result for the values not less than
+ * threshold. The comparison "not less than" is true for NaN values, like the
+ * comparison `value - isoValue < 0.0 ? 0 : 1` used by the configurations.
+ */
+template <typename TValue>
+static SignWord scalarSignBits(const TValue *values, std::size_t first,
+                               std::size_t count, TValue threshold,
+                               SignWord result) {
+  for (auto i = first; i < count; ++i) {
+    result |= static_cast<SignWord>(!(values[i] < threshold)) << i;
+  }
+  return result;
+}
+
+static SignWord nativeSignBits(const double *values, std::size_t count,
+                               double threshold) {
+  SignWord result = 0;
+  std::size_t i = 0;
+#if defined(__AVX__)
+  const auto thresholds = _mm256_set1_pd(threshold);
+  for (; i + 4 <= count; i += 4) {
+    auto signs =
+        _mm256_cmp_pd(_mm256_loadu_pd(values + i), thresholds, _CMP_NLT_UQ);
+    result |= static_cast<SignWord>(_mm256_movemask_pd(signs)) << i;
+  }
+#elif defined(__SSE2__)
+  const auto thresholds = _mm_set1_pd(threshold);
+  for (; i + 2 <= count; i += 2) {
+    auto signs = _mm_cmpnlt_pd(_mm_loadu_pd(values + i), thresholds);
+    result |= static_cast<SignWord>(_mm_movemask_pd(signs)) << i;
+  }
+#endif
+  return scalarSignBits(values, i, count, threshold, result);
+}
+
+static SignWord nativeSignBits(const float *values, std::size_t count,
+                               float threshold) {
+  SignWord result = 0;
+  std::size_t i = 0;
+#if defined(__AVX__)
+  const auto thresholds = _mm256_set1_ps(threshold);
+  for (; i + 8 <= count; i += 8) {
+    auto signs =
+        _mm256_cmp_ps(_mm256_loadu_ps(values + i), thresholds, _CMP_NLT_UQ);
+    result |= static_cast<SignWord>(_mm256_movemask_ps(signs)) << i;
+  }
+#elif defined(__SSE2__)
+  const auto thresholds = _mm_set1_ps(threshold);
+  for (; i + 4 <= count; i += 4) {
+    auto signs = _mm_cmpnlt_ps(_mm_loadu_ps(values + i), thresholds);
+    result |= static_cast<SignWord>(_mm_movemask_ps(signs)) << i;
+  }
+#endif
+  return scalarSignBits(values, i, count, threshold, result);
+}
+
+// SSE2 only compares signed integers: the unsigned values are shifted to the
+// signed range by flipping their most significant bit.
+
+static SignWord nativeSignBits(const std::uint8_t *values, std::size_t count,
+                               std::uint8_t threshold) {
+  SignWord result = 0;
+  std::size_t i = 0;
+#if defined(__SSE2__)
+  const auto signBit = _mm_set1_epi8(static_cast<char>(0x80));
+  const auto thresholds =
+      _mm_xor_si128(_mm_set1_epi8(static_cast<char>(threshold)), signBit);
+  for (; i + 16 <= count; i += 16) {
+    auto shiftedValues = _mm_xor_si128(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i)),
+        signBit);
+    auto lessThan = _mm_cmplt_epi8(shiftedValues, thresholds);
+    result |= static_cast<SignWord>(~_mm_movemask_epi8(lessThan) & 0xFFFF)
+              << i;
+  }
+#endif
+  return scalarSignBits(values, i, count, threshold, result);
+}
+
+#if defined(__SSE2__)
+/*!
+ * \fn lessThanMask16
+ * \brief Returns the 8 bits "value < threshold" of 8 signed 16-bit integers.
+ */
+static unsigned lessThanMask16(__m128i values, __m128i thresholds) {
+  auto lessThan = _mm_cmplt_epi16(values, thresholds);
+  return static_cast<unsigned>(
+      _mm_movemask_epi8(_mm_packs_epi16(lessThan, _mm_setzero_si128())));
+}
+#endif
+
+static SignWord nativeSignBits(const std::int16_t *values, std::size_t count,
+                               std::int16_t threshold) {
+  SignWord result = 0;
+  std::size_t i = 0;
+#if defined(__SSE2__)
+  const auto thresholds = _mm_set1_epi16(threshold);
+  for (; i + 8 <= count; i += 8) {
+    auto lessThan = lessThanMask16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i)),
+        thresholds);
+    result |= static_cast<SignWord>(~lessThan & 0xFF) << i;
+  }
+#endif
+  return scalarSignBits(values, i, count, threshold, result);
+}
+
+static SignWord nativeSignBits(const std::uint16_t *values, std::size_t count,
+                               std::uint16_t threshold) {
+  SignWord result = 0;
+  std::size_t i = 0;
+#if defined(__SSE2__)
+  const auto signBit = _mm_set1_epi16(static_cast<short>(0x8000));
+  const auto thresholds =
+      _mm_xor_si128(_mm_set1_epi16(static_cast<short>(threshold)), signBit);
+  for (; i + 8 <= count; i += 8) {
+    auto lessThan = lessThanMask16(
+        _mm_xor_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i)),
+            signBit),
+        thresholds);
+    result |= static_cast<SignWord>(~lessThan & 0xFF) << i;
+  }
+#endif
+  return scalarSignBits(values, i, count, threshold, result);
+}
+
+template <typename TValue>
+SignWord signBits(const TValue *values, std::size_t count, double isoValue) {
+  assert(count <= SIGN_WORD_BITS);
+  if constexpr (std::is_same_v<TValue, double>) {
+    return nativeSignBits(values, count, isoValue);
+  } else if constexpr (std::is_floating_point_v<TValue>) {
+    using Limits = std::numeric_limits<TValue>;
+    if (std::isnan(isoValue) || isoValue == -Limits::infinity()) {
+      return lowBits(count);
+    }
+    // The smallest TValue not less than isoValue.
+    TValue threshold;
+    if (isoValue > Limits::max()) {
+      threshold = Limits::infinity();
+    } else if (isoValue < Limits::lowest()) {
+      threshold = Limits::lowest();
+    } else {
+      threshold = static_cast<TValue>(isoValue);
+      if (static_cast<double>(threshold) < isoValue) {
+        threshold = std::nextafter(threshold, Limits::infinity());
+      }
+    }
+    return nativeSignBits(values, count, threshold);
+  } else {
+    using Limits = std::numeric_limits<TValue>;
+    if (std::isnan(isoValue) || isoValue <= Limits::lowest()) {
+      return lowBits(count);
+    }
+    if (isoValue > Limits::max()) {
+      return 0;
+    }
+    return nativeSignBits(values, count,
+                          static_cast<TValue>(std::ceil(isoValue)));
+  }
+}
+
+template SignWord signBits(const double *, std::size_t, double);
+template SignWord signBits(const float *, std::size_t, double);
+template SignWord signBits(const std::uint8_t *, std::size_t, double);
+template SignWord signBits(const std::int16_t *, std::size_t, double);
+template SignWord signBits(const std::uint16_t *, std::size_t, double);
+
+} // namespace marchingcubes
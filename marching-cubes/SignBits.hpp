@@ -0,0 +1,53 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace marchingcubes {
+
+/*!
+ * \class SignWord
+ * \brief The alias SignWord packs the signs of f(V_i)-isovalue of up to
+ * SIGN_WORD_BITS consecutive values of a tensor row: bit i is set when the
+ * value i is not less than the isovalue, as in cube::Configuration.
+ */
+using SignWord = std::uint64_t;
+
+constexpr std::size_t SIGN_WORD_BITS = 64;
+
+/*!
+ * Returns the number of SignWord required to store the signs of a row of
+ * valueCount values.
+ */
+constexpr std::size_t signWordCount(std::size_t valueCount) {
+  return (valueCount + SIGN_WORD_BITS - 1) / SIGN_WORD_BITS;
+}
+
+/*!
+ * Returns the SignWord of the count first values, with count <=
+ * SIGN_WORD_BITS. TValue is one of the value types of BasicTensor3D.
+ *
+ * The values are compared in their native type: isoValue is first converted
+ * to the smallest TValue threshold t such that `value - isoValue >= 0` if and
+ * only if `value >= t`. The comparisons are vectorized with AVX or SSE2 when
+ * the target supports them.
+ */
+template <typename TValue>
+SignWord signBits(const TValue *values, std::size_t count, double isoValue);
+
+/*!
+ * Returns the index of the lowest bit set in word, which must not be 0.
+ */
+inline std::size_t lowestBitIndex(SignWord word) {
+  return static_cast<std::size_t>(__builtin_ctzll(word));
+}
+
+} // namespace marchingcubes
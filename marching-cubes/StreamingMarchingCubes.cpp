@@ -0,0 +1,135 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/StreamingMarchingCubes.hpp"
+
+#include "marching-cubes/internal/CubeTraversal.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace marchingcubes {
+
+using namespace internal;
+
+/*!
+ * \class SliceRows
+ * \brief The class SliceRows gives access to the X rows of two consecutive
+ * slices, as if they were the Z indices 0 and 1 of a tensor.
+ */
+template <typename TValue> class SliceRows {
+
+public:
+  using Value = TValue;
+
+public:
+  SliceRows(size_t xSize, size_t ySize,
+            const std::array<std::vector<TValue>, 2> &slices)
+      : xSize{xSize}, ySize{ySize}, slices{slices} {}
+
+public:
+  size_t size(size_t dimIndex) const {
+    return dimIndex == X ? xSize : dimIndex == Y ? ySize : slices.size();
+  }
+  const TValue *row(size_t y, size_t z) const {
+    return slices[z].data() + y * xSize;
+  }
+  const MinMaxHierarchy *minMaxHierarchy() const { return nullptr; }
+
+private:
+  const size_t xSize;
+  const size_t ySize;
+  const std::array<std::vector<TValue>, 2> &slices;
+};
+
+/*!
+ * \class SliceCoordinates
+ * \brief The class SliceCoordinates gives the coordinates of the points of
+ * two consecutive slices, like GridCoordinates.
+ */
+class SliceCoordinates {
+
+public:
+  SliceCoordinates(const std::array<std::vector<double>, 2> &grid,
+                   const std::array<double, 2> &sliceZ)
+      : grid{grid}, sliceZ{sliceZ} {}
+
+public:
+  double coordinate(size_t dimIndex, size_t index) const {
+    return dimIndex == Z ? sliceZ[index] : grid[dimIndex][index];
+  }
+
+private:
+  const std::array<std::vector<double>, 2> &grid;
+  const std::array<double, 2> &sliceZ;
+};
+
+template <typename TValue>
+StreamingMarchingCubes<TValue>::StreamingMarchingCubes(std::vector<double> x,
+                                                       std::vector<double> y,
+                                                       double isoValue,
+                                                       TriangleSink &sink)
+    : grid{{std::move(x), std::move(y)}}, mIsoValue{isoValue}, sink{sink} {
+  assert(size(X) > 1);
+  assert(size(Y) > 1);
+  batch.reserve(TRIANGLE_SINK_BATCH_SIZE);
+}
+
+template <typename TValue>
+void StreamingMarchingCubes<TValue>::pushSlice(double z,
+                                               std::vector<TValue> slice) {
+  if (slice.size() != size(X) * size(Y)) {
+    throw std::invalid_argument(
+        "Slice of " + std::to_string(slice.size()) + " values instead of " +
+        std::to_string(size(X) * size(Y)));
+  }
+  if (mSliceCount > 0 && !(sliceZ[1] < z)) {
+    throw std::invalid_argument("Slice at z = " + std::to_string(z) +
+                                " after the slice at z = " +
+                                std::to_string(sliceZ[1]));
+  }
+  slices[0] = std::move(slices[1]);
+  slices[1] = std::move(slice);
+  sliceZ[0] = sliceZ[1];
+  sliceZ[1] = z;
+  ++mSliceCount;
+  if (mSliceCount < 2) {
+    return;
+  }
+
+  const SliceCoordinates coordinates{grid, sliceZ};
+  batch.clear();
+  auto emitBatch = [this] {
+    sink.emitBatch(batch.data(), batch.size());
+    batch.clear();
+  };
+  forEachCube(SliceRows<TValue>{size(X), size(Y), slices}, mIsoValue, 1, 2,
+              [&](size_t iX, size_t iY, size_t iZ, uint8_t configIndex,
+                  const std::array<double, VERTEX_COUNT> &cubeValues) {
+                emitCubeTriangles(configIndex, coordinates, iX, iY, iZ,
+                                  cubeValues,
+                                  [&](const Triangle3D &triangle3D) {
+                                    batch.push_back(triangle3D);
+                                    if (batch.size() ==
+                                        TRIANGLE_SINK_BATCH_SIZE) {
+                                      emitBatch();
+                                    }
+                                  });
+              });
+  if (!batch.empty()) {
+    emitBatch();
+  }
+}
+
+template class StreamingMarchingCubes<double>;
+template class StreamingMarchingCubes<float>;
+template class StreamingMarchingCubes<std::uint8_t>;
+template class StreamingMarchingCubes<std::int16_t>;
+template class StreamingMarchingCubes<std::uint16_t>;
+
+} // namespace marchingcubes
@@ -0,0 +1,67 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include "marching-cubes/Geometry3D.hpp"
+#include "marching-cubes/IndexedMesh.hpp"
+#include "marching-cubes/TriangleSink.hpp"
+
+#include <vector>
+
+namespace marchingcubes {
+
+/*!
+ * \class StreamingMarchingCubes
+ * \brief The class StreamingMarchingCubes calculates an isosurface from Z
+ * slices that are pushed one at a time, so that volumes that do not fit in
+ * memory can be processed.
+ *
+ * A slice contains the size(X) * size(Y) values of one Z index, in X then Y
+ * order, like the values of a BasicTensor3D. Only the last two slices are
+ * kept: once a slice is pushed, the triangles of the slab of cubes between
+ * it and the previous slice are passed to the TriangleSink in batches, in the
+ * same order as MarchingCubes::isoSurface would return them. The sink is not
+ * called for a slab without triangle.
+ *
+ * TValue is one of the value types of BasicTensor3D.
+ */
+template <typename TValue> class StreamingMarchingCubes {
+
+public:
+  /*!
+   * Creates an extractor for slices on the grid x * y. x and y must contain at
+   * least 2 increasing values. sink must outlive the extractor.
+   */
+  StreamingMarchingCubes(std::vector<double> x, std::vector<double> y,
+                         double isoValue, TriangleSink &sink);
+
+public:
+  /*!
+   * Pushes the slice of values at the Z coordinate z, and emits the triangles
+   * of the slab it completes. Throws std::invalid_argument if the slice does
+   * not contain size(X) * size(Y) values, or if z is not greater than the Z
+   * coordinate of the previous slice.
+   */
+  void pushSlice(double z, std::vector<TValue> slice);
+
+  size_t size(size_t dimIndex) const { return grid.at(dimIndex).size(); }
+  double isoValue() const { return mIsoValue; }
+  size_t sliceCount() const { return mSliceCount; }
+
+private:
+  const std::array<std::vector<double>, 2> grid;
+  const double mIsoValue;
+  TriangleSink &sink;
+  size_t mSliceCount = 0;
+  std::array<double, 2> sliceZ{};
+  std::array<std::vector<TValue>, 2> slices;
+  std::vector<Triangle3D> batch;
+};
+
+} // namespace marchingcubes
@@ -8,6 +8,12 @@
 
 #include "marching-cubes/Tensor3D.hpp"
 
+#include "marching-cubes/MappedFile.hpp"
+#include "marching-cubes/ThreadPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+
 namespace marchingcubes {
 
 std::vector<double> equidistantPoints(double min, double max, size_t count) {
@@ -21,6 +27,39 @@ std::vector<double> equidistantPoints(double min, double max, size_t count) {
   return vec;
 }
 
+/*!
+ * The relative difference, in spacings, under which the values of an axis
+ * are considered equidistant.
+ */
+constexpr double UNIFORM_TOLERANCE = 1e-9;
+
+/*!
+ * \fn detectUniformGrid
+ * \brief Returns the UniformGrid3D of the given axis values, or nothing if
+ * the values of an axis are not equidistant.
+ */
+static std::optional<UniformGrid3D>
+detectUniformGrid(const std::array<std::vector<double>, DIM_COUNT> &values) {
+  UniformGrid3D uniformGrid{};
+  for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    const auto &vals = values[iDim];
+    uniformGrid.origin[iDim] = vals.front();
+    if (vals.size() < 2) {
+      continue;
+    }
+    const auto spacing =
+        (vals.back() - vals.front()) / static_cast<double>(vals.size() - 1);
+    uniformGrid.spacing[iDim] = spacing;
+    for (size_t i = 1; i < vals.size() - 1; ++i) {
+      if (std::abs(vals[i] - uniformGrid.coordinate(iDim, i)) >
+          UNIFORM_TOLERANCE * spacing) {
+        return std::nullopt;
+      }
+    }
+  }
+  return uniformGrid;
+}
+
 Grid3D::Grid3D(std::vector<double> x, std::vector<double> y,
                std::vector<double> z)
     : values{{std::move(x), std::move(y), std::move(z)}} {
@@ -31,6 +70,53 @@ Grid3D::Grid3D(std::vector<double> x, std::vector<double> y,
       assert(vals.at(i) < vals.at(i + 1));
     }
   }
+  uniform = detectUniformGrid(values);
+}
+
+static std::vector<double> uniformValues(const UniformGrid3D &uniformGrid,
+                                         size_t dimIndex, size_t size) {
+  std::vector<double> vals(size);
+  for (size_t i = 0; i < size; ++i) {
+    vals[i] = uniformGrid.coordinate(dimIndex, i);
+  }
+  return vals;
+}
+
+Grid3D::Grid3D(const UniformGrid3D &uniformGrid, size_t xSize, size_t ySize,
+               size_t zSize)
+    : values{{uniformValues(uniformGrid, X, xSize),
+              uniformValues(uniformGrid, Y, ySize),
+              uniformValues(uniformGrid, Z, zSize)}},
+      uniform{uniformGrid} {
+  for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    assert(values[iDim].size() > 0);
+    assert(values[iDim].size() == 1 || uniformGrid.spacing[iDim] > 0.0);
+  }
+}
+
+std::vector<size_t> pyramidIndices(size_t size, size_t level) {
+  assert(size > 0);
+  const size_t step = size_t{1} << level;
+  std::vector<size_t> indices;
+  indices.reserve((size - 1) / step + 2);
+  for (size_t i = 0; i < size; i += step) {
+    indices.push_back(i);
+  }
+  if (indices.back() != size - 1) {
+    indices.push_back(size - 1);
+  }
+  return indices;
+}
+
+Grid3D pyramidGrid(const Grid3D &grid, size_t level) {
+  std::array<std::vector<double>, DIM_COUNT> values;
+  for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+    for (auto i : pyramidIndices(grid.values[iDim].size(), level)) {
+      values[iDim].push_back(grid.values[iDim][i]);
+    }
+  }
+  return Grid3D{std::move(values[X]), std::move(values[Y]),
+                std::move(values[Z])};
 }
 
 Tensor3DIndexer::Tensor3DIndexer(size_t xSize, size_t ySize, size_t zSize)
@@ -40,17 +126,94 @@ Tensor3DIndexer::Tensor3DIndexer(size_t xSize, size_t ySize, size_t zSize)
   assert(size[Z] > 0);
 }
 
-Tensor3D::Tensor3D(size_t xSize, size_t ySize, size_t zSize,
-                   std::vector<double> values)
-    : indexer{xSize, ySize, zSize}, values{std::move(values)} {
+template <typename TValue>
+BasicTensor3D<TValue>::BasicTensor3D(size_t xSize, size_t ySize, size_t zSize,
+                                     std::vector<TValue> values)
+    : indexer{xSize, ySize, zSize}, values{std::move(values)},
+      valueData{this->values.data()} {
   assert(size(X) * size(Y) * size(Z) == this->values.size());
 }
 
-std::pair<double, double> Tensor3D::minMax() const {
-  const auto minMaxIt = std::minmax_element(values.cbegin(), values.cend());
+template <typename TValue>
+BasicTensor3D<TValue>::BasicTensor3D(size_t xSize, size_t ySize, size_t zSize,
+                                     std::shared_ptr<const MappedFile> file,
+                                     size_t offset)
+    : indexer{xSize, ySize, zSize}, file{std::move(file)},
+      valueData{reinterpret_cast<const TValue *>(this->file->data() + offset)} {
+  assert(offset % alignof(TValue) == 0);
+  assert(offset + size(X) * size(Y) * size(Z) * sizeof(TValue) <=
+         this->file->size());
+}
+
+template <typename TValue>
+std::pair<TValue, TValue> BasicTensor3D<TValue>::minMax() const {
+  const auto values = allValues();
+  const auto minMaxIt = std::minmax_element(values.begin(), values.end());
   return std::make_pair(*minMaxIt.first, *minMaxIt.second);
 }
 
+template <typename TValue>
+void BasicTensor3D<TValue>::willNeed(size_t zBegin, size_t zEnd) const {
+  if (file == nullptr || zBegin >= zEnd) {
+    return;
+  }
+  const auto sliceBytes = size(X) * size(Y) * sizeof(TValue);
+  const auto offset = static_cast<size_t>(
+      reinterpret_cast<const std::byte *>(valueData) - file->data());
+  file->willNeed(offset + zBegin * sliceBytes, (zEnd - zBegin) * sliceBytes);
+}
+
+template <typename TValue>
+void BasicTensor3D<TValue>::buildMinMaxHierarchy(size_t brickSize) {
+  hierarchy = std::make_unique<MinMaxHierarchy>(*this, brickSize);
+}
+
+template <typename TValue>
+void BasicTensor3D<TValue>::buildPyramid(size_t levelCount,
+                                         size_t threadCount) {
+  pyramid.clear();
+  ThreadPool pool{threadCount};
+  for (size_t level = 1; level <= levelCount; ++level) {
+    std::array<std::vector<size_t>, DIM_COUNT> indices;
+    for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+      indices[iDim] = pyramidIndices(size(iDim), level);
+    }
+    const auto xCount = indices[X].size();
+    const auto yCount = indices[Y].size();
+    const auto zCount = indices[Z].size();
+    std::vector<TValue> levelValues(xCount * yCount * zCount);
+    // Each thread fills a slab of Z slices of the level.
+    const auto slabCount = std::min(pool.threadCount(), zCount);
+    pool.run(slabCount, [&](size_t iSlab) {
+      const auto zBegin = zCount * iSlab / slabCount;
+      const auto zEnd = zCount * (iSlab + 1) / slabCount;
+      auto *levelValue = levelValues.data() + zBegin * xCount * yCount;
+      for (size_t z = zBegin; z < zEnd; ++z) {
+        for (auto y : indices[Y]) {
+          for (auto x : indices[X]) {
+            *(levelValue++) = value(x, y, indices[Z][z]);
+          }
+        }
+      }
+    });
+    pyramid.push_back(std::make_unique<BasicTensor3D>(
+        xCount, yCount, zCount, std::move(levelValues)));
+  }
+}
+
+template <typename TValue>
+const BasicTensor3D<TValue> &
+BasicTensor3D<TValue>::pyramidLevel(size_t level) const {
+  assert(level < pyramidLevelCount());
+  return level == 0 ? *this : *pyramid[level - 1];
+}
+
+template class BasicTensor3D<double>;
+template class BasicTensor3D<float>;
+template class BasicTensor3D<std::uint8_t>;
+template class BasicTensor3D<std::int16_t>;
+template class BasicTensor3D<std::uint16_t>;
+
 Tensor3D createSphere(const Grid3D &grid) {
   auto xPointCount = grid.values[X].size();
   auto yPointCount = grid.values[Y].size();
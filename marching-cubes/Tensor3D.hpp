@@ -9,9 +9,14 @@
 #pragma once
 
 #include "marching-cubes/Geometry3D.hpp"
+#include "marching-cubes/MinMaxHierarchy.hpp"
 
 #include <array>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <vector>
 
 namespace marchingcubes {
@@ -27,20 +32,80 @@ namespace marchingcubes {
 extern std::vector<double> equidistantPoints(double min, double max,
                                              size_t count);
 
+/*!
+ * \class UniformGrid3D
+ * \brief The class UniformGrid3D defines a 3D grid whose points are
+ * equidistant along each axis: the coordinate of the index i along the axis
+ * dimIndex is origin[dimIndex] + i * spacing[dimIndex].
+ *
+ * The coordinates are calculated from the indices with one multiply-add, so
+ * the points of a cube are obtained without reading the coordinates of the
+ * grid.
+ */
+struct UniformGrid3D {
+  Point3D origin;
+  Point3D spacing;
+
+  double coordinate(size_t dimIndex, size_t index) const {
+    return origin[dimIndex] + spacing[dimIndex] * static_cast<double>(index);
+  }
+};
+
 /*!
  * \class Grid3D
  * \brief The class Grid3D defines a 3D grid as the cartesian product of
  * the axis x, y, and z: the points of the grid are all the possible
  * combinations of the provided x, y, and z values.
+ *
+ * When the values of each axis are equidistant, as the ones returned by
+ * equidistantPoints, uniformGrid() describes the grid as a UniformGrid3D, and
+ * MarchingCubes calculates the points of the isosurface from the indices of
+ * the cubes.
  */
 class Grid3D {
 public:
   Grid3D(std::vector<double> x, std::vector<double> y, std::vector<double> z);
+  Grid3D(const UniformGrid3D &uniformGrid, size_t xSize, size_t ySize,
+         size_t zSize);
 
 public:
   const std::array<std::vector<double>, DIM_COUNT> values;
+
+  /*!
+   * Returns the description of the grid as a UniformGrid3D, or nullptr when
+   * the values of an axis are not equidistant.
+   */
+  const UniformGrid3D *uniformGrid() const {
+    return uniform ? &*uniform : nullptr;
+  }
+
+private:
+  std::optional<UniformGrid3D> uniform;
 };
 
+/*!
+ * \fn pyramidIndices
+ * \brief The function pyramidIndices returns the indices, along an axis of
+ * size values, of the values kept by the level of a pyramid of tensors.
+ *
+ * The level keeps every 2^level-th value, and the last value, so that it
+ * covers the whole axis. For example, pyramidIndices(10, 1) returns {0, 2, 4,
+ * 6, 8, 9}. Level 0 keeps all the values.
+ */
+extern std::vector<size_t> pyramidIndices(size_t size, size_t level);
+
+/*!
+ * \fn pyramidGrid
+ * \brief The function pyramidGrid returns the points of grid that are kept
+ * by the level of a pyramid, see BasicTensor3D::buildPyramid.
+ *
+ * The values of a level are values of the tensor at these points, so the
+ * isosurface of the level on this grid lines up with the isosurface of the
+ * tensor on grid. The grid of a level of a uniform grid is uniform when
+ * size - 1 is a multiple of 2^level along each axis.
+ */
+extern Grid3D pyramidGrid(const Grid3D &grid, size_t level);
+
 /*!
  * \class Tensor3DIndexer
  * \brief The class Tensor3DIndexer is an utility class used by Tensor3D.
@@ -64,38 +129,219 @@ public:
 };
 
 /*!
- * \class Tensor3D
- * \brief The class Tensor3D stores values of a 3D tensor on a 3D grid.
+ * \class IndexBox
+ * \brief The class IndexBox defines the box of the indices
+ * [begin[X], end[X]) x [begin[Y], end[Y]) x [begin[Z], end[Z]) of a tensor,
+ * such as a region of interest.
+ */
+struct IndexBox {
+  std::array<size_t, DIM_COUNT> begin;
+  std::array<size_t, DIM_COUNT> end;
+
+  size_t size(size_t dimIndex) const {
+    return end.at(dimIndex) - begin.at(dimIndex);
+  }
+};
+
+class MappedFile;
+
+/*!
+ * \class ValueSpan
+ * \brief The class ValueSpan gives a read-only access to the values of a
+ * BasicTensor3D, wherever they are stored.
+ */
+template <typename TValue> class ValueSpan {
+
+public:
+  ValueSpan(const TValue *values, size_t count)
+      : values{values}, count{count} {}
+
+public:
+  const TValue *data() const { return values; }
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  const TValue &operator[](size_t index) const {
+    assert(index < count);
+    return values[index];
+  }
+  const TValue *begin() const { return values; }
+  const TValue *end() const { return values + count; }
+
+private:
+  const TValue *values;
+  size_t count;
+};
+
+/*!
+ * \class BasicTensor3D
+ * \brief The class BasicTensor3D stores values of a 3D tensor on a 3D grid.
  *
  * Although the values are stored in a vector of size xSize * ySize * zSize,
  * the values are accessed by passing x,y,z indices. The class Tensor3DIndexer
  * takes care of converting these x,y,z indices into the corresponding vector
  * index `i`.
+ *
+ * The values are stored with their native type TValue, which is one of
+ * std::uint8_t, std::int16_t, std::uint16_t, float or double: a CT series of
+ * 16-bit integers takes 4 times less memory than the same values stored as
+ * double. Tensor3D is the tensor of double values.
+ *
+ * A MinMaxHierarchy can be built once for the tensor: MarchingCubes then uses
+ * it to skip the bricks of cubes that do not intersect the isosurface.
+ *
+ * The values are either owned by the tensor, or read in place from a
+ * MappedFile, see openRawVolume: the tensor is then a read-only view over the
+ * pages of the file, which are loaded as they are read.
  */
-class Tensor3D {
+template <typename TValue> class BasicTensor3D {
+
+public:
+  using Value = TValue;
 
 public:
-  Tensor3D(size_t xSize, size_t ySize, size_t zSize,
-           std::vector<double> values);
-  Tensor3D(const Tensor3D &) = delete;
-  Tensor3D(Tensor3D &&) = default;
+  BasicTensor3D(size_t xSize, size_t ySize, size_t zSize,
+                std::vector<TValue> values);
+  /*!
+   * Builds a tensor over the values stored in file from the byte offset, in
+   * the native byte order. The values are not copied, and the tensor keeps
+   * the file mapped.
+   */
+  BasicTensor3D(size_t xSize, size_t ySize, size_t zSize,
+                std::shared_ptr<const MappedFile> file, size_t offset);
+  BasicTensor3D(const BasicTensor3D &) = delete;
+  BasicTensor3D(BasicTensor3D &&) = default;
 
 public:
   size_t size(size_t dimIndex) const { return indexer.size.at(dimIndex); }
+  IndexBox indexBox() const { return {{{0, 0, 0}}, indexer.size}; }
   inline size_t index(size_t x, size_t y, size_t z) const {
     return indexer.index(x, y, z);
   }
-  inline double value(size_t x, size_t y, size_t z) const {
-    return values[index(x, y, z)];
+  inline TValue value(size_t x, size_t y, size_t z) const {
+    return valueData[index(x, y, z)];
+  }
+  std::pair<TValue, TValue> minMax() const;
+  ValueSpan<TValue> allValues() const {
+    return {valueData, size(X) * size(Y) * size(Z)};
   }
-  std::pair<double, double> minMax() const;
-  const std::vector<double> &allValues() const { return values; }
+  bool isMapped() const { return file != nullptr; }
+
+  /*!
+   * Advises that the Z slices [zBegin, zEnd) will be read soon. When the
+   * values are mapped from a file, the kernel starts to load their pages in
+   * the background. It does nothing otherwise.
+   */
+  void willNeed(size_t zBegin, size_t zEnd) const;
+
+  void buildMinMaxHierarchy(size_t brickSize = 8);
+  const MinMaxHierarchy *minMaxHierarchy() const { return hierarchy.get(); }
+
+  /*!
+   * Builds levelCount downsampled levels of the tensor, with threadCount
+   * threads: the level l keeps the values at pyramidIndices(size(d), l)
+   * along each axis, i.e. 2^l times fewer values per axis. The values are
+   * picked, not averaged, so that the isosurface of a level on
+   * pyramidGrid(grid, l) is a coarse approximation of the isosurface of the
+   * tensor that goes through the same points of the coarse grid.
+   */
+  void buildPyramid(size_t levelCount = 3, size_t threadCount = 1);
+
+  /*!
+   * Returns the number of levels of the pyramid, including the tensor itself,
+   * which is the level 0.
+   */
+  size_t pyramidLevelCount() const { return 1 + pyramid.size(); }
+  const BasicTensor3D &pyramidLevel(size_t level) const;
 
 private:
   const Tensor3DIndexer indexer;
-  std::vector<double> values;
+  // The owned values, empty when the values are mapped from file.
+  std::vector<TValue> values;
+  std::shared_ptr<const MappedFile> file;
+  const TValue *valueData;
+  std::unique_ptr<const MinMaxHierarchy> hierarchy;
+  // The levels 1, 2... of the pyramid.
+  std::vector<std::unique_ptr<const BasicTensor3D>> pyramid;
+};
+
+using Tensor3D = BasicTensor3D<double>;
+using Tensor3DFloat = BasicTensor3D<float>;
+using Tensor3DUint8 = BasicTensor3D<std::uint8_t>;
+using Tensor3DInt16 = BasicTensor3D<std::int16_t>;
+using Tensor3DUint16 = BasicTensor3D<std::uint16_t>;
+
+/*!
+ * \class BasicTensor3DView
+ * \brief The class BasicTensor3DView gives a read-only access to values
+ * stored elsewhere, with any layout: the value (x, y, z) is
+ * data[x * stride(X) + y * stride(Y) + z * stride(Z)].
+ *
+ * The strides are counted in values, and may be negative to flip an axis.
+ * A buffer of another library, a padded buffer, or a buffer whose fastest
+ * axis is Z can thus be passed to MarchingCubes without copying it. The
+ * values must outlive the view.
+ */
+template <typename TValue> class BasicTensor3DView {
+
+public:
+  using Value = TValue;
+
+public:
+  BasicTensor3DView(const TValue *data,
+                    const std::array<size_t, DIM_COUNT> &size,
+                    const std::array<std::ptrdiff_t, DIM_COUNT> &strides)
+      : mData{data}, mSize{size}, mStrides{strides} {
+    assert(data != nullptr);
+    assert(size[X] > 0 && size[Y] > 0 && size[Z] > 0);
+  }
+  /*!
+   * Builds a view of the values of tensor.
+   */
+  explicit BasicTensor3DView(const BasicTensor3D<TValue> &tensor)
+      : BasicTensor3DView{
+            tensor.allValues().data(),
+            {{tensor.size(X), tensor.size(Y), tensor.size(Z)}},
+            {{1, static_cast<std::ptrdiff_t>(tensor.size(X)),
+              static_cast<std::ptrdiff_t>(tensor.size(X) * tensor.size(Y))}}} {
+  }
+
+public:
+  size_t size(size_t dimIndex) const { return mSize.at(dimIndex); }
+  std::ptrdiff_t stride(size_t dimIndex) const {
+    return mStrides.at(dimIndex);
+  }
+  IndexBox indexBox() const { return {{{0, 0, 0}}, mSize}; }
+  const TValue *data() const { return mData; }
+  const TValue *pointer(size_t x, size_t y, size_t z) const {
+    assert(x < mSize[X]);
+    assert(y < mSize[Y]);
+    assert(z < mSize[Z]);
+    return mData + static_cast<std::ptrdiff_t>(x) * mStrides[X] +
+           static_cast<std::ptrdiff_t>(y) * mStrides[Y] +
+           static_cast<std::ptrdiff_t>(z) * mStrides[Z];
+  }
+  TValue value(size_t x, size_t y, size_t z) const {
+    return *pointer(x, y, z);
+  }
+
+private:
+  const TValue *mData;
+  std::array<size_t, DIM_COUNT> mSize;
+  std::array<std::ptrdiff_t, DIM_COUNT> mStrides;
 };
 
+using Tensor3DView = BasicTensor3DView<double>;
+using Tensor3DViewFloat = BasicTensor3DView<float>;
+using Tensor3DViewUint8 = BasicTensor3DView<std::uint8_t>;
+using Tensor3DViewInt16 = BasicTensor3DView<std::int16_t>;
+using Tensor3DViewUint16 = BasicTensor3DView<std::uint16_t>;
+
+extern template class BasicTensor3D<double>;
+extern template class BasicTensor3D<float>;
+extern template class BasicTensor3D<std::uint8_t>;
+extern template class BasicTensor3D<std::int16_t>;
+extern template class BasicTensor3D<std::uint16_t>;
+
 extern Tensor3D createSphere(const Grid3D &grid);
 
 } // namespace marchingcubes
@@ -0,0 +1,149 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/ThreadPool.hpp"
+
+#include <cassert>
+
+namespace marchingcubes {
+
+ThreadPool::ThreadPool(std::size_t threadCount)
+    : deques{std::make_unique<TaskDeque[]>(threadCount)} {
+  assert(threadCount > 0);
+  workers.reserve(threadCount - 1);
+  for (std::size_t i = 1; i < threadCount; ++i) {
+    workers.emplace_back([this, i] { workerLoop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    stopping = true;
+  }
+  taskAvailable.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::run(std::size_t taskCount,
+                     const std::function<void(std::size_t)> &task) {
+  if (taskCount == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> runLock{runMutex};
+  if (workers.empty() || taskCount == 1) {
+    for (std::size_t i = 0; i < taskCount; ++i) {
+      task(i);
+    }
+    return;
+  }
+  for (std::size_t i = 0; i < threadCount(); ++i) {
+    std::lock_guard<std::mutex> dequeLock{deques[i].mutex};
+    deques[i].begin = i * taskCount / threadCount();
+    deques[i].end = (i + 1) * taskCount / threadCount();
+  }
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    currentTask = &task;
+    firstError = nullptr;
+    busyWorkers = workers.size();
+    ++generation;
+  }
+  taskAvailable.notify_all();
+  runTasksOf(0);
+  std::unique_lock<std::mutex> lock{mutex};
+  workersDone.wait(lock, [this] { return busyWorkers == 0; });
+  currentTask = nullptr;
+  if (firstError) {
+    std::rethrow_exception(firstError);
+  }
+}
+
+void ThreadPool::workerLoop(std::size_t threadIndex) {
+  std::size_t seenGeneration = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock{mutex};
+      taskAvailable.wait(lock, [&] {
+        return stopping || generation != seenGeneration;
+      });
+      if (stopping) {
+        return;
+      }
+      seenGeneration = generation;
+    }
+    runTasksOf(threadIndex);
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      --busyWorkers;
+    }
+    workersDone.notify_one();
+  }
+}
+
+void ThreadPool::runTasksOf(std::size_t threadIndex) {
+  std::size_t i;
+  while (popTask(threadIndex, i) || stealTasks(threadIndex, i)) {
+    try {
+      (*currentTask)(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock{mutex};
+      if (!firstError) {
+        firstError = std::current_exception();
+      }
+    }
+  }
+}
+
+/*!
+ * Pops the first task of the deque of the thread into task, and returns
+ * false when the deque is empty.
+ */
+bool ThreadPool::popTask(std::size_t threadIndex, std::size_t &task) {
+  auto &deque = deques[threadIndex];
+  std::lock_guard<std::mutex> lock{deque.mutex};
+  if (deque.begin == deque.end) {
+    return false;
+  }
+  task = deque.begin++;
+  return true;
+}
+
+/*!
+ * Moves the back half of the tasks of the first non-empty deque of the other
+ * threads to the deque of the thread, and pops its first task into task.
+ * Returns false when all the deques are empty: the remaining tasks are being
+ * executed.
+ */
+bool ThreadPool::stealTasks(std::size_t threadIndex, std::size_t &task) {
+  for (std::size_t offset = 1; offset < threadCount(); ++offset) {
+    auto &victim = deques[(threadIndex + offset) % threadCount()];
+    std::size_t begin;
+    std::size_t end;
+    {
+      std::lock_guard<std::mutex> lock{victim.mutex};
+      if (victim.begin == victim.end) {
+        continue;
+      }
+      end = victim.end;
+      begin = end - (end - victim.begin + 1) / 2;
+      victim.end = begin;
+    }
+    auto &deque = deques[threadIndex];
+    std::lock_guard<std::mutex> lock{deque.mutex};
+    task = begin;
+    deque.begin = begin + 1;
+    deque.end = end;
+    return true;
+  }
+  return false;
+}
+
+} // namespace marchingcubes
@@ -0,0 +1,88 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace marchingcubes {
+
+/*!
+ * \class ThreadPool
+ * \brief The ThreadPool class runs tasks on a fixed set of threads that are
+ * created once and reused by every call to run.
+ *
+ * The thread calling run also executes tasks: a pool of threadCount threads
+ * only starts threadCount - 1 workers.
+ *
+ * The tasks of a run are scheduled by work stealing: each thread starts with
+ * a contiguous range of tasks, which it executes from the front, and a thread
+ * whose range is empty steals the back half of the range of another thread.
+ * When the cost of the tasks is uneven, e.g. the blocks of a volume whose
+ * isosurface is concentrated in a few of them, the threads stay busy until
+ * the last tasks.
+ */
+class ThreadPool {
+
+public:
+  explicit ThreadPool(std::size_t threadCount);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+public:
+  std::size_t threadCount() const { return workers.size() + 1; }
+
+  /*!
+   * Calls task(i) for each i in [0, taskCount), and returns once all the
+   * calls are finished. The tasks of a thread are executed in increasing
+   * order. If some tasks throw, the first exception is rethrown.
+   */
+  void run(std::size_t taskCount,
+           const std::function<void(std::size_t)> &task);
+
+private:
+  void workerLoop(std::size_t threadIndex);
+  void runTasksOf(std::size_t threadIndex);
+  bool popTask(std::size_t threadIndex, std::size_t &task);
+  bool stealTasks(std::size_t threadIndex, std::size_t &task);
+
+private:
+  /*!
+   * \class TaskDeque
+   * \brief The TaskDeque class stores the tasks [begin, end) of a thread: the
+   * thread pops them from the front, and the other threads steal them from
+   * the back.
+   */
+  struct TaskDeque {
+    std::mutex mutex;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+  };
+
+private:
+  std::vector<std::thread> workers;
+  std::unique_ptr<TaskDeque[]> deques;
+  std::mutex runMutex;
+  std::mutex mutex;
+  std::condition_variable taskAvailable;
+  std::condition_variable workersDone;
+  const std::function<void(std::size_t)> *currentTask = nullptr;
+  std::size_t generation = 0;
+  std::size_t busyWorkers = 0;
+  bool stopping = false;
+  std::exception_ptr firstError;
+};
+
+} // namespace marchingcubes
@@ -0,0 +1,104 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include "marching-cubes/IndexedMesh.hpp"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace marchingcubes {
+
+/*!
+ * \class BasicTriangleSink
+ * \brief The class BasicTriangleSink receives the triangles of an isosurface
+ * in batches, as they are calculated, with coordinates of type TCoordinate.
+ *
+ * The batches are passed in the order of the triangles of
+ * MarchingCubes::isoSurface. The pointer of a batch is only valid during the
+ * call to emitBatch.
+ */
+template <typename TCoordinate> class BasicTriangleSink {
+
+public:
+  virtual ~BasicTriangleSink() = default;
+
+  virtual void emitBatch(const BasicTriangle3D<TCoordinate> *triangles,
+                         std::size_t count) = 0;
+};
+
+using TriangleSink = BasicTriangleSink<double>;
+using TriangleSinkFloat = BasicTriangleSink<float>;
+
+/*!
+ * The number of triangles collected by a calculation before it passes them to
+ * a TriangleSink, when it does not already hold them in a buffer.
+ */
+constexpr std::size_t TRIANGLE_SINK_BATCH_SIZE = 1024;
+
+namespace internal {
+
+template <typename TSink>
+using EmitBatchResult = decltype(std::declval<TSink &>().emitBatch(
+    std::declval<const Triangle3D *>(), std::declval<std::size_t>()));
+
+template <typename TSink, typename = void>
+struct HasEmitBatch : std::false_type {};
+
+template <typename TSink>
+struct HasEmitBatch<TSink, std::void_t<EmitBatchResult<TSink>>>
+    : std::true_type {};
+
+template <typename TSink>
+using EmitResult = decltype(std::declval<TSink &>().emit(
+    std::declval<const Triangle3D &>()));
+
+template <typename TSink, typename = void>
+struct HasEmit : std::false_type {};
+
+template <typename TSink>
+struct HasEmit<TSink, std::void_t<EmitResult<TSink>>> : std::true_type {};
+
+/*!
+ * True for the types that TriangleSinkAdapter can turn into a TriangleSink.
+ */
+template <typename TSink>
+constexpr bool IS_ADAPTABLE_SINK =
+    !std::is_base_of_v<TriangleSink, TSink> &&
+    (HasEmitBatch<TSink>::value || HasEmit<TSink>::value);
+
+} // namespace internal
+
+/*!
+ * \class TriangleSinkAdapter
+ * \brief The class TriangleSinkAdapter turns any object with a member
+ * emitBatch(const Triangle3D *, std::size_t) or emit(const Triangle3D &) into
+ * a TriangleSink. emitBatch is preferred when both exist.
+ */
+template <typename TSink> class TriangleSinkAdapter : public TriangleSink {
+
+public:
+  explicit TriangleSinkAdapter(TSink &sink) : sink{sink} {}
+
+  void emitBatch(const Triangle3D *triangles, std::size_t count) override {
+    if constexpr (internal::HasEmitBatch<TSink>::value) {
+      sink.emitBatch(triangles, count);
+    } else {
+      for (std::size_t i = 0; i < count; ++i) {
+        sink.emit(triangles[i]);
+      }
+    }
+  }
+
+private:
+  TSink &sink;
+};
+
+} // namespace marchingcubes
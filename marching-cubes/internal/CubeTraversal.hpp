@@ -0,0 +1,799 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include "marching-cubes/CaseTable.hpp"
+#include "marching-cubes/Cube.hpp"
+#include "marching-cubes/Geometry3D.hpp"
+#include "marching-cubes/IndexedMesh.hpp"
+#include "marching-cubes/MinMaxHierarchy.hpp"
+#include "marching-cubes/SignBits.hpp"
+#include "marching-cubes/Tensor3D.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+/*!
+ * The functions of this file implement the traversal of the cubes shared by
+ * the extractors of the library. They read the values through a TRows type,
+ * which provides:
+ * - the value type Value,
+ * - size(dimIndex), the number of values along each dimension,
+ * - row(y, z), the pointer to the first value of the X row (y, z),
+ * - minMaxHierarchy(), which may return nullptr.
+ */
+namespace marchingcubes::internal {
+
+constexpr auto VERTEX_COUNT = cube::VERTEX_COUNT;
+
+/*!
+ * \class TensorRows
+ * \brief The class TensorRows gives access to the X rows of a BasicTensor3D,
+ * or of the part of a BasicTensor3D in an IndexBox: the indices are then
+ * relative to the beginning of the box.
+ *
+ * The MinMaxHierarchy of the tensor is only given for the whole tensor, as
+ * its bricks are aligned on the indices of the tensor.
+ */
+template <typename TValue> class TensorRows {
+
+public:
+  using Value = TValue;
+
+public:
+  explicit TensorRows(const BasicTensor3D<TValue> &tensor)
+      : TensorRows{tensor, tensor.indexBox()} {}
+  TensorRows(const BasicTensor3D<TValue> &tensor, const IndexBox &box)
+      : tensor{tensor}, box{box} {}
+
+public:
+  size_t size(size_t dimIndex) const { return box.size(dimIndex); }
+  const TValue *row(size_t y, size_t z) const {
+    return tensor.allValues().data() +
+           tensor.index(box.begin[X], box.begin[Y] + y, box.begin[Z] + z);
+  }
+  const MinMaxHierarchy *minMaxHierarchy() const {
+    return box.begin == std::array<size_t, DIM_COUNT>{} &&
+                   box.end == tensor.indexBox().end
+               ? tensor.minMaxHierarchy()
+               : nullptr;
+  }
+
+private:
+  const BasicTensor3D<TValue> &tensor;
+  const IndexBox box;
+};
+
+/*!
+ * \class ViewRows
+ * \brief The class ViewRows gives access to the X rows of a
+ * BasicTensor3DView in an IndexBox, like TensorRows.
+ *
+ * When the values of a row are contiguous, the rows are read in place.
+ * Otherwise, the values are gathered one Z layer at a time into a cache of 4
+ * layers, indexed by z % 4: the 2 layers of a layer of cubes, and the layers
+ * of their neighbours read by CubeNormals, stay in the cache together, so
+ * each layer is gathered once. A ViewRows must therefore not be shared by
+ * several threads.
+ */
+template <typename TValue> class ViewRows {
+
+public:
+  using Value = TValue;
+
+public:
+  ViewRows(const BasicTensor3DView<TValue> &view, const IndexBox &box)
+      : view{view}, box{box} {
+    if (view.stride(X) != 1) {
+      gatheredLayers.resize(CACHED_LAYERS * box.size(Y) * box.size(X));
+      cachedLayers.fill(SIZE_MAX);
+    }
+  }
+
+public:
+  size_t size(size_t dimIndex) const { return box.size(dimIndex); }
+  const TValue *row(size_t y, size_t z) const {
+    if (view.stride(X) == 1) {
+      return view.pointer(box.begin[X], box.begin[Y] + y, box.begin[Z] + z);
+    }
+    const auto layer = z % CACHED_LAYERS;
+    if (cachedLayers[layer] != z) {
+      gatherLayer(z, layer);
+    }
+    return gatheredLayers.data() + (y + box.size(Y) * layer) * box.size(X);
+  }
+  const MinMaxHierarchy *minMaxHierarchy() const { return nullptr; }
+
+private:
+  static constexpr size_t CACHED_LAYERS = 4;
+
+  void gatherLayer(size_t z, size_t layer) const {
+    const auto xSize = box.size(X);
+    const auto ySize = box.size(Y);
+    auto *values = gatheredLayers.data() + layer * ySize * xSize;
+    const auto *first =
+        view.pointer(box.begin[X], box.begin[Y], box.begin[Z] + z);
+    const auto xStride = view.stride(X);
+    const auto yStride = view.stride(Y);
+    // The inner loop follows the smaller stride, to read the values in the
+    // order of memory as much as possible.
+    if (std::abs(yStride) < std::abs(xStride)) {
+      for (size_t x = 0; x < xSize; ++x) {
+        const auto *column = first + static_cast<std::ptrdiff_t>(x) * xStride;
+        for (size_t y = 0; y < ySize; ++y) {
+          values[x + xSize * y] =
+              column[static_cast<std::ptrdiff_t>(y) * yStride];
+        }
+      }
+    } else {
+      for (size_t y = 0; y < ySize; ++y) {
+        const auto *row = first + static_cast<std::ptrdiff_t>(y) * yStride;
+        for (size_t x = 0; x < xSize; ++x) {
+          values[x + xSize * y] = row[static_cast<std::ptrdiff_t>(x) * xStride];
+        }
+      }
+    }
+    cachedLayers[layer] = z;
+  }
+
+private:
+  const BasicTensor3DView<TValue> view;
+  const IndexBox box;
+  mutable std::vector<TValue> gatheredLayers;
+  // The Z index of the layer cached at each z % CACHED_LAYERS.
+  mutable std::array<size_t, CACHED_LAYERS> cachedLayers{};
+};
+
+/*!
+ * \class BrickRows
+ * \brief The class BrickRows gives access to the X rows of a brick of a
+ * BasicBrickedTensor3D: the values of the brick box, stored in rows of
+ * rowSize values and layers of rowSize rows.
+ */
+template <typename TValue> class BrickRows {
+
+public:
+  using Value = TValue;
+
+public:
+  BrickRows(const TValue *values, size_t rowSize, const IndexBox &box)
+      : values{values}, rowSize{rowSize}, box{box} {}
+
+public:
+  size_t size(size_t dimIndex) const { return box.size(dimIndex); }
+  const TValue *row(size_t y, size_t z) const {
+    return values + rowSize * (y + rowSize * z);
+  }
+  const MinMaxHierarchy *minMaxHierarchy() const { return nullptr; }
+
+private:
+  const TValue *values;
+  const size_t rowSize;
+  const IndexBox box;
+};
+
+/*!
+ * Returns the rows of tensor in box, as TensorRows or ViewRows.
+ */
+template <typename TValue>
+TensorRows<TValue> rowsOf(const BasicTensor3D<TValue> &tensor,
+                          const IndexBox &box) {
+  return {tensor, box};
+}
+
+template <typename TValue>
+ViewRows<TValue> rowsOf(const BasicTensor3DView<TValue> &view,
+                        const IndexBox &box) {
+  return {view, box};
+}
+
+/*!
+ * \fn offset
+ * \brief Returns the offset of the intersection of the isosurface along edge,
+ * calculated with the precision of TCoordinate.
+ */
+template <typename TCoordinate = double>
+TCoordinate offset(const std::array<double, VERTEX_COUNT> &valuesOnCube,
+                   cube::Edge edge) {
+  auto localOffset = [](double start, double end) {
+    assert(start != end); // May explode...
+    const auto localStart = static_cast<TCoordinate>(start);
+    return localStart / (localStart - static_cast<TCoordinate>(end));
+  };
+  using namespace cube;
+  switch (edge) {
+  case e01:
+    return localOffset(valuesOnCube[0], valuesOnCube[1]);
+  case e02:
+    return localOffset(valuesOnCube[0], valuesOnCube[2]);
+  case e04:
+    return localOffset(valuesOnCube[0], valuesOnCube[4]);
+  case e13:
+    return localOffset(valuesOnCube[1], valuesOnCube[3]);
+  case e15:
+    return localOffset(valuesOnCube[1], valuesOnCube[5]);
+  case e23:
+    return localOffset(valuesOnCube[2], valuesOnCube[3]);
+  case e26:
+    return localOffset(valuesOnCube[2], valuesOnCube[6]);
+  case e37:
+    return localOffset(valuesOnCube[3], valuesOnCube[7]);
+  case e45:
+    return localOffset(valuesOnCube[4], valuesOnCube[5]);
+  case e46:
+    return localOffset(valuesOnCube[4], valuesOnCube[6]);
+  case e57:
+    return localOffset(valuesOnCube[5], valuesOnCube[7]);
+  case e67:
+    return localOffset(valuesOnCube[6], valuesOnCube[7]);
+  }
+  assert(false);
+  return {};
+}
+
+/*!
+ * \class GridCoordinates
+ * \brief The class GridCoordinates reads the coordinates of the points of a
+ * Grid3D in its values.
+ *
+ * Like UniformGrid3D, which calculates them, it provides the coordinate of an
+ * index along an axis.
+ */
+class GridCoordinates {
+
+public:
+  explicit GridCoordinates(const Grid3D &grid,
+                           const std::array<size_t, DIM_COUNT> &begin = {})
+      : grid{grid}, begin{begin} {}
+
+public:
+  double coordinate(size_t dimIndex, size_t index) const {
+    return grid.values[dimIndex][begin[dimIndex] + index];
+  }
+
+private:
+  const Grid3D &grid;
+  // The indices of the point (0, 0, 0) in grid.
+  const std::array<size_t, DIM_COUNT> begin;
+};
+
+/*!
+ * \class OffsetCoordinates
+ * \brief The class OffsetCoordinates gives the coordinates of TCoordinates
+ * with indices relative to begin.
+ */
+template <typename TCoordinates> class OffsetCoordinates {
+
+public:
+  OffsetCoordinates(const TCoordinates &coordinates,
+                    const std::array<size_t, DIM_COUNT> &begin)
+      : coordinates{coordinates}, begin{begin} {}
+
+public:
+  double coordinate(size_t dimIndex, size_t index) const {
+    return coordinates.coordinate(dimIndex, begin[dimIndex] + index);
+  }
+
+private:
+  const TCoordinates &coordinates;
+  const std::array<size_t, DIM_COUNT> begin;
+};
+
+/*!
+ * \fn withBoxCoordinates
+ * \brief Calls function(coordinates) with the coordinates of the points of
+ * grid in box, whose indices are relative to the beginning of box: the
+ * UniformGrid3D of grid when it is uniform, a GridCoordinates otherwise.
+ *
+ * The coordinates of a point are the same as for the whole grid, whatever
+ * the box.
+ */
+template <typename TFunction>
+void withBoxCoordinates(const Grid3D &grid, const IndexBox &box,
+                        TFunction &&function) {
+  if (const auto *uniformGrid = grid.uniformGrid()) {
+    if (box.begin == std::array<size_t, DIM_COUNT>{}) {
+      function(*uniformGrid);
+    } else {
+      function(OffsetCoordinates<UniformGrid3D>{*uniformGrid, box.begin});
+    }
+  } else {
+    function(GridCoordinates{grid, box.begin});
+  }
+}
+
+/*!
+ * \class BasicCubePoints
+ * \brief The class BasicCubePoints calculates the points on the edges of the
+ * cube whose vertex 0 has the indices (x, y, z), with coordinates of type
+ * TCoordinate. CubePoints calculates them in double precision.
+ *
+ * The coordinates of the vertices of the cube are obtained once, when the
+ * BasicCubePoints is created, from coordinates: a GridCoordinates, which
+ * reads them, or a UniformGrid3D, which calculates them from the indices.
+ * The points only depend on the indices of the vertices, so the point on an
+ * edge shared by neighbouring cubes is the same for all of them.
+ */
+template <typename TCoordinate> class BasicCubePoints {
+
+public:
+  using Point = BasicPoint3D<TCoordinate>;
+
+public:
+  template <typename TCoordinates>
+  BasicCubePoints(const TCoordinates &coordinates, size_t x, size_t y,
+                  size_t z) {
+    const std::array<size_t, DIM_COUNT> indices{{x, y, z}};
+    for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+      min[iDim] =
+          static_cast<TCoordinate>(coordinates.coordinate(iDim, indices[iDim]));
+      max[iDim] = static_cast<TCoordinate>(
+          coordinates.coordinate(iDim, indices[iDim] + 1));
+    }
+  }
+
+public:
+  /*!
+   * Returns the point at the offset t along edge.
+   *
+   * The switch gives the axis and the start vertex of each edge as template
+   * arguments, so that each case is a single multiply-add.
+   */
+  Point edgePoint(cube::Edge edge, TCoordinate t) const {
+    using namespace cube;
+    switch (edge) {
+    case e01:
+      return point<X, 0, 0, 0>(t);
+    case e02:
+      return point<Y, 0, 0, 0>(t);
+    case e04:
+      return point<Z, 0, 0, 0>(t);
+    case e13:
+      return point<Y, 1, 0, 0>(t);
+    case e15:
+      return point<Z, 1, 0, 0>(t);
+    case e23:
+      return point<X, 0, 1, 0>(t);
+    case e26:
+      return point<Z, 0, 1, 0>(t);
+    case e37:
+      return point<Z, 1, 1, 0>(t);
+    case e45:
+      return point<X, 0, 0, 1>(t);
+    case e46:
+      return point<Y, 0, 0, 1>(t);
+    case e57:
+      return point<Y, 1, 0, 1>(t);
+    case e67:
+      return point<X, 0, 1, 1>(t);
+    }
+    assert(false);
+    return {};
+  }
+
+private:
+  /*!
+   * Returns the point at the offset t along the edge that goes along AXIS
+   * from the vertex at the offsets (START_X, START_Y, START_Z) of the vertex 0.
+   */
+  template <size_t AXIS, size_t START_X, size_t START_Y, size_t START_Z>
+  Point point(TCoordinate t) const {
+    Point point{{START_X == 0 ? min[X] : max[X],
+                 START_Y == 0 ? min[Y] : max[Y],
+                 START_Z == 0 ? min[Z] : max[Z]}};
+    point[AXIS] = min[AXIS] + (max[AXIS] - min[AXIS]) * t;
+    return point;
+  }
+
+private:
+  Point min;
+  Point max;
+};
+
+using CubePoints = BasicCubePoints<double>;
+
+/*!
+ * \fn emitCubeTriangles
+ * \brief Calls emit(triangle3D) for each triangle of the configuration
+ * configIndex on the cube whose upper indices are (iX, iY, iZ). The points are
+ * interpolated with the precision of TCoordinate.
+ */
+template <typename TCoordinate = double, typename TCoordinates,
+          typename TEmit>
+void emitCubeTriangles(std::uint8_t configIndex,
+                       const TCoordinates &coordinates, size_t iX, size_t iY,
+                       size_t iZ,
+                       const std::array<double, VERTEX_COUNT> &cubeValues,
+                       TEmit &&emit) {
+  const auto &caseTable = casetable::CASE_TABLE;
+  const auto triangleCount = caseTable.triangleCounts[configIndex];
+  const auto *edge = caseTable.edges[configIndex].data();
+  const BasicCubePoints<TCoordinate> points{coordinates, iX - 1, iY - 1,
+                                            iZ - 1};
+  for (size_t iTriangle = 0; iTriangle < triangleCount; ++iTriangle) {
+    BasicTriangle3D<TCoordinate> triangle3D;
+    for (size_t i = 0; i < triangle3D.size(); ++i, ++edge) {
+      triangle3D[i] =
+          points.edgePoint(*edge, offset<TCoordinate>(cubeValues, *edge));
+    }
+    emit(triangle3D);
+  }
+}
+
+/*!
+ * \class CubeNormals
+ * \brief The class CubeNormals calculates the normals of the isosurface on
+ * the edges of the cube whose vertex 0 has the indices (x, y, z).
+ *
+ * The gradients of the values are calculated by central differences, or by
+ * one-sided differences on the borders of rows, once per cube and only at the
+ * vertices of the edges that the isosurface crosses. The normal at an edge
+ * point is the unit vector of the gradient interpolated between the 2
+ * vertices of the edge, so it points towards the greater values. It is null
+ * where the gradient is null.
+ */
+class CubeNormals {
+
+public:
+  template <typename TRows, typename TCoordinates>
+  CubeNormals(const TRows &rows, const TCoordinates &coordinates,
+              std::uint8_t configIndex, size_t x, size_t y, size_t z) {
+    const std::array<size_t, DIM_COUNT> indices{{x, y, z}};
+    // The indices before and after the vertices 0 and 1 of the cube along
+    // each axis, and the inverses of the distances between them.
+    std::array<std::array<size_t, 2>, DIM_COUNT> before;
+    std::array<std::array<size_t, 2>, DIM_COUNT> after;
+    std::array<std::array<double, 2>, DIM_COUNT> inverseDistances;
+    for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+      for (size_t i = 0; i < 2; ++i) {
+        const auto index = indices[iDim] + i;
+        before[iDim][i] = index > 0 ? index - 1 : index;
+        after[iDim][i] = index + 1 < rows.size(iDim) ? index + 1 : index;
+        inverseDistances[iDim][i] =
+            1.0 / (coordinates.coordinate(iDim, after[iDim][i]) -
+                   coordinates.coordinate(iDim, before[iDim][i]));
+      }
+    }
+    auto valueAt = [&rows](size_t atX, size_t atY, size_t atZ) {
+      return static_cast<double>(rows.row(atY, atZ)[atX]);
+    };
+    for (size_t vertex = 0; vertex < VERTEX_COUNT; ++vertex) {
+      const auto sign = configIndex >> vertex & 1;
+      if (sign == (configIndex >> (vertex ^ 1) & 1) &&
+          sign == (configIndex >> (vertex ^ 2) & 1) &&
+          sign == (configIndex >> (vertex ^ 4) & 1)) {
+        continue; // No crossed edge ends at this vertex.
+      }
+      const size_t dX = vertex & 1;
+      const size_t dY = vertex >> 1 & 1;
+      const size_t dZ = vertex >> 2;
+      const auto vX = x + dX;
+      const auto vY = y + dY;
+      const auto vZ = z + dZ;
+      auto &gradient = gradients[vertex];
+      gradient[X] = (valueAt(after[X][dX], vY, vZ) -
+                     valueAt(before[X][dX], vY, vZ)) *
+                    inverseDistances[X][dX];
+      gradient[Y] = (valueAt(vX, after[Y][dY], vZ) -
+                     valueAt(vX, before[Y][dY], vZ)) *
+                    inverseDistances[Y][dY];
+      gradient[Z] = (valueAt(vX, vY, after[Z][dZ]) -
+                     valueAt(vX, vY, before[Z][dZ])) *
+                    inverseDistances[Z][dZ];
+    }
+  }
+
+public:
+  /*!
+   * Returns the normal at the offset t along edge.
+   */
+  Vector3D edgeNormal(cube::Edge edge, double t) const {
+    using namespace cube;
+    switch (edge) {
+    case e01:
+      return normal<0, 1>(t);
+    case e02:
+      return normal<0, 2>(t);
+    case e04:
+      return normal<0, 4>(t);
+    case e13:
+      return normal<1, 3>(t);
+    case e15:
+      return normal<1, 5>(t);
+    case e23:
+      return normal<2, 3>(t);
+    case e26:
+      return normal<2, 6>(t);
+    case e37:
+      return normal<3, 7>(t);
+    case e45:
+      return normal<4, 5>(t);
+    case e46:
+      return normal<4, 6>(t);
+    case e57:
+      return normal<5, 7>(t);
+    case e67:
+      return normal<6, 7>(t);
+    }
+    assert(false);
+    return {};
+  }
+
+private:
+  template <size_t START, size_t END> Vector3D normal(double t) const {
+    Vector3D normal;
+    double squaredNorm = 0.0;
+    for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+      normal[iDim] = gradients[START][iDim] +
+                     (gradients[END][iDim] - gradients[START][iDim]) * t;
+      squaredNorm += normal[iDim] * normal[iDim];
+    }
+    if (squaredNorm > 0.0) {
+      const auto inverseNorm = 1.0 / std::sqrt(squaredNorm);
+      for (auto &coordinate : normal) {
+        coordinate *= inverseNorm;
+      }
+    }
+    return normal;
+  }
+
+private:
+  std::array<Vector3D, VERTEX_COUNT> gradients;
+};
+
+/*!
+ * \fn emitCubeTrianglesWithNormals
+ * \brief Calls emit(triangle3D, normals) for each triangle of the
+ * configuration configIndex on the cube whose upper indices are (iX, iY, iZ),
+ * with the normals at its vertices calculated from the values of rows.
+ */
+template <typename TRows, typename TCoordinates, typename TEmit>
+void emitCubeTrianglesWithNormals(
+    std::uint8_t configIndex, const TRows &rows,
+    const TCoordinates &coordinates, size_t iX, size_t iY, size_t iZ,
+    const std::array<double, VERTEX_COUNT> &cubeValues, TEmit &&emit) {
+  const auto &caseTable = casetable::CASE_TABLE;
+  const auto triangleCount = caseTable.triangleCounts[configIndex];
+  const auto *edge = caseTable.edges[configIndex].data();
+  const CubePoints points{coordinates, iX - 1, iY - 1, iZ - 1};
+  const CubeNormals cubeNormals{rows, coordinates, configIndex, iX - 1, iY - 1,
+                                iZ - 1};
+  for (size_t iTriangle = 0; iTriangle < triangleCount; ++iTriangle) {
+    Triangle3D triangle3D;
+    TriangleNormals normals;
+    for (size_t i = 0; i < triangle3D.size(); ++i, ++edge) {
+      const auto t = offset(cubeValues, *edge);
+      triangle3D[i] = points.edgePoint(*edge, t);
+      normals[i] = cubeNormals.edgeNormal(*edge, t);
+    }
+    emit(triangle3D, normals);
+  }
+}
+
+/*!
+ * \class RowSigns
+ * \brief The alias RowSigns stores the SignWords of the 4 rows
+ * (iY - 1, iZ - 1), (iY, iZ - 1), (iY - 1, iZ) and (iY, iZ) that contain the
+ * vertices of a row of cubes, in the order of the configuration bits.
+ */
+using RowSigns = std::array<std::vector<SignWord>, 4>;
+
+/*!
+ * \fn classifyRow
+ * \brief Stores in signs the SignWords of the row (iY, iZ) that contain the
+ * vertices of the X index ranges xRanges.
+ */
+template <typename TRows>
+void classifyRow(const TRows &rows, double isoValue, size_t iY, size_t iZ,
+                 const std::vector<std::pair<size_t, size_t>> &xRanges,
+                 std::vector<SignWord> &signs) {
+  const auto *row = rows.row(iY, iZ);
+  const auto xSize = rows.size(X);
+  for (const auto &[xBegin, xEnd] : xRanges) {
+    for (auto word = xBegin / SIGN_WORD_BITS; word <= xEnd / SIGN_WORD_BITS;
+         ++word) {
+      const auto first = word * SIGN_WORD_BITS;
+      signs[word] = signBits(row + first,
+                             std::min(SIGN_WORD_BITS, xSize - first), isoValue);
+    }
+  }
+}
+
+/*!
+ * \fn forEachCubeInRow
+ * \brief Calls visitCube(iX, iY, iZ, configIndex, cubeValues) for each cube
+ * whose upper indices are (iX, iY, iZ) with iX in [xBegin + 1, xEnd + 1), and
+ * whose configuration is neither 0 nor 255.
+ *
+ * The configurations are built from the SignWords of the row, so that the
+ * cubes entirely below or above the isovalue are skipped 64 at a time without
+ * reading their values. cubeValues contains the differences between the
+ * values and isoValue on the vertices of the cube.
+ */
+template <typename TRows, typename TVisitor>
+void forEachCubeInRow(const TRows &rows, double isoValue,
+                      const RowSigns &signs, size_t xBegin, size_t xEnd,
+                      size_t iY, size_t iZ, TVisitor &visitCube) {
+  /**
+   *      6_____7
+   *     /|    /|        z
+   *    4_____5 |        |  y
+   *    | |   | |        | /
+   *    | |   | |        |/
+   *    | |   | |        #----- x
+   *    | 2___|_3
+   *    |/    |/
+   *    0_____1
+   */
+  const std::array<const typename TRows::Value *, 4> rowValues{
+      {rows.row(iY - 1, iZ - 1), rows.row(iY, iZ - 1), rows.row(iY - 1, iZ),
+       rows.row(iY, iZ)}};
+  constexpr auto ALL_BITS = ~SignWord{0};
+  for (auto word = (xBegin + 1) / SIGN_WORD_BITS; word <= xEnd / SIGN_WORD_BITS;
+       ++word) {
+    // Bit b of the masks stands for the cube whose upper X index is
+    // word * SIGN_WORD_BITS + b: its vertices are the bits b - 1 and b of
+    // the 4 rows.
+    SignWord anySet = 0;
+    SignWord allSet = ALL_BITS;
+    for (const auto &rowSigns : signs) {
+      const auto upper = rowSigns[word];
+      const auto lower =
+          upper << 1 | (word > 0 ? rowSigns[word - 1] >> (SIGN_WORD_BITS - 1)
+                                 : SignWord{0});
+      anySet |= upper | lower;
+      allSet &= upper & lower;
+    }
+    const auto first = word * SIGN_WORD_BITS;
+    const auto firstBit = std::max(xBegin + 1, first) - first;
+    const auto lastBit = std::min(xEnd, first + SIGN_WORD_BITS - 1) - first;
+    auto cubes = anySet & ~allSet & (ALL_BITS << firstBit) &
+                 (ALL_BITS >> (SIGN_WORD_BITS - 1 - lastBit));
+    while (cubes != 0) {
+      const auto bit = lowestBitIndex(cubes);
+      cubes &= cubes - 1;
+      const auto iX = first + bit;
+      auto signAt = [&signs](size_t iRow, size_t x) {
+        return static_cast<unsigned>(
+            signs[iRow][x / SIGN_WORD_BITS] >> (x % SIGN_WORD_BITS) & 1);
+      };
+      unsigned configBitSet = 0;
+      std::array<double, VERTEX_COUNT> cubeValues;
+      for (size_t iRow = 0; iRow < rowValues.size(); ++iRow) {
+        configBitSet |= signAt(iRow, iX - 1) << (2 * iRow) |
+                        signAt(iRow, iX) << (2 * iRow + 1);
+        cubeValues[2 * iRow] =
+            static_cast<double>(rowValues[iRow][iX - 1]) - isoValue;
+        cubeValues[2 * iRow + 1] =
+            static_cast<double>(rowValues[iRow][iX]) - isoValue;
+      }
+      const auto configIndex = static_cast<std::uint8_t>(configBitSet);
+      visitCube(iX, iY, iZ, configIndex, cubeValues);
+    }
+  }
+}
+
+/*!
+ * \fn forEachCubeOfIsoValues
+ * \brief Calls visitCube(iIso, iX, iY, iZ, configIndex, cubeValues) for each
+ * isovalue isoValues[iIso] and each cube whose upper Z index is in
+ * [zBegin, zEnd) and whose configuration for this isovalue is neither 0 nor
+ * 255. The cubes are visited in Z, Y, X order for each isovalue.
+ *
+ * A cube is identified by the indices of its vertex 7. Each row is classified
+ * once per layer of cubes, and reused by the next row of cubes. The rows of a
+ * row of cubes are classified for all the isovalues one after the other, so
+ * they are read from memory only once. When rows has a MinMaxHierarchy, only
+ * the X ranges of the bricks that may intersect the isosurface are classified
+ * and visited.
+ *
+ * rowDone() is called after each row of cubes, e.g. to report the progress of
+ * the calculation, or to stop it by throwing an exception.
+ */
+template <typename TRows, typename TVisitor, typename TRowDone>
+void forEachCubeOfIsoValues(const TRows &rows,
+                            const std::vector<double> &isoValues,
+                            size_t zBegin, size_t zEnd, TVisitor &&visitCube,
+                            TRowDone &&rowDone) {
+  const auto *hierarchy = rows.minMaxHierarchy();
+  std::vector<std::vector<std::pair<size_t, size_t>>> xRanges(
+      isoValues.size(), {{0, rows.size(X) - 1}});
+  auto brickRowOf = [hierarchy](size_t iY, size_t iZ) {
+    return std::make_pair((iY - 1) / hierarchy->brickSize(),
+                          (iZ - 1) / hierarchy->brickSize());
+  };
+  std::vector<RowSigns> signs(isoValues.size());
+  for (auto &isoSigns : signs) {
+    for (auto &rowSigns : isoSigns) {
+      rowSigns.assign(signWordCount(rows.size(X)), 0);
+    }
+  }
+  for (size_t iZ = zBegin; iZ < zEnd; ++iZ) {
+    for (size_t iY = 1; iY < rows.size(Y); ++iY) {
+      const bool newBrickRow =
+          hierarchy != nullptr &&
+          (iY == 1 || brickRowOf(iY, iZ) != brickRowOf(iY - 1, iZ));
+      for (size_t iIso = 0; iIso < isoValues.size(); ++iIso) {
+        const auto isoValue = isoValues[iIso];
+        auto &isoRanges = xRanges[iIso];
+        auto &isoSigns = signs[iIso];
+        bool rangesChanged = iY == 1;
+        if (newBrickRow) {
+          hierarchy->intersectingXRanges(iY - 1, iZ - 1, isoValue, isoRanges);
+          rangesChanged = true;
+        }
+        if (rangesChanged) {
+          classifyRow(rows, isoValue, iY - 1, iZ - 1, isoRanges, isoSigns[0]);
+          classifyRow(rows, isoValue, iY - 1, iZ, isoRanges, isoSigns[2]);
+        } else {
+          std::swap(isoSigns[0], isoSigns[1]);
+          std::swap(isoSigns[2], isoSigns[3]);
+        }
+        classifyRow(rows, isoValue, iY, iZ - 1, isoRanges, isoSigns[1]);
+        classifyRow(rows, isoValue, iY, iZ, isoRanges, isoSigns[3]);
+        auto visitIsoCube =
+            [&visitCube, iIso](size_t iX, size_t iCubeY, size_t iCubeZ,
+                               std::uint8_t configIndex,
+                               const std::array<double, VERTEX_COUNT> &values) {
+              visitCube(iIso, iX, iCubeY, iCubeZ, configIndex, values);
+            };
+        for (const auto &[xBegin, xEnd] : isoRanges) {
+          forEachCubeInRow(rows, isoValue, isoSigns, xBegin, xEnd, iY, iZ,
+                           visitIsoCube);
+        }
+      }
+      rowDone();
+    }
+  }
+}
+
+template <typename TRows, typename TVisitor>
+void forEachCubeOfIsoValues(const TRows &rows,
+                            const std::vector<double> &isoValues,
+                            size_t zBegin, size_t zEnd,
+                            TVisitor &&visitCube) {
+  forEachCubeOfIsoValues(rows, isoValues, zBegin, zEnd,
+                         std::forward<TVisitor>(visitCube), [] {});
+}
+
+/*!
+ * \fn forEachCube
+ * \brief Calls visitCube(iX, iY, iZ, configIndex, cubeValues) for each cube
+ * whose upper Z index is in [zBegin, zEnd) and whose configuration is neither
+ * 0 nor 255, in Z, Y, X order, and rowDone() after each row of cubes. See
+ * forEachCubeOfIsoValues.
+ */
+template <typename TRows, typename TVisitor, typename TRowDone>
+void forEachCube(const TRows &rows, double isoValue, size_t zBegin,
+                 size_t zEnd, TVisitor &&visitCube, TRowDone &&rowDone) {
+  forEachCubeOfIsoValues(
+      rows, std::vector<double>{isoValue}, zBegin, zEnd,
+      [&visitCube](size_t, size_t iX, size_t iY, size_t iZ,
+                   std::uint8_t configIndex,
+                   const std::array<double, VERTEX_COUNT> &cubeValues) {
+        visitCube(iX, iY, iZ, configIndex, cubeValues);
+      },
+      std::forward<TRowDone>(rowDone));
+}
+
+template <typename TRows, typename TVisitor>
+void forEachCube(const TRows &rows, double isoValue, size_t zBegin,
+                 size_t zEnd, TVisitor &&visitCube) {
+  forEachCube(rows, isoValue, zBegin, zEnd, std::forward<TVisitor>(visitCube),
+              [] {});
+}
+
+} // namespace marchingcubes::internal
@@ -6,11 +6,21 @@
  * https://www.boost.org/LICENSE_1_0.txt)
  */
 
+#include "marching-cubes/AdaptiveMarchingCubes.hpp"
+#include "marching-cubes/BrickedTensor3D.hpp"
+#include "marching-cubes/CompressedTensor3D.hpp"
+#include "marching-cubes/IncrementalMarchingCubes.hpp"
 #include "marching-cubes/MarchingCubes.hpp"
+#include "marching-cubes/QuadricDecimation.hpp"
 #include "marching-cubes/Tensor3D.hpp"
 
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <thread>
+
 using namespace marchingcubes;
 
 static MarchingCubes algo{};
@@ -26,3 +36,477 @@ static void BM_MarchingCubes(benchmark::State &state) {
 }
 
 BENCHMARK(BM_MarchingCubes)->RangeMultiplier(2)->Range(8, 256);
+
+static void BM_MarchingCubesFloat(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  auto sphere = createSphere(grid);
+  for (auto _ : state)
+    auto isoSurface = algo.isoSurface<float>(grid, sphere, 4.0);
+}
+
+BENCHMARK(BM_MarchingCubesFloat)->RangeMultiplier(2)->Range(8, 256);
+
+static void BM_MarchingCubesExplicitGrid(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  // Points that are not equidistant, so the coordinates are read from the
+  // grid values instead of being calculated from a UniformGrid3D.
+  auto unevenPoints = [size](double min, double max) {
+    auto points = equidistantPoints(min, max, size);
+    for (size_t i = 1; i + 1 < size; i += 2) {
+      points[i] += 0.25 * (points[i + 1] - points[i]);
+    }
+    return points;
+  };
+  Grid3D grid{unevenPoints(-1.0, 1.0), unevenPoints(-2.0, 2.0),
+              unevenPoints(-3.0, 3.0)};
+  auto sphere = createSphere(grid);
+  for (auto _ : state)
+    auto isoSurface = algo.isoSurface(grid, sphere, 4.0);
+}
+
+BENCHMARK(BM_MarchingCubesExplicitGrid)->RangeMultiplier(2)->Range(8, 256);
+
+static void BM_MarchingCubesWithNormals(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  auto sphere = createSphere(grid);
+  std::vector<TriangleNormals> normals;
+  for (auto _ : state)
+    auto isoSurface = algo.isoSurfaceWithNormals(grid, sphere, 4.0, normals);
+}
+
+BENCHMARK(BM_MarchingCubesWithNormals)->RangeMultiplier(2)->Range(8, 256);
+
+static const std::vector<double> TISSUE_ISO_VALUES{{1.0, 2.5, 4.0, 6.0}};
+
+static void BM_MarchingCubesSeveralIsoValues(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  auto sphere = createSphere(grid);
+  for (auto _ : state) {
+    for (auto isoValue : TISSUE_ISO_VALUES) {
+      auto isoSurface = algo.isoSurface(grid, sphere, isoValue);
+    }
+  }
+}
+
+BENCHMARK(BM_MarchingCubesSeveralIsoValues)
+    ->RangeMultiplier(2)
+    ->Range(8, 256);
+
+static void BM_MarchingCubesIsoSurfaces(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  auto sphere = createSphere(grid);
+  for (auto _ : state)
+    auto isoSurfaces = algo.isoSurfaces(grid, sphere, TISSUE_ISO_VALUES);
+}
+
+BENCHMARK(BM_MarchingCubesIsoSurfaces)->RangeMultiplier(2)->Range(8, 256);
+
+static void BM_MarchingCubesMesh(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  auto sphere = createSphere(grid);
+  for (auto _ : state)
+    auto isoSurface = algo.isoSurfaceMesh(grid, sphere, 4.0);
+}
+
+BENCHMARK(BM_MarchingCubesMesh)->RangeMultiplier(2)->Range(8, 256);
+
+static void BM_MarchingCubesSink(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  auto sphere = createSphere(grid);
+  // A reduction over the triangles, without storing them.
+  struct CountingSink {
+    void emit(const Triangle3D &) { ++count; }
+    size_t count = 0;
+  };
+  for (auto _ : state) {
+    CountingSink sink;
+    algo.isoSurface(grid, sphere, 4.0, sink);
+    benchmark::DoNotOptimize(sink.count);
+  }
+}
+
+BENCHMARK(BM_MarchingCubesSink)->RangeMultiplier(2)->Range(8, 256);
+
+static void BM_MarchingCubesCountThenFill(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  auto sphere = createSphere(grid);
+  MarchingCubes countingAlgo{};
+  countingAlgo.setTriangleAllocation(TriangleAllocation::CountThenFill);
+  for (auto _ : state)
+    auto isoSurface = countingAlgo.isoSurface(grid, sphere, 4.0);
+}
+
+BENCHMARK(BM_MarchingCubesCountThenFill)->RangeMultiplier(2)->Range(8, 256);
+
+static void BM_MarchingCubesMinMaxHierarchy(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  auto sphere = createSphere(grid);
+  sphere.buildMinMaxHierarchy();
+  for (auto _ : state)
+    auto isoSurface = algo.isoSurface(grid, sphere, 4.0);
+}
+
+BENCHMARK(BM_MarchingCubesMinMaxHierarchy)->RangeMultiplier(2)->Range(8, 256);
+
+/*!
+ * The iso-surface in a corner box of half the size of the tensor along each
+ * axis, which contains an eighth of the sphere.
+ */
+static void BM_MarchingCubesIndexBox(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  auto sphere = createSphere(grid);
+  const IndexBox box{{{0, 0, 0}}, {{size / 2, size / 2, size / 2}}};
+  for (auto _ : state)
+    auto isoSurface = algo.isoSurface(grid, sphere, 4.0, box);
+}
+
+BENCHMARK(BM_MarchingCubesIndexBox)->RangeMultiplier(2)->Range(8, 256);
+
+static void BM_MarchingCubesView(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  auto sphere = createSphere(grid);
+  const Tensor3DView view{sphere};
+  for (auto _ : state)
+    auto isoSurface = algo.isoSurface(grid, view, 4.0);
+}
+
+BENCHMARK(BM_MarchingCubesView)->RangeMultiplier(2)->Range(8, 256);
+
+/*!
+ * A view whose fastest axis is Z: the X rows are gathered before being
+ * classified.
+ */
+static void BM_MarchingCubesZFirstView(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  auto sphere = createSphere(grid);
+  std::vector<double> zFirst(size * size * size);
+  for (size_t z = 0; z < size; ++z) {
+    for (size_t y = 0; y < size; ++y) {
+      for (size_t x = 0; x < size; ++x) {
+        zFirst[z + size * (y + size * x)] = sphere.value(x, y, z);
+      }
+    }
+  }
+  const auto stride = static_cast<std::ptrdiff_t>(size);
+  const Tensor3DView view{
+      zFirst.data(), {{size, size, size}}, {{stride * stride, stride, 1}}};
+  for (auto _ : state)
+    auto isoSurface = algo.isoSurface(grid, view, 4.0);
+}
+
+BENCHMARK(BM_MarchingCubesZFirstView)->RangeMultiplier(2)->Range(8, 256);
+
+// The isovalues of a slider dragged around 4.0.
+static double sliderIsoValue(size_t step) {
+  return 4.0 + 0.01 * static_cast<double>(step % 8);
+}
+
+static void BM_MarchingCubesSlider(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  auto sphere = createSphere(grid);
+  sphere.buildMinMaxHierarchy();
+  size_t step = 0;
+  for (auto _ : state)
+    auto isoSurface = algo.isoSurface(grid, sphere, sliderIsoValue(step++));
+}
+
+BENCHMARK(BM_MarchingCubesSlider)->RangeMultiplier(2)->Range(8, 256);
+
+static void BM_IncrementalMarchingCubesSlider(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  auto sphere = createSphere(grid);
+  IncrementalMarchingCubes<double> incremental{grid, sphere};
+  size_t step = 0;
+  for (auto _ : state)
+    auto isoSurface = incremental.isoSurface(sliderIsoValue(step++));
+}
+
+BENCHMARK(BM_IncrementalMarchingCubesSlider)
+    ->RangeMultiplier(2)
+    ->Range(8, 256);
+
+static void BM_MarchingCubesUint16(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  auto sphere = createSphere(grid);
+  // Same sphere, scaled to use the range of 16-bit values.
+  std::vector<std::uint16_t> values;
+  values.reserve(sphere.allValues().size());
+  for (auto value : sphere.allValues()) {
+    values.push_back(static_cast<std::uint16_t>(1000.0 * value));
+  }
+  Tensor3DUint16 uint16Sphere{size, size, size, std::move(values)};
+  for (auto _ : state)
+    auto isoSurface = algo.isoSurface(grid, uint16Sphere, 4000.0);
+}
+
+BENCHMARK(BM_MarchingCubesUint16)->RangeMultiplier(2)->Range(8, 256);
+
+/*!
+ * Returns a sphere of size^3 8-bit values, calculated value by value, as
+ * createSphere would need 8 bytes per value for the large sizes. The
+ * isosurface for 80 is the sphere of createSphere for 4.0.
+ */
+static Tensor3DUint8 uint8Sphere(const Grid3D &grid) {
+  const auto size = grid.values[X].size();
+  std::vector<std::uint8_t> values(size * size * size);
+  auto *value = values.data();
+  for (auto z : grid.values[Z]) {
+    for (auto y : grid.values[Y]) {
+      for (auto x : grid.values[X]) {
+        *(value++) = static_cast<std::uint8_t>(
+            std::min(255.0, 20.0 * (x * x + y * y + z * z)));
+      }
+    }
+  }
+  return {size, size, size, std::move(values)};
+}
+
+static Grid3D uint8SphereGrid(size_t size) {
+  return {equidistantPoints(-1.0, 1.0, size),
+          equidistantPoints(-2.0, 2.0, size),
+          equidistantPoints(-3.0, 3.0, size)};
+}
+
+static void BM_MarchingCubesUint8(benchmark::State &state) {
+  const auto grid = uint8SphereGrid(static_cast<size_t>(state.range(0)));
+  const auto sphere = uint8Sphere(grid);
+  for (auto _ : state)
+    auto isoSurface = algo.isoSurface(grid, sphere, 80.0);
+}
+
+BENCHMARK(BM_MarchingCubesUint8)
+    ->RangeMultiplier(2)
+    ->Range(256, 1024)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_MarchingCubesUint8MinMaxHierarchy(benchmark::State &state) {
+  const auto grid = uint8SphereGrid(static_cast<size_t>(state.range(0)));
+  auto sphere = uint8Sphere(grid);
+  sphere.buildMinMaxHierarchy();
+  for (auto _ : state)
+    auto isoSurface = algo.isoSurface(grid, sphere, 80.0);
+}
+
+BENCHMARK(BM_MarchingCubesUint8MinMaxHierarchy)
+    ->RangeMultiplier(2)
+    ->Range(256, 1024)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_MarchingCubesBricked(benchmark::State &state) {
+  const auto grid = uint8SphereGrid(static_cast<size_t>(state.range(0)));
+  const BrickedTensor3DUint8 sphere{uint8Sphere(grid)};
+  for (auto _ : state)
+    auto isoSurface = algo.isoSurface(grid, sphere, 80.0);
+}
+
+BENCHMARK(BM_MarchingCubesBricked)
+    ->RangeMultiplier(2)
+    ->Range(256, 1024)
+    ->Unit(benchmark::kMillisecond);
+
+/*!
+ * The "compression" counter is the size of the values of the tensor divided
+ * by the size of the compressed values.
+ */
+static void BM_MarchingCubesCompressed(benchmark::State &state) {
+  const auto grid = uint8SphereGrid(static_cast<size_t>(state.range(0)));
+  const CompressedTensor3DUint8 sphere{uint8Sphere(grid)};
+  for (auto _ : state)
+    auto isoSurface = algo.isoSurface(grid, sphere, 80.0);
+  state.counters["compression"] =
+      static_cast<double>(sphere.size(X) * sphere.size(Y) * sphere.size(Z)) /
+      static_cast<double>(sphere.byteCount());
+}
+
+BENCHMARK(BM_MarchingCubesCompressed)
+    ->RangeMultiplier(2)
+    ->Range(256, 1024)
+    ->Unit(benchmark::kMillisecond);
+
+/*!
+ * Extracts the isosurface of the level range(1) of the pyramid of the sphere,
+ * as MCubesWindow does while the slider is dragged.
+ */
+static void BM_MarchingCubesPyramidLevel(benchmark::State &state) {
+  const auto grid = uint8SphereGrid(static_cast<size_t>(state.range(0)));
+  const auto level = static_cast<size_t>(state.range(1));
+  auto sphere = uint8Sphere(grid);
+  sphere.buildPyramid(level, std::thread::hardware_concurrency());
+  const auto levelGrid = pyramidGrid(grid, level);
+  const auto &levelTensor = sphere.pyramidLevel(level);
+  for (auto _ : state)
+    auto isoSurface = algo.isoSurface(levelGrid, levelTensor, 80.0);
+}
+
+BENCHMARK(BM_MarchingCubesPyramidLevel)
+    ->ArgsProduct({{512}, {0, 1, 2, 3}})
+    ->Unit(benchmark::kMillisecond);
+
+/*!
+ * Calculates the isosurface of tensor for isoValue with range(1) threads. The
+ * "speedup" counter compares the time per iteration with the one measured
+ * with 1 thread for the same size, stored in singleThreadSeconds, that is why
+ * the thread counts are registered in increasing order.
+ */
+static void runThreads(benchmark::State &state, const Grid3D &grid,
+                       const Tensor3D &tensor, double isoValue,
+                       std::map<size_t, double> &singleThreadSeconds) {
+  auto size = static_cast<size_t>(state.range(0));
+  auto threadCount = static_cast<size_t>(state.range(1));
+  MarchingCubes threadedAlgo{threadCount};
+  auto start = std::chrono::steady_clock::now();
+  for (auto _ : state) {
+    auto isoSurface = threadedAlgo.isoSurface(grid, tensor, isoValue);
+    benchmark::DoNotOptimize(isoSurface.data());
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  auto seconds = elapsed.count() / static_cast<double>(state.iterations());
+  if (threadCount == 1) {
+    singleThreadSeconds[size] = seconds;
+  }
+  state.counters["threads"] = static_cast<double>(threadCount);
+  if (singleThreadSeconds.count(size) != 0) {
+    state.counters["speedup"] = singleThreadSeconds[size] / seconds;
+  }
+}
+
+static void BM_MarchingCubesThreads(benchmark::State &state) {
+  static std::map<size_t, double> singleThreadSeconds;
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  runThreads(state, grid, createSphere(grid), 4.0, singleThreadSeconds);
+}
+
+/*!
+ * Same as BM_MarchingCubesThreads, on a volume whose isosurface is a sphere
+ * in a corner: it is in less than 1/64 of the cubes, all in the first
+ * quarter of the Z layers, so that the cost of the slabs is very uneven.
+ */
+static void BM_MarchingCubesSkewedThreads(benchmark::State &state) {
+  static std::map<size_t, double> singleThreadSeconds;
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 7.0, size),
+              equidistantPoints(-1.0, 7.0, size),
+              equidistantPoints(-1.0, 7.0, size)};
+  runThreads(state, grid, createSphere(grid), 0.9, singleThreadSeconds);
+}
+
+static void threadCountArguments(benchmark::internal::Benchmark *benchmark) {
+  const auto maxThreadCount =
+      std::max<int64_t>(1, std::thread::hardware_concurrency());
+  for (int64_t size : {64, 128, 256}) {
+    for (int64_t threadCount = 1; threadCount < maxThreadCount;
+         threadCount *= 2) {
+      benchmark->Args({size, threadCount});
+    }
+    benchmark->Args({size, maxThreadCount});
+  }
+}
+
+BENCHMARK(BM_MarchingCubesThreads)
+    ->Apply(threadCountArguments)
+    ->ArgNames({"size", "threads"})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_MarchingCubesSkewedThreads)
+    ->Apply(threadCountArguments)
+    ->ArgNames({"size", "threads"})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+/*!
+ * Decimates the mesh of the sphere to a tenth of its triangles with range(1)
+ * threads.
+ */
+static void BM_QuadricDecimation(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  const auto mesh = algo.isoSurfaceMesh(grid, createSphere(grid), 4.0);
+  QuadricDecimation decimation{static_cast<size_t>(state.range(1))};
+  decimation.setTargetTriangleCount(mesh.triangles.size() / 10);
+  for (auto _ : state) {
+    auto decimated = decimation.decimate(mesh);
+    benchmark::DoNotOptimize(decimated.triangles.data());
+  }
+  state.counters["triangles"] = static_cast<double>(mesh.triangles.size());
+}
+
+BENCHMARK(BM_QuadricDecimation)
+    ->Apply(threadCountArguments)
+    ->ArgNames({"size", "threads"})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+/*!
+ * Calculates the isosurface of the sphere on an octree whose cells differ by
+ * at most range(1) / 100 from their trilinear interpolation, and reports its
+ * number of triangles.
+ */
+static void BM_AdaptiveMarchingCubes(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  Grid3D grid{equidistantPoints(-1.0, 1.0, size),
+              equidistantPoints(-2.0, 2.0, size),
+              equidistantPoints(-3.0, 3.0, size)};
+  const auto sphere = createSphere(grid);
+  AdaptiveMarchingCubes adaptive;
+  adaptive.setMaxError(static_cast<double>(state.range(1)) / 100.0);
+  size_t triangleCount = 0;
+  for (auto _ : state) {
+    auto mesh = adaptive.isoSurfaceMesh(grid, sphere, 4.0);
+    triangleCount = mesh.triangles.size();
+  }
+  state.counters["triangles"] = static_cast<double>(triangleCount);
+}
+
+BENCHMARK(BM_AdaptiveMarchingCubes)
+    ->ArgsProduct({{256}, {0, 1, 4}})
+    ->ArgNames({"size", "maxError%"})
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,190 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/AdaptiveMarchingCubes.hpp"
+
+#include "marching-cubes/MarchingCubes.hpp"
+#include "marching-cubes/Tensor3D.hpp"
+#include "marching-cubes/tests/testTools.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include <catch2/catch.hpp>
+
+namespace marchingcubes::tests {
+
+/*!
+ * Returns the volume enclosed by mesh, which is positive when its triangles
+ * are oriented outwards.
+ */
+static double signedVolume(const IndexedMesh &mesh) {
+  double volume = 0.0;
+  for (const auto &triangle : mesh.triangles) {
+    const auto &a = mesh.vertices[triangle[0]];
+    const auto &b = mesh.vertices[triangle[1]];
+    const auto &c = mesh.vertices[triangle[2]];
+    volume += a[X] * (b[Y] * c[Z] - b[Z] * c[Y]) -
+              a[Y] * (b[X] * c[Z] - b[Z] * c[X]) +
+              a[Z] * (b[X] * c[Y] - b[Y] * c[X]);
+  }
+  return volume / 6.0;
+}
+
+SCENARIO("AdaptiveMarchingCubes on a sphere") {
+  GIVEN("A sphere whose cubes are not a multiple of the cell size") {
+    // The spacing is 0.25 along each axis.
+    Grid3D grid{equidistantPoints(-9.5, 9.5, 77),
+                equidistantPoints(-10.0, 10.0, 81),
+                equidistantPoints(-11.0, 11.25, 90)};
+    const auto sphere = createSphere(grid);
+    const auto mcMesh = MarchingCubes{}.isoSurfaceMesh(grid, sphere, 49.0);
+    AdaptiveMarchingCubes algo;
+    for (const double maxError : {0.0, 1.0, 4.0}) {
+      WHEN("I calculate the isosurface for a max error of " +
+           std::to_string(maxError)) {
+        algo.setMaxError(maxError);
+        const auto mesh = algo.isoSurfaceMesh(grid, sphere, 49.0);
+        THEN("The isosurface is closed, without cracks") {
+          REQUIRE(!mesh.triangles.empty());
+          const auto counts = edgeTriangleCounts(mesh);
+          REQUIRE(std::all_of(counts.begin(), counts.end(), [](auto count) {
+            return count.second == 2;
+          }));
+        }
+        THEN("Its triangles are oriented outwards, and enclose the sphere") {
+          const auto expectedVolume = 4.0 / 3.0 * std::acos(-1.0) * 343.0;
+          REQUIRE(signedVolume(mesh) ==
+                  Approx(expectedVolume).epsilon(0.01 + 0.02 * maxError));
+        }
+        THEN("Its vertices are close to the sphere") {
+          for (const auto &vertex : mesh.vertices) {
+            const auto radius = std::sqrt(vertex[X] * vertex[X] +
+                                          vertex[Y] * vertex[Y] +
+                                          vertex[Z] * vertex[Z]);
+            REQUIRE(radius == Approx(7.0).margin(0.01 + 0.1 * maxError));
+          }
+        }
+        if (maxError >= 1.0) {
+          THEN("It has many times fewer triangles than MarchingCubes") {
+            REQUIRE(5 * mesh.triangles.size() < mcMesh.triangles.size());
+          }
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("AdaptiveMarchingCubes on a sphere cut by the tensor") {
+  GIVEN("A sphere cut by the last points of a tensor of 2^n points") {
+    // The spacing is 0.25 along each axis, and the last X is 6.5.
+    Grid3D grid{equidistantPoints(-9.25, 6.5, 64),
+                equidistantPoints(-7.75, 7.75, 64),
+                equidistantPoints(-7.75, 7.75, 64)};
+    const auto sphere = createSphere(grid);
+    const auto mcMesh = MarchingCubes{}.isoSurfaceMesh(grid, sphere, 49.0);
+    AdaptiveMarchingCubes algo;
+    for (const double maxError : {0.0, 1.0, 4.0}) {
+      WHEN("I calculate the isosurface for a max error of " +
+           std::to_string(maxError)) {
+        algo.setMaxError(maxError);
+        const auto mesh = algo.isoSurfaceMesh(grid, sphere, 49.0);
+        THEN("It is closed, except on the last points along X") {
+          REQUIRE(!mesh.triangles.empty());
+          for (const auto &[edge, count] : edgeTriangleCounts(mesh)) {
+            REQUIRE(edge.first != edge.second);
+            if (count != 2) {
+              REQUIRE(count == 1);
+              REQUIRE(mesh.vertices[edge.first][X] == 6.5);
+              REQUIRE(mesh.vertices[edge.second][X] == 6.5);
+            }
+          }
+        }
+        THEN("Its vertices are close to the sphere, inside the tensor") {
+          for (const auto &vertex : mesh.vertices) {
+            const auto radius = std::sqrt(vertex[X] * vertex[X] +
+                                          vertex[Y] * vertex[Y] +
+                                          vertex[Z] * vertex[Z]);
+            REQUIRE(radius == Approx(7.0).margin(0.01 + 0.1 * maxError));
+            REQUIRE(vertex[X] <= 6.5);
+          }
+        }
+        if (maxError >= 4.0) {
+          THEN("It has an order of magnitude fewer triangles") {
+            REQUIRE(10 * mesh.triangles.size() < mcMesh.triangles.size());
+          }
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("AdaptiveMarchingCubes on linear values") {
+  GIVEN("The values x + 2 y + 3 z") {
+    Grid3D grid{equidistantPoints(0.0, 40.0, 41),
+                equidistantPoints(0.0, 40.0, 41),
+                equidistantPoints(0.0, 40.0, 41)};
+    std::vector<double> values;
+    for (size_t z = 0; z < 41; ++z) {
+      for (size_t y = 0; y < 41; ++y) {
+        for (size_t x = 0; x < 41; ++x) {
+          values.push_back(double(x + 2 * y + 3 * z));
+        }
+      }
+    }
+    const Tensor3D tensor{41, 41, 41, std::move(values)};
+    AdaptiveMarchingCubes algo;
+    WHEN("I calculate the isosurface for 100.5 with a max error of 0") {
+      const auto mesh = algo.isoSurfaceMesh(grid, tensor, 100.5);
+      THEN("Its vertices are on the plane, with few triangles") {
+        REQUIRE(!mesh.triangles.empty());
+        for (const auto &vertex : mesh.vertices) {
+          REQUIRE(vertex[X] + 2 * vertex[Y] + 3 * vertex[Z] ==
+                  Approx(100.5));
+        }
+        const auto mcMesh = MarchingCubes{}.isoSurfaceMesh(grid, tensor, 100.5);
+        REQUIRE(5 * mesh.triangles.size() < mcMesh.triangles.size());
+      }
+      THEN("Its edges are shared by at most 2 triangles") {
+        const auto counts = edgeTriangleCounts(mesh);
+        REQUIRE(std::all_of(counts.begin(), counts.end(), [](auto count) {
+          return count.second <= 2;
+        }));
+      }
+    }
+    WHEN("I calculate the isosurface for a value out of the values") {
+      const auto mesh = algo.isoSurfaceMesh(grid, tensor, 1000.0);
+      THEN("It is empty") {
+        REQUIRE(mesh.vertices.empty());
+        REQUIRE(mesh.triangles.empty());
+      }
+    }
+  }
+}
+
+SCENARIO("AdaptiveMarchingCubes max cell size") {
+  GIVEN("An AdaptiveMarchingCubes") {
+    AdaptiveMarchingCubes algo;
+    REQUIRE(algo.maxCellSize() == 16);
+    WHEN("I set a max cell size which is a power of 2") {
+      algo.setMaxCellSize(4);
+      THEN("It is changed") { REQUIRE(algo.maxCellSize() == 4); }
+    }
+    WHEN("I set a max cell size which is not a power of 2") {
+      THEN("It throws") {
+        REQUIRE_THROWS_AS(algo.setMaxCellSize(3), std::invalid_argument);
+        REQUIRE_THROWS_AS(algo.setMaxCellSize(0), std::invalid_argument);
+        REQUIRE(algo.maxCellSize() == 16);
+      }
+    }
+  }
+}
+
+} // namespace marchingcubes::tests
@@ -0,0 +1,116 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/BrickedTensor3D.hpp"
+
+#include "marching-cubes/MarchingCubes.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <catch2/catch.hpp>
+
+namespace marchingcubes::tests {
+
+template <typename TTriangles> static TTriangles sorted(TTriangles triangles) {
+  std::sort(triangles.begin(), triangles.end());
+  return triangles;
+}
+
+SCENARIO("BasicBrickedTensor3D") {
+  GIVEN("A tensor whose values are equal to the X index") {
+    const size_t xSize = 10;
+    const size_t ySize = 5;
+    const size_t zSize = 4;
+    std::vector<std::int16_t> values(xSize * ySize * zSize);
+    for (size_t i = 0; i < values.size(); ++i) {
+      values[i] = static_cast<std::int16_t>(i % xSize);
+    }
+    const Tensor3DInt16 tensor{xSize, ySize, zSize, std::move(values)};
+    WHEN("I store it in bricks of 4 cubes") {
+      const BrickedTensor3DInt16 bricked{tensor, 4};
+      THEN("The bricks cover the cubes of the tensor") {
+        // 9 x 4 x 3 cubes
+        REQUIRE(bricked.brickCount(X) == 3);
+        REQUIRE(bricked.brickCount(Y) == 1);
+        REQUIRE(bricked.brickCount(Z) == 1);
+        const auto box = bricked.brickBox(2, 0, 0);
+        REQUIRE(box.begin == std::array<size_t, DIM_COUNT>{{8, 0, 0}});
+        REQUIRE(box.end == std::array<size_t, DIM_COUNT>{{10, 5, 4}});
+      }
+      THEN("The bricks share the values of their borders") {
+        for (size_t z = 0; z < zSize; ++z) {
+          for (size_t y = 0; y < ySize; ++y) {
+            for (size_t x = 0; x < xSize; ++x) {
+              REQUIRE(bricked.value(x, y, z) == tensor.value(x, y, z));
+            }
+          }
+        }
+        REQUIRE(bricked.brickValues(0, 0, 0)[4] == 4);
+        REQUIRE(bricked.brickValues(1, 0, 0)[0] == 4);
+        REQUIRE(bricked.brickMinMax(0, 0, 0) == std::make_pair(0.0, 4.0));
+        REQUIRE(bricked.brickMinMax(2, 0, 0) == std::make_pair(8.0, 9.0));
+      }
+      THEN("Only the bricks containing the iso value are intersecting") {
+        REQUIRE(bricked.mayIntersect(0, 0, 0, 4.0));
+        REQUIRE(!bricked.mayIntersect(0, 0, 0, 4.5));
+        REQUIRE(bricked.mayIntersect(1, 0, 0, 4.5));
+        REQUIRE(!bricked.mayIntersect(2, 0, 0, 8.0));
+      }
+    }
+  }
+  GIVEN("A sphere tensor 3D stored in bricks") {
+    Grid3D grid{equidistantPoints(-7.0, 7.0, 15),
+                equidistantPoints(-5.0, 5.0, 11),
+                equidistantPoints(-9.0, 9.0, 19)};
+    const auto sphere = createSphere(grid);
+    const MarchingCubes algo;
+    const auto expected = sorted(algo.isoSurface(grid, sphere, 40.5));
+    REQUIRE(!expected.empty());
+    WHEN("I calculate its iso-surface brick by brick") {
+      THEN("It has the triangles of the iso-surface of the tensor") {
+        for (size_t brickSize : {1, 3, 4, 16}) {
+          INFO("Brick size: " + std::to_string(brickSize));
+          const BrickedTensor3D bricked{sphere, brickSize};
+          REQUIRE(sorted(algo.isoSurface(grid, bricked, 40.5)) == expected);
+          REQUIRE(sorted(algo.isoSurface<float>(grid, bricked, 40.5)) ==
+                  sorted(algo.isoSurface<float>(grid, sphere, 40.5)));
+        }
+      }
+      THEN("It does not depend on the thread count") {
+        const BrickedTensor3D bricked{sphere, 4};
+        const auto triangles = algo.isoSurface(grid, bricked, 40.5);
+        for (std::size_t threadCount : {2, 3, 30}) {
+          INFO("Thread count: " + std::to_string(threadCount));
+          REQUIRE(MarchingCubes{threadCount}.isoSurface(grid, bricked, 40.5) ==
+                  triangles);
+        }
+      }
+    }
+    WHEN("I calculate its iso-surface on a non-uniform grid") {
+      auto yValues = grid.values[Y];
+      for (auto &coordinate : yValues) {
+        coordinate *= std::abs(coordinate);
+      }
+      const Grid3D nonUniformGrid{grid.values[X], yValues, grid.values[Z]};
+      const BrickedTensor3D bricked{sphere, 4};
+      THEN("It has the triangles of the iso-surface of the tensor") {
+        REQUIRE(sorted(algo.isoSurface(nonUniformGrid, bricked, 40.5)) ==
+                sorted(algo.isoSurface(nonUniformGrid, sphere, 40.5)));
+      }
+    }
+    WHEN("I calculate an iso-surface outside of the values") {
+      const BrickedTensor3D bricked{sphere, 4};
+      THEN("It is empty") {
+        REQUIRE(algo.isoSurface(grid, bricked, -1.0).empty());
+      }
+    }
+  }
+}
+
+} // namespace marchingcubes::tests
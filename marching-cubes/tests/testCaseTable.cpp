@@ -0,0 +1,68 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/CaseTable.hpp"
+
+#include "marching-cubes/ConfigsGenerator.hpp"
+
+#include <catch2/catch.hpp>
+
+namespace marchingcubes::tests {
+
+using namespace casetable;
+
+static_assert(CASE_TABLE.triangleCounts[0] == 0);
+static_assert(CASE_TABLE.triangleCounts[255] == 0);
+static_assert(CASE_TABLE.triangleCounts[0b00000001] == 1);
+static_assert(CASE_TABLE.edges[0b00000001][0] == cube::e01);
+
+SCENARIO("CaseTable") {
+  GIVEN("The case table generated at compile time") {
+    WHEN("I compare it with the configurations of ConfigsGenerator") {
+      const auto configs = ConfigsGenerator{BaseConfigs{}}.generateConfigs();
+      THEN("Each configuration has the same triangles") {
+        for (size_t iConfig = 0; iConfig < CONFIG_COUNT; ++iConfig) {
+          INFO("Config #" + std::to_string(iConfig));
+          const auto &triangles = configs.triangles[iConfig];
+          REQUIRE(CASE_TABLE.triangleCounts[iConfig] == triangles.size());
+          for (size_t iTriangle = 0; iTriangle < triangles.size();
+               ++iTriangle) {
+            for (size_t i = 0; i < triangle::POINT_COUNT; ++i) {
+              REQUIRE(CASE_TABLE.edges[iConfig]
+                                      [iTriangle * triangle::POINT_COUNT + i] ==
+                      triangles[iTriangle][i]);
+            }
+          }
+        }
+      }
+    }
+    WHEN("I retrieve the allowed permutations") {
+      const auto permutations = allowedPermutations();
+      THEN("They are the 48 distinct symmetries of the cube") {
+        for (size_t i = 0; i < permutations.size(); ++i) {
+          for (size_t j = 0; j < i; ++j) {
+            REQUIRE(permutations[i] != permutations[j]);
+          }
+          for (size_t iEdge = 0; iEdge < cube::EDGE_COUNT; ++iEdge) {
+            const auto &vertices = EDGE_VERTICES[iEdge];
+            const auto edge = permutedEdge(static_cast<cube::Edge>(iEdge),
+                                           permutations[i]);
+            const auto &permutedVertices =
+                EDGE_VERTICES[static_cast<size_t>(edge)];
+            const auto start = permutations[i][vertices[0]];
+            const auto end = permutations[i][vertices[1]];
+            REQUIRE(std::min(start, end) == permutedVertices[0]);
+            REQUIRE(std::max(start, end) == permutedVertices[1]);
+          }
+        }
+      }
+    }
+  }
+}
+
+} // namespace marchingcubes::tests
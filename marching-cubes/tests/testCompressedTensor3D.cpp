@@ -0,0 +1,147 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/CompressedTensor3D.hpp"
+
+#include "marching-cubes/MarchingCubes.hpp"
+
+#include <limits>
+#include <random>
+
+#include <catch2/catch.hpp>
+
+namespace marchingcubes::tests {
+
+template <typename TValue>
+static void requireSameValues(const BasicCompressedTensor3D<TValue> &actual,
+                              const BasicTensor3D<TValue> &expected) {
+  for (size_t z = 0; z < expected.size(Z); ++z) {
+    for (size_t y = 0; y < expected.size(Y); ++y) {
+      for (size_t x = 0; x < expected.size(X); ++x) {
+        REQUIRE(actual.value(x, y, z) == expected.value(x, y, z));
+      }
+    }
+  }
+}
+
+SCENARIO("BasicCompressedTensor3D") {
+  GIVEN("A tensor of random 16-bit values") {
+    const size_t xSize = 11;
+    const size_t ySize = 6;
+    const size_t zSize = 5;
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> distribution{
+        std::numeric_limits<std::int16_t>::min(),
+        std::numeric_limits<std::int16_t>::max()};
+    std::vector<std::int16_t> values(xSize * ySize * zSize);
+    for (auto &value : values) {
+      value = static_cast<std::int16_t>(distribution(generator));
+    }
+    const Tensor3DInt16 tensor{xSize, ySize, zSize, std::move(values)};
+    WHEN("I compress it") {
+      const CompressedTensor3DInt16 compressed{tensor, 4};
+      THEN("Its values are the values of the tensor") {
+        REQUIRE(compressed.brickCount(X) == 3);
+        REQUIRE(compressed.brickCount(Y) == 2);
+        REQUIRE(compressed.brickCount(Z) == 1);
+        requireSameValues(compressed, tensor);
+      }
+      THEN("Its bricks are decompressed like the bricks of a bricked tensor") {
+        const BrickedTensor3DInt16 bricked{tensor, 4};
+        std::vector<std::int16_t> brickValues(
+            compressed.layout().brickValueCount());
+        for (size_t by = 0; by < compressed.brickCount(Y); ++by) {
+          for (size_t bx = 0; bx < compressed.brickCount(X); ++bx) {
+            compressed.decompressBrick(bx, by, 0, brickValues.data());
+            const auto box = compressed.brickBox(bx, by, 0);
+            const auto rowSize = compressed.layout().rowSize();
+            for (size_t z = 0; z < box.size(Z); ++z) {
+              for (size_t y = 0; y < box.size(Y); ++y) {
+                for (size_t x = 0; x < box.size(X); ++x) {
+                  const auto index = x + rowSize * (y + rowSize * z);
+                  REQUIRE(brickValues[index] ==
+                          bricked.brickValues(bx, by, 0)[index]);
+                }
+              }
+            }
+            REQUIRE(compressed.brickMinMax(bx, by, 0) ==
+                    bricked.brickMinMax(bx, by, 0));
+          }
+        }
+      }
+    }
+  }
+  GIVEN("A tensor of 8-bit values that is constant in a half") {
+    const size_t size = 17;
+    std::vector<std::uint8_t> values(size * size * size);
+    for (size_t i = 0; i < values.size(); ++i) {
+      const auto x = i % size;
+      values[i] = x <= 8 ? 7 : static_cast<std::uint8_t>(i * 31 % 256);
+    }
+    const Tensor3DUint8 tensor{size, size, size, std::move(values)};
+    WHEN("I compress it") {
+      const CompressedTensor3DUint8 compressed{tensor, 8};
+      THEN("The bricks of the constant half are constant") {
+        REQUIRE(compressed.isConstant(0, 1, 1));
+        REQUIRE(!compressed.isConstant(1, 1, 1));
+        REQUIRE(compressed.brickMinMax(0, 1, 1) == std::make_pair(7.0, 7.0));
+        REQUIRE(!compressed.mayIntersect(0, 1, 1, 7.0));
+        requireSameValues(compressed, tensor);
+      }
+    }
+  }
+  GIVEN("A tensor whose values are equal to the Z index") {
+    const size_t size = 9;
+    std::vector<std::uint16_t> values(size * size * size);
+    for (size_t i = 0; i < values.size(); ++i) {
+      values[i] = static_cast<std::uint16_t>(i / (size * size));
+    }
+    const Tensor3DUint16 tensor{size, size, size, std::move(values)};
+    WHEN("I compress it") {
+      const CompressedTensor3DUint16 compressed{tensor};
+      THEN("Its rows are predicted exactly from the previous rows") {
+        REQUIRE(!compressed.isConstant(0, 0, 0));
+        requireSameValues(compressed, tensor);
+        REQUIRE(10 * compressed.byteCount() <
+                tensor.allValues().size() * sizeof(std::uint16_t));
+      }
+    }
+  }
+  GIVEN("A sphere tensor 3D of 16-bit values") {
+    Grid3D grid{equidistantPoints(-7.0, 7.0, 57),
+                equidistantPoints(-5.0, 5.0, 41),
+                equidistantPoints(-9.0, 9.0, 73)};
+    const auto sphere = createSphere(grid);
+    std::vector<std::uint16_t> values;
+    for (auto value : sphere.allValues()) {
+      values.push_back(static_cast<std::uint16_t>(100.0 * value));
+    }
+    const Tensor3DUint16 tensor{sphere.size(X), sphere.size(Y),
+                                sphere.size(Z), std::move(values)};
+    WHEN("I compress it") {
+      const CompressedTensor3DUint16 compressed{tensor, 4};
+      THEN("Its values take less memory than the values of the tensor") {
+        requireSameValues(compressed, tensor);
+        const CompressedTensor3DUint16 compressed16{tensor};
+        REQUIRE(3 * compressed16.byteCount() <
+                tensor.allValues().size() * sizeof(std::uint16_t));
+      }
+      THEN("Its iso-surface is the iso-surface of the bricked tensor") {
+        const BrickedTensor3DUint16 bricked{tensor, 4};
+        const MarchingCubes algo;
+        const auto expected = algo.isoSurface(grid, bricked, 4050.0);
+        REQUIRE(!expected.empty());
+        REQUIRE(algo.isoSurface(grid, compressed, 4050.0) == expected);
+        REQUIRE(MarchingCubes{3}.isoSurface(grid, compressed, 4050.0) ==
+                expected);
+      }
+    }
+  }
+}
+
+} // namespace marchingcubes::tests
@@ -0,0 +1,91 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/IncrementalMarchingCubes.hpp"
+
+#include "marching-cubes/MarchingCubes.hpp"
+#include "marching-cubes/Tensor3D.hpp"
+#include "marching-cubes/tests/testTools.hpp"
+
+#include <catch2/catch.hpp>
+
+namespace marchingcubes::tests {
+
+SCENARIO("IncrementalMarchingCubes") {
+  GIVEN("A sphere tensor 3D") {
+    Grid3D grid{equidistantPoints(-7.0, 7.0, 15),
+                equidistantPoints(-5.0, 5.0, 11),
+                equidistantPoints(-9.0, 9.0, 19)};
+    auto sphere = createSphere(grid);
+    const std::vector<double> isoValues{40.5, 41.0, 39.25, 40.5, 60.0,
+                                        9.0,  100.0, 200.0, 40.5};
+    WHEN("I move the isovalue") {
+      IncrementalMarchingCubes<double> incremental{grid, sphere};
+      THEN("The triangles are the ones of isoSurface, in order") {
+        for (const auto isoValue : isoValues) {
+          REQUIRE(incremental.isoSurface(isoValue) ==
+                  MarchingCubes{}.isoSurface(grid, sphere, isoValue));
+        }
+      }
+      THEN("Only the cubes around the vertices that change side are updated") {
+        incremental.isoSurface(40.5);
+        REQUIRE(incremental.updatedCubeCount() == 14 * 10 * 18);
+        incremental.isoSurface(41.5);
+        REQUIRE(incremental.updatedCubeCount() > 0);
+        REQUIRE(incremental.updatedCubeCount() < 14 * 10 * 18 / 4);
+        incremental.isoSurface(41.5);
+        REQUIRE(incremental.updatedCubeCount() == 0);
+      }
+    }
+    WHEN("I move the isovalue with normals") {
+      IncrementalMarchingCubes<double> incremental{grid, sphere};
+      THEN("The normals are the ones of isoSurfaceWithNormals") {
+        for (const auto isoValue : isoValues) {
+          std::vector<TriangleNormals> normals;
+          std::vector<TriangleNormals> expectedNormals;
+          REQUIRE(incremental.isoSurfaceWithNormals(isoValue, normals) ==
+                  MarchingCubes{}.isoSurfaceWithNormals(grid, sphere, isoValue,
+                                                        expectedNormals));
+          REQUIRE(normals == expectedNormals);
+        }
+      }
+    }
+    WHEN("I move the isovalue on a non-uniform grid") {
+      Grid3D explicitGrid{std::vector<double>{-7.0, -6.5, -4.0, -3.9, -1.0,
+                                              0.0,  0.5,  1.0,  3.0,  3.5,
+                                              4.0,  5.0,  5.5,  6.5,  7.0},
+                          grid.values[Y], grid.values[Z]};
+      IncrementalMarchingCubes<double> incremental{explicitGrid, sphere};
+      THEN("The triangles are the ones of isoSurface") {
+        for (const auto isoValue : isoValues) {
+          REQUIRE(incremental.isoSurface(isoValue) ==
+                  MarchingCubes{}.isoSurface(explicitGrid, sphere, isoValue));
+        }
+      }
+    }
+    WHEN("I move the isovalue on integer tensors") {
+      const auto uint16Sphere = convertedTensor<std::uint16_t>(sphere);
+      const auto int16Sphere = convertedTensor<std::int16_t>(sphere, -50.0);
+      IncrementalMarchingCubes<std::uint16_t> uint16Incremental{grid,
+                                                                uint16Sphere};
+      IncrementalMarchingCubes<std::int16_t> int16Incremental{grid,
+                                                              int16Sphere};
+      THEN("The triangles are the ones of isoSurface") {
+        for (const auto isoValue : isoValues) {
+          REQUIRE(uint16Incremental.isoSurface(isoValue) ==
+                  MarchingCubes{}.isoSurface(grid, uint16Sphere, isoValue));
+          REQUIRE(int16Incremental.isoSurface(isoValue - 50.0) ==
+                  MarchingCubes{}.isoSurface(grid, int16Sphere,
+                                             isoValue - 50.0));
+        }
+      }
+    }
+  }
+}
+
+} // namespace marchingcubes::tests
@@ -0,0 +1,137 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/IsoSurfaceCache.hpp"
+
+#include "marching-cubes/MarchingCubes.hpp"
+
+#include <memory>
+
+#include <catch2/catch.hpp>
+
+namespace marchingcubes::tests {
+
+/*!
+ * Returns a surface of triangleCount triangles with normals.
+ */
+static std::shared_ptr<const TrianglesWithNormals>
+createSurface(std::size_t triangleCount) {
+  auto surface = std::make_shared<TrianglesWithNormals>();
+  surface->triangles.resize(triangleCount);
+  surface->normals.resize(triangleCount);
+  return surface;
+}
+
+SCENARIO("IsoSurfaceCache") {
+  GIVEN("A cache whose budget holds 3 surfaces of 10 triangles") {
+    const auto surfaceByteSize =
+        IsoSurfaceCache::byteSizeOf(*createSurface(10));
+    REQUIRE(surfaceByteSize ==
+            10 * (sizeof(Triangle3D) + sizeof(TriangleNormals)));
+    IsoSurfaceCache cache{3 * surfaceByteSize};
+    const int tensor = 0;
+    const auto keyOf = [&tensor](double isoValue) {
+      return IsoSurfaceKey{&tensor, isoValue, {{{0, 0, 0}}, {{4, 4, 4}}},
+                           true, 0};
+    };
+    const auto surface1 = createSurface(10);
+    const auto surface2 = createSurface(10);
+    const auto surface3 = createSurface(10);
+    cache.insert(keyOf(1.0), surface1);
+    cache.insert(keyOf(2.0), surface2);
+    cache.insert(keyOf(3.0), surface3);
+    REQUIRE(cache.size() == 3);
+    REQUIRE(cache.byteSize() == 3 * surfaceByteSize);
+    WHEN("I look for the surfaces") {
+      THEN("The surfaces inserted are found, and the others are not") {
+        REQUIRE(cache.find(keyOf(1.0)) == surface1);
+        REQUIRE(cache.find(keyOf(2.0)) == surface2);
+        REQUIRE(cache.find(keyOf(3.0)) == surface3);
+        REQUIRE(cache.find(keyOf(4.0)) == nullptr);
+        auto key = keyOf(1.0);
+        key.withNormals = false;
+        REQUIRE(cache.find(key) == nullptr);
+        key = keyOf(1.0);
+        key.region.end[Z] = 3;
+        REQUIRE(cache.find(key) == nullptr);
+        key = keyOf(1.0);
+        key.decimatedTriangleCount = 5;
+        REQUIRE(cache.find(key) == nullptr);
+      }
+    }
+    WHEN("I use the first surface, and insert a fourth one") {
+      REQUIRE(cache.find(keyOf(1.0)) == surface1);
+      cache.insert(keyOf(4.0), createSurface(10));
+      THEN("The least recently used surface is evicted") {
+        REQUIRE(cache.size() == 3);
+        REQUIRE(cache.byteSize() == 3 * surfaceByteSize);
+        REQUIRE(cache.find(keyOf(2.0)) == nullptr);
+        REQUIRE(cache.find(keyOf(1.0)) == surface1);
+        REQUIRE(cache.find(keyOf(3.0)) == surface3);
+        REQUIRE(cache.find(keyOf(4.0)) != nullptr);
+      }
+    }
+    WHEN("I insert a surface twice as large") {
+      cache.insert(keyOf(4.0), createSurface(20));
+      THEN("The 2 least recently used surfaces are evicted") {
+        REQUIRE(cache.size() == 2);
+        REQUIRE(cache.find(keyOf(1.0)) == nullptr);
+        REQUIRE(cache.find(keyOf(2.0)) == nullptr);
+        REQUIRE(cache.find(keyOf(3.0)) == surface3);
+      }
+    }
+    WHEN("I replace a surface") {
+      const auto surface = createSurface(5);
+      cache.insert(keyOf(2.0), surface);
+      THEN("The new surface is found, and the memory is updated") {
+        REQUIRE(cache.size() == 3);
+        REQUIRE(cache.find(keyOf(2.0)) == surface);
+        REQUIRE(cache.byteSize() == 5 * surfaceByteSize / 2);
+      }
+    }
+    WHEN("I insert a surface larger than the budget") {
+      cache.insert(keyOf(4.0), createSurface(40));
+      THEN("It is not kept, and the other surfaces are") {
+        REQUIRE(cache.find(keyOf(4.0)) == nullptr);
+        REQUIRE(cache.size() == 3);
+      }
+    }
+    WHEN("I reduce the budget") {
+      cache.setByteBudget(surfaceByteSize);
+      THEN("Only the most recently used surface is kept") {
+        REQUIRE(cache.size() == 1);
+        REQUIRE(cache.byteSize() == surfaceByteSize);
+        REQUIRE(cache.find(keyOf(3.0)) == surface3);
+      }
+    }
+    WHEN("I erase the surfaces of another tensor") {
+      const int otherTensor = 0;
+      auto key = keyOf(1.0);
+      key.tensor = &otherTensor;
+      cache.insert(key, createSurface(1));
+      cache.erase(&otherTensor);
+      THEN("Only the surfaces of this tensor are kept") {
+        REQUIRE(cache.size() == 2);
+        REQUIRE(cache.find(key) == nullptr);
+        REQUIRE(cache.find(keyOf(1.0)) == nullptr);
+        REQUIRE(cache.find(keyOf(2.0)) == surface2);
+        REQUIRE(cache.find(keyOf(3.0)) == surface3);
+      }
+    }
+    WHEN("I clear the cache") {
+      cache.clear();
+      THEN("It is empty") {
+        REQUIRE(cache.size() == 0);
+        REQUIRE(cache.byteSize() == 0);
+        REQUIRE(cache.find(keyOf(1.0)) == nullptr);
+      }
+    }
+  }
+}
+
+} // namespace marchingcubes::tests
@@ -0,0 +1,108 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/IsoSurfaceJob.hpp"
+
+#include "marching-cubes/MarchingCubes.hpp"
+#include "marching-cubes/Tensor3D.hpp"
+
+#include <memory>
+
+#include <catch2/catch.hpp>
+
+namespace marchingcubes::tests {
+
+SCENARIO("IsoSurfaceJob") {
+  GIVEN("A sphere") {
+    Grid3D grid{equidistantPoints(-10.0, 10.0, 41),
+                equidistantPoints(-10.0, 10.0, 41),
+                equidistantPoints(-10.0, 10.0, 41)};
+    const auto sphere = createSphere(grid);
+    MarchingCubes algo;
+    const auto expected = algo.isoSurface(grid, sphere, 49.0);
+    for (const auto allocation :
+         {TriangleAllocation::Growing, TriangleAllocation::CountThenFill}) {
+      for (const std::size_t threadCount : {1, 4}) {
+        algo.setTriangleAllocation(allocation);
+        algo.setThreadCount(threadCount);
+        WHEN("I calculate the isosurface asynchronously with " +
+             std::to_string(threadCount) + " threads") {
+          auto job = algo.isoSurfaceAsync(grid, sphere, 49.0);
+          const auto triangles = job.get();
+          THEN("It is the isosurface, and the job is done") {
+            REQUIRE(triangles == expected);
+            REQUIRE(job.progress() == 1.0);
+            REQUIRE(!job.isCancelled());
+          }
+        }
+        WHEN("I calculate it with normals asynchronously with " +
+             std::to_string(threadCount) + " threads") {
+          auto job = algo.isoSurfaceWithNormalsAsync(grid, sphere, 49.0);
+          const auto surface = job.get();
+          THEN("It is the isosurface with a normal per triangle") {
+            std::vector<TriangleNormals> expectedNormals;
+            REQUIRE(surface.triangles ==
+                    algo.isoSurfaceWithNormals(grid, sphere, 49.0,
+                                               expectedNormals));
+            REQUIRE(surface.normals == expectedNormals);
+            REQUIRE(job.progress() == 1.0);
+          }
+        }
+        WHEN("I cancel the token before the calculation with " +
+             std::to_string(threadCount) + " threads") {
+          auto token = std::make_shared<CancellationToken>();
+          token->cancel();
+          auto job = algo.isoSurfaceAsync(grid, sphere, 49.0, token);
+          THEN("The job throws IsoSurfaceCancelled") {
+            REQUIRE(job.isCancelled());
+            REQUIRE_THROWS_AS(job.get(), IsoSurfaceCancelled);
+            REQUIRE(job.progress() < 1.0);
+          }
+        }
+        WHEN("I cancel the job while it runs with " +
+             std::to_string(threadCount) + " threads") {
+          auto job = algo.isoSurfaceWithNormalsAsync(grid, sphere, 49.0);
+          job.cancel();
+          THEN("The job throws IsoSurfaceCancelled, unless it was done") {
+            try {
+              const auto surface = job.get();
+              REQUIRE(job.progress() == 1.0);
+            } catch (const IsoSurfaceCancelled &) {
+              REQUIRE(job.progress() < 1.0);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("IsoSurfaceProgress") {
+  GIVEN("A progress with a token") {
+    auto token = std::make_shared<CancellationToken>();
+    IsoSurfaceProgress progress{token};
+    REQUIRE(progress.fraction() == 0.0);
+    progress.start(4);
+    WHEN("I finish rows") {
+      progress.finishRow();
+      progress.finishRow();
+      THEN("The fraction of rows done is reported") {
+        REQUIRE(progress.fraction() == 0.5);
+      }
+    }
+    WHEN("I cancel the token") {
+      token->cancel();
+      THEN("The next row throws IsoSurfaceCancelled") {
+        REQUIRE_THROWS_AS(progress.finishRow(), IsoSurfaceCancelled);
+        REQUIRE(progress.fraction() == 0.0);
+      }
+    }
+  }
+}
+
+} // namespace marchingcubes::tests
@@ -11,10 +11,14 @@
 #include "marching-cubes/Cube.hpp"
 #include "marching-cubes/Tensor3D.hpp"
 #include "marching-cubes/tests/expectedIsoSurfaces.hpp"
+#include "marching-cubes/tests/testTools.hpp"
 #include "third-parties/catch-main/CatchApprox.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 
 namespace marchingcubes::tests {
 
@@ -211,4 +215,709 @@ SCENARIO("isoSurface sphere" /*, "[!hide]" */) {
   }
 }
 
+SCENARIO("isoSurface on rows longer than a word of signs") {
+  GIVEN("A tensor 3D of 131 x 3 x 3 values") {
+    Grid3D grid{equidistantPoints(0.0, 130.0, 131),
+                equidistantPoints(0.0, 2.0, 3), equidistantPoints(0.0, 2.0, 3)};
+    std::vector<double> values(131 * 3 * 3);
+    for (size_t i = 0; i < values.size(); ++i) {
+      values[i] = static_cast<double>((i * 7) % 11);
+    }
+    Tensor3D tensor{131, 3, 3, values};
+    WHEN("I calculate an iso-surface") {
+      auto isoSurface = algo.isoSurface(grid, tensor, 5.0);
+      THEN("The triangles are the ones of each cube, in Z, Y, X order") {
+        std::vector<Triangle3D> expected;
+        for (size_t z = 0; z + 1 < 3; ++z) {
+          for (size_t y = 0; y + 1 < 3; ++y) {
+            for (size_t x = 0; x + 1 < 131; ++x) {
+              Grid3D cubeGrid{{{grid.values[X][x], grid.values[X][x + 1]}},
+                              {{grid.values[Y][y], grid.values[Y][y + 1]}},
+                              {{grid.values[Z][z], grid.values[Z][z + 1]}}};
+              std::vector<double> cubeValues;
+              for (size_t dz = 0; dz < 2; ++dz) {
+                for (size_t dy = 0; dy < 2; ++dy) {
+                  for (size_t dx = 0; dx < 2; ++dx) {
+                    cubeValues.push_back(tensor.value(x + dx, y + dy, z + dz));
+                  }
+                }
+              }
+              auto cubeTriangles = algo.isoSurface(
+                  cubeGrid, Tensor3D{2, 2, 2, cubeValues}, 5.0);
+              expected.insert(expected.end(), cubeTriangles.cbegin(),
+                              cubeTriangles.cend());
+            }
+          }
+        }
+        REQUIRE(!expected.empty());
+        REQUIRE(isoSurface == expected);
+      }
+    }
+  }
+}
+
+SCENARIO("isoSurface with native value types") {
+  GIVEN("A sphere tensor 3D with integer values") {
+    Grid3D grid{equidistantPoints(-7.0, 7.0, 15),
+                equidistantPoints(-5.0, 5.0, 11),
+                equidistantPoints(-9.0, 9.0, 19)};
+    auto sphere = createSphere(grid);
+    const auto uint8Sphere = convertedTensor<std::uint8_t>(sphere);
+    const auto int16Sphere = convertedTensor<std::int16_t>(sphere);
+    const auto uint16Sphere = convertedTensor<std::uint16_t>(sphere);
+    const auto floatSphere = convertedTensor<float>(sphere);
+    WHEN("I calculate iso-surfaces on tensors of other value types") {
+      THEN("They are the same as the ones of the double values") {
+        for (double isoValue : {9.0, 40.5, 100.0}) {
+          INFO("Iso value: " + std::to_string(isoValue));
+          auto expected = algo.isoSurface(grid, sphere, isoValue);
+          REQUIRE(!expected.empty());
+          REQUIRE(algo.isoSurface(grid, uint8Sphere, isoValue) == expected);
+          REQUIRE(algo.isoSurface(grid, int16Sphere, isoValue) == expected);
+          REQUIRE(algo.isoSurface(grid, uint16Sphere, isoValue) == expected);
+          REQUIRE(algo.isoSurface(grid, floatSphere, isoValue) == expected);
+          auto mesh = algo.isoSurfaceMesh(grid, int16Sphere, isoValue);
+          REQUIRE(mesh.toTriangles() == expected);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("isoSurface with float coordinates") {
+  GIVEN("A sphere tensor 3D") {
+    Grid3D grid{equidistantPoints(-7.0, 7.0, 15),
+                equidistantPoints(-5.0, 5.0, 11),
+                equidistantPoints(-9.0, 9.0, 19)};
+    auto sphere = createSphere(grid);
+    WHEN("I calculate iso-surfaces with float coordinates") {
+      THEN("They are the ones of the double coordinates, in float precision") {
+        for (double isoValue : {9.0, 40.5, 100.0}) {
+          INFO("Iso value: " + std::to_string(isoValue));
+          const auto expected = algo.isoSurface(grid, sphere, isoValue);
+          const auto triangles = algo.isoSurface<float>(grid, sphere, isoValue);
+          REQUIRE(triangles.size() == expected.size());
+          for (size_t iTriangle = 0; iTriangle < triangles.size();
+               ++iTriangle) {
+            for (size_t i = 0; i < 3; ++i) {
+              for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+                // A few float ulps of the coordinates, which are below 10.
+                REQUIRE(triangles[iTriangle][i][iDim] ==
+                        Approx(expected[iTriangle][i][iDim]).margin(1e-5));
+              }
+            }
+          }
+        }
+      }
+      THEN("They do not depend on the thread count and the allocation") {
+        const auto triangles = algo.isoSurface<float>(grid, sphere, 40.5);
+        MarchingCubes threadedAlgo{3};
+        REQUIRE(threadedAlgo.isoSurface<float>(grid, sphere, 40.5) ==
+                triangles);
+        threadedAlgo.setTriangleAllocation(TriangleAllocation::CountThenFill);
+        REQUIRE(threadedAlgo.isoSurface<float>(grid, sphere, 40.5) ==
+                triangles);
+      }
+    }
+  }
+}
+
+SCENARIO("isoSurface with several threads") {
+  GIVEN("A sphere tensor 3D") {
+    Grid3D grid{equidistantPoints(-1.0, 1.0, 21),
+                equidistantPoints(-2.0, 2.0, 17),
+                equidistantPoints(-3.0, 3.0, 23)};
+    auto sphere = createSphere(grid);
+    const auto expected = algo.isoSurface(grid, sphere, 4.0);
+    REQUIRE(!expected.empty());
+    WHEN("I calculate the iso-surface with several threads") {
+      for (std::size_t threadCount : {2, 3, 4, 7, 30}) {
+        MarchingCubes threadedAlgo{threadCount};
+        REQUIRE(threadedAlgo.threadCount() == threadCount);
+        INFO("Thread count: " + std::to_string(threadCount));
+        THEN("The triangles are the same as with one thread") {
+          REQUIRE(threadedAlgo.isoSurface(grid, sphere, 4.0) == expected);
+        }
+      }
+    }
+    WHEN("I change the thread count") {
+      MarchingCubes threadedAlgo{};
+      threadedAlgo.setThreadCount(3);
+      THEN("The new thread count is used") {
+        REQUIRE(threadedAlgo.threadCount() == 3);
+        REQUIRE(threadedAlgo.isoSurface(grid, sphere, 4.0) == expected);
+      }
+    }
+    WHEN("I ask for 0 threads") {
+      MarchingCubes threadedAlgo{2};
+      THEN("It throws, and the thread count is not changed") {
+        REQUIRE_THROWS_AS(MarchingCubes{0}, std::invalid_argument);
+        REQUIRE_THROWS_AS(threadedAlgo.setThreadCount(0),
+                          std::invalid_argument);
+        REQUIRE(threadedAlgo.threadCount() == 2);
+      }
+    }
+  }
+}
+
+SCENARIO("isoSurface with a min max hierarchy") {
+  GIVEN("A sphere tensor 3D with a min max hierarchy") {
+    Grid3D grid{equidistantPoints(-1.0, 1.0, 21),
+                equidistantPoints(-2.0, 2.0, 17),
+                equidistantPoints(-3.0, 3.0, 23)};
+    auto sphere = createSphere(grid);
+    std::vector<std::vector<Triangle3D>> expected;
+    std::vector<IndexedMesh> expectedMeshes;
+    const std::vector<double> isoValues{{0.5, 1.0, 4.0, 9.0}};
+    for (auto isoValue : isoValues) {
+      expected.push_back(algo.isoSurface(grid, sphere, isoValue));
+      expectedMeshes.push_back(algo.isoSurfaceMesh(grid, sphere, isoValue));
+    }
+    for (size_t brickSize : {1, 3, 8, 32}) {
+      sphere.buildMinMaxHierarchy(brickSize);
+      REQUIRE(sphere.minMaxHierarchy() != nullptr);
+      WHEN("I calculate iso-surfaces with bricks of " +
+           std::to_string(brickSize) + " cubes") {
+        THEN("The triangles are the same as without hierarchy") {
+          MarchingCubes threadedAlgo{3};
+          for (size_t i = 0; i < isoValues.size(); ++i) {
+            INFO("Iso value: " + std::to_string(isoValues[i]));
+            REQUIRE(algo.isoSurface(grid, sphere, isoValues[i]) ==
+                    expected[i]);
+            REQUIRE(threadedAlgo.isoSurface(grid, sphere, isoValues[i]) ==
+                    expected[i]);
+            auto mesh = algo.isoSurfaceMesh(grid, sphere, isoValues[i]);
+            REQUIRE(mesh.vertices == expectedMeshes[i].vertices);
+            REQUIRE(mesh.triangles == expectedMeshes[i].triangles);
+          }
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("isoSurface with the count then fill allocation") {
+  GIVEN("A sphere tensor 3D") {
+    Grid3D grid{equidistantPoints(-1.0, 1.0, 21),
+                equidistantPoints(-2.0, 2.0, 17),
+                equidistantPoints(-3.0, 3.0, 23)};
+    auto sphere = createSphere(grid);
+    const auto expected = algo.isoSurface(grid, sphere, 4.0);
+    REQUIRE(algo.triangleAllocation() == TriangleAllocation::Growing);
+    WHEN("I calculate the iso-surface by counting the triangles first") {
+      for (std::size_t threadCount : {1, 2, 5}) {
+        INFO("Thread count: " + std::to_string(threadCount));
+        MarchingCubes countingAlgo{threadCount};
+        countingAlgo.setTriangleAllocation(TriangleAllocation::CountThenFill);
+        const auto triangles = countingAlgo.isoSurface(grid, sphere, 4.0);
+        THEN("The triangles are the same, and no memory is wasted") {
+          REQUIRE(triangles == expected);
+          REQUIRE(triangles.capacity() == triangles.size());
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("isoSurfaceMesh") {
+  GIVEN("A sphere tensor 3D") {
+    Grid3D grid{equidistantPoints(-1.0, 1.0, 21),
+                equidistantPoints(-2.0, 2.0, 17),
+                equidistantPoints(-3.0, 3.0, 23)};
+    auto sphere = createSphere(grid);
+    const auto triangles = algo.isoSurface(grid, sphere, 4.0);
+    WHEN("I calculate the iso-surface as an indexed mesh") {
+      const auto mesh = algo.isoSurfaceMesh(grid, sphere, 4.0);
+      THEN("It contains the same triangles as the triangle soup") {
+        REQUIRE(mesh.triangles.size() == triangles.size());
+        REQUIRE(mesh.toTriangles() == triangles);
+      }
+      THEN("Each vertex is stored once") {
+        auto vertices = mesh.vertices;
+        std::sort(vertices.begin(), vertices.end());
+        REQUIRE(std::adjacent_find(vertices.cbegin(), vertices.cend()) ==
+                vertices.cend());
+        // The sphere is closed: each vertex is shared by several triangles.
+        REQUIRE(3 * mesh.triangles.size() >= 4 * mesh.vertices.size());
+      }
+    }
+    WHEN("I calculate the indexed mesh with several threads") {
+      const auto expected = algo.isoSurfaceMesh(grid, sphere, 4.0);
+      for (std::size_t threadCount : {2, 3, 5, 30}) {
+        INFO("Thread count: " + std::to_string(threadCount));
+        MarchingCubes threadedAlgo{threadCount};
+        const auto mesh = threadedAlgo.isoSurfaceMesh(grid, sphere, 4.0);
+        THEN("The mesh is the same as with one thread") {
+          REQUIRE(mesh.vertices == expected.vertices);
+          REQUIRE(mesh.triangles == expected.triangles);
+        }
+      }
+    }
+    WHEN("I calculate the indexed mesh with normals") {
+      const auto expected = algo.isoSurfaceMesh(grid, sphere, 4.0);
+      std::vector<TriangleNormals> expectedNormals;
+      algo.isoSurfaceWithNormals(grid, sphere, 4.0, expectedNormals);
+      for (std::size_t threadCount : {1, 3}) {
+        INFO("Thread count: " + std::to_string(threadCount));
+        const auto mesh = MarchingCubes{threadCount}.isoSurfaceMeshWithNormals(
+            grid, sphere, 4.0);
+        THEN("It is the mesh without normals, with a normal per vertex") {
+          REQUIRE(mesh.vertices == expected.vertices);
+          REQUIRE(mesh.triangles == expected.triangles);
+          REQUIRE(mesh.normals.size() == mesh.vertices.size());
+        }
+        THEN("The normals are the ones of isoSurfaceWithNormals") {
+          REQUIRE(mesh.toTriangleNormals() == expectedNormals);
+        }
+      }
+    }
+    WHEN("I calculate the indexed mesh with normals and a progress") {
+      auto token = std::make_shared<CancellationToken>();
+      IsoSurfaceProgress progress{token};
+      THEN("All the rows are done") {
+        const auto mesh =
+            algo.isoSurfaceMeshWithNormals(grid, sphere, 4.0, progress);
+        REQUIRE(progress.fraction() == 1.0);
+        REQUIRE(mesh.toTriangles() == triangles);
+      }
+      THEN("A cancelled token stops the calculation") {
+        token->cancel();
+        REQUIRE_THROWS_AS(
+            algo.isoSurfaceMeshWithNormals(grid, sphere, 4.0, progress),
+            IsoSurfaceCancelled);
+      }
+    }
+  }
+}
+
+SCENARIO("isoSurface on a uniform grid") {
+  GIVEN("A sphere tensor 3D on a uniform grid") {
+    Grid3D grid{equidistantPoints(-1.0, 1.0, 21),
+                equidistantPoints(-2.0, 2.0, 17),
+                equidistantPoints(-3.0, 3.0, 23)};
+    REQUIRE(grid.uniformGrid() != nullptr);
+    auto sphere = createSphere(grid);
+    WHEN("I calculate the iso-surface on the same grid, with points that are "
+         "not exactly equidistant") {
+      auto perturbed = [](std::vector<double> values) {
+        for (size_t i = 1; i < values.size(); i += 2) {
+          values[i] *= 1.0 + 1e-8;
+        }
+        return values;
+      };
+      Grid3D explicitGrid{perturbed(grid.values[X]),
+                          perturbed(grid.values[Y]),
+                          perturbed(grid.values[Z])};
+      REQUIRE(explicitGrid.uniformGrid() == nullptr);
+      THEN("The triangles are the same as on the uniform grid") {
+        const auto triangles = algo.isoSurface(grid, sphere, 4.0);
+        REQUIRE(!triangles.empty());
+        REQUIRE(triangles ==
+                Catch::approx(algo.isoSurface(explicitGrid, sphere, 4.0)));
+        const auto mesh = algo.isoSurfaceMesh(grid, sphere, 4.0);
+        REQUIRE(mesh.toTriangles() == triangles);
+      }
+    }
+  }
+}
+
+template <typename TValue>
+static Tensor3D copyBox(const BasicTensor3D<TValue> &tensor,
+                        const IndexBox &box) {
+  std::vector<double> values;
+  for (size_t z = box.begin[Z]; z < box.end[Z]; ++z) {
+    for (size_t y = box.begin[Y]; y < box.end[Y]; ++y) {
+      for (size_t x = box.begin[X]; x < box.end[X]; ++x) {
+        values.push_back(static_cast<double>(tensor.value(x, y, z)));
+      }
+    }
+  }
+  return Tensor3D{box.size(X), box.size(Y), box.size(Z), values};
+}
+
+static Grid3D copyBox(const Grid3D &grid, const IndexBox &box) {
+  auto copyRange = [&](size_t iDim) {
+    const auto &values = grid.values[iDim];
+    return std::vector<double>(
+        values.cbegin() + static_cast<long>(box.begin[iDim]),
+        values.cbegin() + static_cast<long>(box.end[iDim]));
+  };
+  return Grid3D{copyRange(X), copyRange(Y), copyRange(Z)};
+}
+
+SCENARIO("isoSurface in an index box") {
+  GIVEN("A sphere tensor 3D and a box of its indices") {
+    Grid3D grid{equidistantPoints(-7.0, 7.0, 15),
+                equidistantPoints(-5.0, 5.0, 11),
+                equidistantPoints(-9.0, 9.0, 19)};
+    auto sphere = createSphere(grid);
+    const IndexBox box{{{3, 2, 4}}, {{11, 9, 15}}};
+    const auto expected =
+        algo.isoSurface(copyBox(grid, box), copyBox(sphere, box), 40.5);
+    REQUIRE(!expected.empty());
+    WHEN("I calculate the iso-surface in the box") {
+      const auto triangles = algo.isoSurface(grid, sphere, 40.5, box);
+      THEN("It is the iso-surface of a copy of the box") {
+        // The origin of the uniform grid of the copy is rounded differently.
+        REQUIRE(triangles == Catch::approx(expected));
+      }
+      THEN("It does not depend on the thread count nor on the allocation") {
+        for (std::size_t threadCount : {2, 3, 30}) {
+          INFO("Thread count: " + std::to_string(threadCount));
+          MarchingCubes threadedAlgo{threadCount};
+          REQUIRE(threadedAlgo.isoSurface(grid, sphere, 40.5, box) ==
+                  triangles);
+          threadedAlgo.setTriangleAllocation(
+              TriangleAllocation::CountThenFill);
+          REQUIRE(threadedAlgo.isoSurface(grid, sphere, 40.5, box) ==
+                  triangles);
+        }
+      }
+    }
+    WHEN("I calculate it on a grid that is not uniform") {
+      auto values = grid.values;
+      values[X][1] -= 0.25;
+      values[Z][7] += 0.25;
+      Grid3D explicitGrid{values[X], values[Y], values[Z]};
+      REQUIRE(explicitGrid.uniformGrid() == nullptr);
+      THEN("It is exactly the iso-surface of a copy of the box") {
+        REQUIRE(algo.isoSurface(explicitGrid, sphere, 40.5, box) ==
+                algo.isoSurface(copyBox(explicitGrid, box),
+                                copyBox(sphere, box), 40.5));
+      }
+      THEN("It is the same in float coordinates") {
+        REQUIRE(algo.isoSurface<float>(explicitGrid, sphere, 40.5, box) ==
+                algo.isoSurface<float>(copyBox(explicitGrid, box),
+                                       copyBox(sphere, box), 40.5));
+      }
+    }
+    WHEN("I calculate it with a min max hierarchy") {
+      sphere.buildMinMaxHierarchy(4);
+      THEN("The hierarchy is only used for the whole tensor") {
+        REQUIRE(algo.isoSurface(grid, sphere, 40.5, box) ==
+                Catch::approx(expected));
+        REQUIRE(algo.isoSurface(grid, sphere, 40.5, sphere.indexBox()) ==
+                algo.isoSurface(grid, sphere, 40.5));
+      }
+    }
+    WHEN("I calculate it in a box of native values") {
+      const auto uint16Sphere = convertedTensor<std::uint16_t>(sphere);
+      THEN("It is the iso-surface of the double values") {
+        REQUIRE(algo.isoSurface(grid, uint16Sphere, 40.5, box) ==
+                algo.isoSurface(grid, sphere, 40.5, box));
+      }
+    }
+    WHEN("I calculate it in boxes without cubes") {
+      THEN("It is empty") {
+        REQUIRE(algo.isoSurface(grid, sphere, 40.5,
+                                IndexBox{{{3, 2, 4}}, {{11, 3, 15}}})
+                    .empty());
+        REQUIRE(algo.isoSurface(grid, sphere, 40.5,
+                                IndexBox{{{5, 2, 4}}, {{5, 9, 15}}})
+                    .empty());
+      }
+    }
+    WHEN("I calculate it in boxes out of the tensor") {
+      THEN("An exception is thrown") {
+        REQUIRE_THROWS_AS(algo.isoSurface(grid, sphere, 40.5,
+                                          IndexBox{{{3, 2, 4}}, {{16, 9, 15}}}),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(algo.isoSurface(grid, sphere, 40.5,
+                                          IndexBox{{{3, 5, 4}}, {{11, 4, 15}}}),
+                          std::invalid_argument);
+      }
+    }
+  }
+}
+
+SCENARIO("isoSurface of a tensor view") {
+  GIVEN("A sphere tensor 3D and its values in other layouts") {
+    Grid3D grid{equidistantPoints(-7.0, 7.0, 15),
+                equidistantPoints(-5.0, 5.0, 11),
+                equidistantPoints(-9.0, 9.0, 19)};
+    const auto sphere = createSphere(grid);
+    const auto xSize = sphere.size(X);
+    const auto ySize = sphere.size(Y);
+    const auto zSize = sphere.size(Z);
+    const auto expected = algo.isoSurface(grid, sphere, 40.5);
+    REQUIRE(!expected.empty());
+    // Z is the fastest axis, then Y, then X.
+    std::vector<double> zFirst(xSize * ySize * zSize);
+    // The rows of X values are padded to 32 values.
+    const size_t pitch = 32;
+    std::vector<std::int16_t> padded(pitch * ySize * zSize, -1);
+    for (size_t z = 0; z < zSize; ++z) {
+      for (size_t y = 0; y < ySize; ++y) {
+        for (size_t x = 0; x < xSize; ++x) {
+          zFirst[z + zSize * (y + ySize * x)] = sphere.value(x, y, z);
+          padded[x + pitch * (y + ySize * z)] =
+              static_cast<std::int16_t>(sphere.value(x, y, z));
+        }
+      }
+    }
+    const std::array<size_t, DIM_COUNT> size{{xSize, ySize, zSize}};
+    WHEN("I calculate the iso-surface of a view of the tensor") {
+      THEN("It is the iso-surface of the tensor") {
+        REQUIRE(algo.isoSurface(grid, Tensor3DView{sphere}, 40.5) ==
+                expected);
+      }
+    }
+    WHEN("I calculate the iso-surface of a view whose fastest axis is Z") {
+      const Tensor3DView view{
+          zFirst.data(),
+          size,
+          {{static_cast<std::ptrdiff_t>(zSize * ySize),
+            static_cast<std::ptrdiff_t>(zSize), 1}}};
+      THEN("It is the iso-surface of the tensor") {
+        REQUIRE(view.value(3, 4, 5) == sphere.value(3, 4, 5));
+        REQUIRE(algo.isoSurface(grid, view, 40.5) == expected);
+        REQUIRE(algo.isoSurface<float>(grid, view, 40.5) ==
+                algo.isoSurface<float>(grid, sphere, 40.5));
+      }
+      THEN("It does not depend on the thread count nor on the allocation") {
+        for (std::size_t threadCount : {2, 3, 30}) {
+          INFO("Thread count: " + std::to_string(threadCount));
+          MarchingCubes threadedAlgo{threadCount};
+          REQUIRE(threadedAlgo.isoSurface(grid, view, 40.5) == expected);
+          threadedAlgo.setTriangleAllocation(
+              TriangleAllocation::CountThenFill);
+          REQUIRE(threadedAlgo.isoSurface(grid, view, 40.5) == expected);
+        }
+      }
+    }
+    WHEN("I calculate the iso-surface of a view of padded rows") {
+      const Tensor3DViewInt16 view{
+          padded.data(),
+          size,
+          {{1, static_cast<std::ptrdiff_t>(pitch),
+            static_cast<std::ptrdiff_t>(pitch * ySize)}}};
+      THEN("It is the iso-surface of the tensor") {
+        REQUIRE(algo.isoSurface(grid, view, 40.5) == expected);
+      }
+    }
+    WHEN("I calculate the iso-surface of a view with a flipped axis") {
+      // A sphere that is not symmetric along Y.
+      Grid3D shiftedGrid{grid.values[X], equidistantPoints(-3.0, 7.0, ySize),
+                         grid.values[Z]};
+      const auto shifted = createSphere(shiftedGrid);
+      // The last Y row first: the value (x, y, z) of the view is the value
+      // (x, ySize - 1 - y, z) of the tensor.
+      const Tensor3DView view{
+          shifted.allValues().data() + shifted.index(0, ySize - 1, 0),
+          size,
+          {{1, -static_cast<std::ptrdiff_t>(xSize),
+            static_cast<std::ptrdiff_t>(xSize * ySize)}}};
+      std::vector<double> flipped;
+      for (size_t z = 0; z < zSize; ++z) {
+        for (size_t y = 0; y < ySize; ++y) {
+          for (size_t x = 0; x < xSize; ++x) {
+            flipped.push_back(shifted.value(x, ySize - 1 - y, z));
+          }
+        }
+      }
+      THEN("It is the iso-surface of the flipped values") {
+        REQUIRE(algo.isoSurface(grid, view, 40.5) ==
+                algo.isoSurface(grid,
+                                Tensor3D{xSize, ySize, zSize, flipped},
+                                40.5));
+      }
+    }
+  }
+}
+
+SCENARIO("isoSurfaces") {
+  GIVEN("A sphere tensor 3D") {
+    Grid3D grid{equidistantPoints(-7.0, 7.0, 15),
+                equidistantPoints(-5.0, 5.0, 11),
+                equidistantPoints(-9.0, 9.0, 19)};
+    auto sphere = createSphere(grid);
+    const std::vector<double> isoValues{{9.0, 40.5, 60.0, 100.0}};
+    std::vector<std::vector<Triangle3D>> expected;
+    for (auto isoValue : isoValues) {
+      expected.push_back(algo.isoSurface(grid, sphere, isoValue));
+      REQUIRE(!expected.back().empty());
+    }
+    WHEN("I calculate the iso-surfaces of several iso values at once") {
+      THEN("They are the iso-surfaces of each iso value") {
+        REQUIRE(algo.isoSurfaces(grid, sphere, isoValues) == expected);
+        REQUIRE(algo.isoSurfaces(grid, sphere, {}).empty());
+      }
+      THEN("They do not depend on the thread count") {
+        for (std::size_t threadCount : {2, 3, 30}) {
+          INFO("Thread count: " + std::to_string(threadCount));
+          MarchingCubes threadedAlgo{threadCount};
+          REQUIRE(threadedAlgo.isoSurfaces(grid, sphere, isoValues) ==
+                  expected);
+        }
+      }
+    }
+    WHEN("I calculate them with a min max hierarchy") {
+      sphere.buildMinMaxHierarchy(4);
+      THEN("They are the iso-surfaces of each iso value") {
+        REQUIRE(algo.isoSurfaces(grid, sphere, isoValues) == expected);
+      }
+    }
+  }
+}
+
+SCENARIO("isoSurfaceWithNormals") {
+  GIVEN("A sphere tensor 3D") {
+    Grid3D grid{equidistantPoints(-7.0, 7.0, 15),
+                equidistantPoints(-5.0, 5.0, 11),
+                equidistantPoints(-9.0, 9.0, 19)};
+    auto sphere = createSphere(grid);
+    // The sphere does not reach the cubes on the borders of the grid, where
+    // the gradients are one-sided differences.
+    const double isoValue = 12.0;
+    const auto expected = algo.isoSurface(grid, sphere, isoValue);
+    REQUIRE(!expected.empty());
+    WHEN("I calculate the iso-surface with normals") {
+      std::vector<TriangleNormals> normals;
+      const auto triangles =
+          algo.isoSurfaceWithNormals(grid, sphere, isoValue, normals);
+      THEN("The triangles are the ones of isoSurface") {
+        REQUIRE(triangles == expected);
+        REQUIRE(normals.size() == triangles.size());
+      }
+      THEN("The normals are the radial unit vectors") {
+        // The central differences of x² + y² + z² are exact, and the
+        // gradient 2 * (x, y, z) is linear along the edges.
+        for (size_t iTriangle = 0; iTriangle < triangles.size(); ++iTriangle) {
+          for (size_t i = 0; i < 3; ++i) {
+            const auto &point = triangles[iTriangle][i];
+            const auto norm = std::sqrt(point[X] * point[X] +
+                                        point[Y] * point[Y] +
+                                        point[Z] * point[Z]);
+            for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+              REQUIRE(normals[iTriangle][i][iDim] ==
+                      Approx(point[iDim] / norm).margin(1e-12));
+            }
+          }
+        }
+      }
+      THEN("They do not depend on the thread count") {
+        for (std::size_t threadCount : {2, 3, 30}) {
+          INFO("Thread count: " + std::to_string(threadCount));
+          std::vector<TriangleNormals> threadedNormals;
+          REQUIRE(MarchingCubes{threadCount}.isoSurfaceWithNormals(
+                      grid, sphere, isoValue, threadedNormals) == triangles);
+          REQUIRE(threadedNormals == normals);
+        }
+      }
+    }
+    WHEN("I calculate them on the borders of the grid") {
+      std::vector<TriangleNormals> normals;
+      const auto triangles =
+          algo.isoSurfaceWithNormals(grid, sphere, 40.5, normals);
+      THEN("The normals are unit vectors") {
+        REQUIRE(triangles == algo.isoSurface(grid, sphere, 40.5));
+        for (const auto &triangleNormals : normals) {
+          for (const auto &normal : triangleNormals) {
+            REQUIRE(normal[X] * normal[X] + normal[Y] * normal[Y] +
+                        normal[Z] * normal[Z] ==
+                    Approx(1.0));
+          }
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("isoSurface with a sink") {
+  GIVEN("A sphere tensor 3D") {
+    // Large enough to emit several batches with one thread.
+    Grid3D grid{equidistantPoints(-1.0, 1.0, 41),
+                equidistantPoints(-2.0, 2.0, 37),
+                equidistantPoints(-3.0, 3.0, 43)};
+    auto sphere = createSphere(grid);
+    const auto expected = algo.isoSurface(grid, sphere, 4.0);
+    REQUIRE(expected.size() > 4096);
+    struct TriangleCollector {
+      void emit(const Triangle3D &triangle) { triangles.push_back(triangle); }
+      std::vector<Triangle3D> triangles;
+    };
+    struct BatchCollector {
+      void emitBatch(const Triangle3D *batch, std::size_t count) {
+        triangles.insert(triangles.end(), batch, batch + count);
+        ++batchCount;
+      }
+      std::vector<Triangle3D> triangles;
+      std::size_t batchCount = 0;
+    };
+    WHEN("I pass a sink with emit") {
+      THEN("It receives the triangles of the vector, in order") {
+        for (std::size_t threadCount : {1, 3}) {
+          INFO("Thread count: " + std::to_string(threadCount));
+          TriangleCollector collector;
+          MarchingCubes{threadCount}.isoSurface(grid, sphere, 4.0, collector);
+          REQUIRE(collector.triangles == expected);
+        }
+      }
+    }
+    WHEN("I pass a sink with emitBatch") {
+      THEN("It receives the triangles in several batches, in order") {
+        for (std::size_t threadCount : {1, 3}) {
+          INFO("Thread count: " + std::to_string(threadCount));
+          BatchCollector collector;
+          MarchingCubes{threadCount}.isoSurface(grid, sphere, 4.0, collector);
+          REQUIRE(collector.batchCount > 1);
+          REQUIRE(collector.triangles == expected);
+        }
+      }
+    }
+    WHEN("I pass a TriangleSinkFloat") {
+      struct FloatCollector : TriangleSinkFloat {
+        void emitBatch(const Triangle3DFloat *batch,
+                       std::size_t count) override {
+          triangles.insert(triangles.end(), batch, batch + count);
+        }
+        std::vector<Triangle3DFloat> triangles;
+      };
+      THEN("It receives the triangles of the float vector, in order") {
+        const auto expectedFloat = algo.isoSurface<float>(grid, sphere, 4.0);
+        for (std::size_t threadCount : {1, 3}) {
+          INFO("Thread count: " + std::to_string(threadCount));
+          FloatCollector collector;
+          MarchingCubes{threadCount}.isoSurface(grid, sphere, 4.0, collector);
+          REQUIRE(collector.triangles == expectedFloat);
+        }
+      }
+    }
+    WHEN("I pass a sink and an index box") {
+      const IndexBox box{{{3, 2, 4}}, {{31, 29, 40}}};
+      THEN("It receives the triangles of the vector of the box, in order") {
+        const auto expectedBox = algo.isoSurface(grid, sphere, 4.0, box);
+        REQUIRE(!expectedBox.empty());
+        for (std::size_t threadCount : {1, 3}) {
+          INFO("Thread count: " + std::to_string(threadCount));
+          BatchCollector collector;
+          TriangleSinkAdapter<BatchCollector> adapter{collector};
+          MarchingCubes{threadCount}.isoSurface(grid, sphere, 4.0, box,
+                                                adapter);
+          REQUIRE(collector.triangles == expectedBox);
+        }
+      }
+    }
+    WHEN("I pass a sink and a progress") {
+      auto token = std::make_shared<CancellationToken>();
+      IsoSurfaceProgress progress{token};
+      BatchCollector collector;
+      TriangleSinkAdapter<BatchCollector> adapter{collector};
+      THEN("All the rows are done") {
+        algo.isoSurface(grid, sphere, 4.0, sphere.indexBox(), adapter,
+                        progress);
+        REQUIRE(progress.fraction() == 1.0);
+        REQUIRE(collector.triangles == expected);
+      }
+      THEN("A cancelled token stops the calculation") {
+        token->cancel();
+        REQUIRE_THROWS_AS(algo.isoSurface(grid, sphere, 4.0,
+                                          sphere.indexBox(), adapter,
+                                          progress),
+                          IsoSurfaceCancelled);
+      }
+    }
+  }
+}
+
 } // namespace marchingcubes::tests
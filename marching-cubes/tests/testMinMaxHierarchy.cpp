@@ -0,0 +1,70 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/MinMaxHierarchy.hpp"
+
+#include "marching-cubes/Tensor3D.hpp"
+
+#include <catch2/catch.hpp>
+
+namespace marchingcubes::tests {
+
+using Ranges = std::vector<std::pair<size_t, size_t>>;
+
+SCENARIO("MinMaxHierarchy") {
+  GIVEN("A tensor whose values are equal to the X index") {
+    const size_t xSize = 10;
+    const size_t ySize = 5;
+    const size_t zSize = 4;
+    std::vector<double> values(xSize * ySize * zSize);
+    for (size_t i = 0; i < values.size(); ++i) {
+      values[i] = static_cast<double>(i % xSize);
+    }
+    Tensor3D tensor{xSize, ySize, zSize, std::move(values)};
+    WHEN("I build a hierarchy with bricks of 2 cubes") {
+      MinMaxHierarchy hierarchy{tensor, 2};
+      THEN("The levels are built until one brick remains") {
+        // 9 x 4 x 3 cubes
+        REQUIRE(hierarchy.levelCount() == 4);
+        REQUIRE(hierarchy.brickCount(0, X) == 5);
+        REQUIRE(hierarchy.brickCount(0, Y) == 2);
+        REQUIRE(hierarchy.brickCount(0, Z) == 2);
+        REQUIRE(hierarchy.brickCount(1, X) == 3);
+        REQUIRE(hierarchy.brickCount(2, X) == 2);
+        REQUIRE(hierarchy.brickCount(3, X) == 1);
+        REQUIRE(hierarchy.brickCount(3, Y) == 1);
+      }
+      THEN("The bricks contain the values of their cubes") {
+        REQUIRE(hierarchy.minMax(0, 0, 0, 0) == std::make_pair(0.0, 2.0));
+        REQUIRE(hierarchy.minMax(0, 3, 1, 1) == std::make_pair(6.0, 8.0));
+        REQUIRE(hierarchy.minMax(0, 4, 0, 0) == std::make_pair(8.0, 9.0));
+        REQUIRE(hierarchy.minMax(1, 1, 0, 0) == std::make_pair(4.0, 8.0));
+        REQUIRE(hierarchy.minMax(3, 0, 0, 0) == std::make_pair(0.0, 9.0));
+      }
+      THEN("Only the bricks containing the iso value are intersecting") {
+        REQUIRE(hierarchy.mayIntersect(0, 1, 0, 0, 3.0));
+        REQUIRE(!hierarchy.mayIntersect(0, 1, 0, 0, 2.0));
+        REQUIRE(hierarchy.mayIntersect(0, 1, 0, 0, 4.0));
+        REQUIRE(!hierarchy.mayIntersect(0, 1, 0, 0, 4.5));
+        Ranges xRanges;
+        hierarchy.intersectingXRanges(0, 2, 4.0, xRanges);
+        REQUIRE(xRanges == Ranges{{{2, 4}}});
+        hierarchy.intersectingXRanges(0, 2, 4.5, xRanges);
+        REQUIRE(xRanges == Ranges{{{4, 6}}});
+        hierarchy.intersectingXRanges(1, 1, 5.0, xRanges);
+        REQUIRE(xRanges == Ranges{{{4, 6}}});
+        hierarchy.intersectingXRanges(3, 0, 8.5, xRanges);
+        REQUIRE(xRanges == Ranges{{{8, 9}}});
+        hierarchy.intersectingXRanges(3, 0, 12.0, xRanges);
+        REQUIRE(xRanges.empty());
+      }
+    }
+  }
+}
+
+} // namespace marchingcubes::tests
@@ -0,0 +1,239 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/QuadricDecimation.hpp"
+
+#include "marching-cubes/IsoSurfaceJob.hpp"
+#include "marching-cubes/MarchingCubes.hpp"
+#include "marching-cubes/Tensor3D.hpp"
+#include "marching-cubes/tests/testTools.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <catch2/catch.hpp>
+
+namespace marchingcubes::tests {
+
+static bool isClosed(const IndexedMesh &mesh) {
+  const auto counts = edgeTriangleCounts(mesh);
+  return std::all_of(counts.begin(), counts.end(),
+                     [](const auto &count) { return count.second == 2; });
+}
+
+/*!
+ * Returns the mean distance from the centers of the triangles of mesh to
+ * the sphere of radius centered on the origin.
+ */
+static double meanSphereDistance(const IndexedMesh &mesh, double radius) {
+  double sum = 0.0;
+  for (const auto &triangle : mesh.triangles) {
+    Point3D center{{0.0, 0.0, 0.0}};
+    for (auto vertex : triangle) {
+      for (size_t iDim = 0; iDim < DIM_COUNT; ++iDim) {
+        center[iDim] += mesh.vertices[vertex][iDim] / 3.0;
+      }
+    }
+    sum += std::abs(std::sqrt(center[X] * center[X] + center[Y] * center[Y] +
+                              center[Z] * center[Z]) -
+                    radius);
+  }
+  return sum / static_cast<double>(mesh.triangles.size());
+}
+
+/*!
+ * Returns a square [0, size]^2 of the plane z = 0, split into 2 triangles
+ * per unit square.
+ */
+static IndexedMesh squareMesh(std::uint32_t size) {
+  IndexedMesh mesh;
+  for (std::uint32_t y = 0; y <= size; ++y) {
+    for (std::uint32_t x = 0; x <= size; ++x) {
+      mesh.vertices.push_back(Point3D{{double(x), double(y), 0.0}});
+    }
+  }
+  const auto rowSize = size + 1;
+  for (std::uint32_t y = 0; y < size; ++y) {
+    for (std::uint32_t x = 0; x < size; ++x) {
+      const auto v = x + rowSize * y;
+      mesh.triangles.push_back(IndexedTriangle{{v, v + 1, v + rowSize}});
+      mesh.triangles.push_back(
+          IndexedTriangle{{v + 1, v + rowSize + 1, v + rowSize}});
+    }
+  }
+  return mesh;
+}
+
+SCENARIO("weldTriangles") {
+  GIVEN("The triangles of an isosurface and their normals") {
+    Grid3D grid{equidistantPoints(-7.0, 7.0, 15),
+                equidistantPoints(-5.0, 5.0, 11),
+                equidistantPoints(-9.0, 9.0, 19)};
+    const auto sphere = createSphere(grid);
+    const MarchingCubes algo;
+    std::vector<TriangleNormals> normals;
+    const auto triangles =
+        algo.isoSurfaceWithNormals(grid, sphere, 20.5, normals);
+    WHEN("I weld them") {
+      const auto mesh = weldTriangles(triangles, normals);
+      THEN("The mesh has the triangles, and the vertices of isoSurfaceMesh") {
+        REQUIRE(mesh.toTriangles() == triangles);
+        REQUIRE(mesh.toTriangleNormals() == normals);
+        REQUIRE(mesh.vertices.size() ==
+                algo.isoSurfaceMesh(grid, sphere, 20.5).vertices.size());
+        REQUIRE(isClosed(mesh));
+      }
+    }
+  }
+}
+
+SCENARIO("QuadricDecimation") {
+  GIVEN("A finely triangulated square") {
+    const auto square = squareMesh(8);
+    WHEN("I decimate it without error") {
+      QuadricDecimation decimation;
+      decimation.setMaxError(1e-12);
+      const auto mesh = decimation.decimate(square);
+      THEN("Its triangles are fewer, in the same plane, and cover the square") {
+        REQUIRE(mesh.triangles.size() < square.triangles.size() / 2);
+        double area = 0.0;
+        for (const auto &triangle : mesh.toTriangles()) {
+          for (const auto &point : triangle) {
+            REQUIRE(point[Z] == 0.0);
+          }
+          area += 0.5 * std::abs((triangle[1][X] - triangle[0][X]) *
+                                     (triangle[2][Y] - triangle[0][Y]) -
+                                 (triangle[2][X] - triangle[0][X]) *
+                                     (triangle[1][Y] - triangle[0][Y]));
+        }
+        REQUIRE(area == Approx(64.0));
+      }
+      THEN("Its boundary vertices are kept") {
+        for (const auto &vertex : square.vertices) {
+          if (vertex[X] == 0.0 || vertex[X] == 8.0 || vertex[Y] == 0.0 ||
+              vertex[Y] == 8.0) {
+            REQUIRE(std::count(mesh.vertices.begin(), mesh.vertices.end(),
+                               vertex) == 1);
+          }
+        }
+      }
+    }
+    WHEN("I decimate it with a target triangle count") {
+      QuadricDecimation decimation;
+      decimation.setTargetTriangleCount(100);
+      THEN("It stops at the target") {
+        const auto mesh = decimation.decimate(square);
+        REQUIRE(mesh.triangles.size() <= 100);
+        REQUIRE(mesh.triangles.size() >= 98);
+      }
+    }
+  }
+  GIVEN("The mesh of a sphere isosurface with normals") {
+    Grid3D grid{equidistantPoints(-7.0, 7.0, 29),
+                equidistantPoints(-5.0, 5.0, 21),
+                equidistantPoints(-9.0, 9.0, 37)};
+    const auto sphere = createSphere(grid);
+    const auto mesh =
+        MarchingCubes{}.isoSurfaceMeshWithNormals(grid, sphere, 16.0);
+    for (const size_t threadCount : {1, 3}) {
+      WHEN("I decimate it to a quarter with " << threadCount << " threads") {
+        QuadricDecimation decimation{threadCount};
+        decimation.setTargetTriangleCount(mesh.triangles.size() / 4);
+        const auto decimated = decimation.decimate(mesh);
+        // The grid spacing is 0.5.
+        THEN("It is a closed mesh close to the sphere") {
+          REQUIRE(decimated.triangles.size() <=
+                  mesh.triangles.size() / 4 + mesh.triangles.size() / 20);
+          REQUIRE(isClosed(decimated));
+          REQUIRE(decimated.normals.size() == decimated.vertices.size());
+          for (const auto &vertex : decimated.vertices) {
+            const auto radius =
+                std::sqrt(vertex[X] * vertex[X] + vertex[Y] * vertex[Y] +
+                          vertex[Z] * vertex[Z]);
+            REQUIRE(std::abs(radius - 4.0) < 0.15);
+          }
+        }
+      }
+    }
+    WHEN("I decimate it with a maximal error") {
+      QuadricDecimation decimation{2};
+      decimation.setMaxError(1e-4);
+      const auto decimated = decimation.decimate(mesh);
+      THEN("It is smaller, but less than without maximal error") {
+        decimation.setMaxError(1e-2);
+        const auto coarser = decimation.decimate(mesh);
+        REQUIRE(decimated.triangles.size() < mesh.triangles.size());
+        REQUIRE(coarser.triangles.size() < decimated.triangles.size());
+        REQUIRE(isClosed(coarser));
+      }
+    }
+    WHEN("I decimate it with a cancellation token") {
+      QuadricDecimation decimation{2};
+      decimation.setTargetTriangleCount(mesh.triangles.size() / 4);
+      CancellationToken token;
+      THEN("It is decimated as without token until the token is cancelled") {
+        const auto decimated = decimation.decimate(mesh, token);
+        REQUIRE(decimated.triangles == decimation.decimate(mesh).triangles);
+        token.cancel();
+        REQUIRE_THROWS_AS(decimation.decimate(mesh, token),
+                          IsoSurfaceCancelled);
+      }
+      THEN("A cancelled token stops it before any collapse") {
+        // No edge can be collapsed: only the preparation checks the token.
+        decimation.setMaxError(-1.0);
+        REQUIRE(decimation.decimate(mesh, token).triangles == mesh.triangles);
+        token.cancel();
+        REQUIRE_THROWS_AS(decimation.decimate(mesh, token),
+                          IsoSurfaceCancelled);
+      }
+    }
+  }
+  GIVEN("The mesh of a finer sphere isosurface") {
+    Grid3D grid{equidistantPoints(-7.0, 7.0, 57),
+                equidistantPoints(-5.0, 5.0, 41),
+                equidistantPoints(-9.0, 9.0, 73)};
+    const auto sphere = createSphere(grid);
+    const auto mesh = MarchingCubes{}.isoSurfaceMesh(grid, sphere, 16.0);
+    const auto targetCount = mesh.triangles.size() / 10;
+    QuadricDecimation decimation{1};
+    decimation.setTargetTriangleCount(targetCount);
+    const auto expected = decimation.decimate(mesh);
+    REQUIRE(expected.triangles.size() <= targetCount);
+    REQUIRE(expected.triangles.size() + 10 >= targetCount);
+    for (const size_t threadCount : {2, 3, 4, 8}) {
+      WHEN("I decimate it to a tenth with " << threadCount << " threads") {
+        decimation.setThreadCount(threadCount);
+        const auto decimated = decimation.decimate(mesh);
+        THEN("The seams between the slabs are decimated too, as with one "
+             "thread") {
+          REQUIRE(decimated.triangles.size() <= targetCount);
+          REQUIRE(decimated.triangles.size() + 10 >= targetCount);
+          REQUIRE(isClosed(decimated));
+          REQUIRE(meanSphereDistance(decimated, 4.0) <=
+                  1.25 * meanSphereDistance(expected, 4.0));
+        }
+      }
+    }
+  }
+  GIVEN("An empty mesh") {
+    THEN("It is returned as is") {
+      REQUIRE(QuadricDecimation{}.decimate(IndexedMesh{}).triangles.empty());
+    }
+  }
+  GIVEN("A thread count of 0") {
+    THEN("It throws") {
+      REQUIRE_THROWS_AS(QuadricDecimation{0}, std::invalid_argument);
+      QuadricDecimation decimation{2};
+      REQUIRE_THROWS_AS(decimation.setThreadCount(0), std::invalid_argument);
+      REQUIRE(decimation.threadCount() == 2);
+    }
+  }
+}
+
+} // namespace marchingcubes::tests
@@ -0,0 +1,134 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/RawVolume.hpp"
+
+#include "marching-cubes/MarchingCubes.hpp"
+#include "marching-cubes/Tensor3D.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+#include <catch2/catch.hpp>
+
+namespace marchingcubes::tests {
+
+/*!
+ * \class TemporaryFile
+ * \brief The class TemporaryFile gives the path of a file of the temporary
+ * directory, which is removed at the end of the test.
+ */
+class TemporaryFile {
+
+public:
+  explicit TemporaryFile(const std::string &name)
+      : path{(std::filesystem::temp_directory_path() / name).string()} {}
+  ~TemporaryFile() { std::filesystem::remove(path); }
+
+public:
+  const std::string path;
+};
+
+static Tensor3DInt16 int16Tensor() {
+  std::vector<std::int16_t> values(4 * 3 * 2);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = static_cast<std::int16_t>(1000 - 300 * static_cast<int>(i));
+  }
+  return {4, 3, 2, std::move(values)};
+}
+
+static ByteOrder otherByteOrder() {
+  return nativeByteOrder() == ByteOrder::LittleEndian ? ByteOrder::BigEndian
+                                                      : ByteOrder::LittleEndian;
+}
+
+SCENARIO("Raw volume files") {
+  GIVEN("A tensor of 16-bit integers written to a raw volume file") {
+    const auto tensor = int16Tensor();
+    TemporaryFile file{"testRawVolume.mcv"};
+    writeRawVolume(file.path, tensor);
+    THEN("The header gives the sizes, the scalar type and the byte order") {
+      const auto header = readRawVolumeHeader(file.path);
+      REQUIRE(header.size == std::array<size_t, DIM_COUNT>{{4, 3, 2}});
+      REQUIRE(header.scalarType == ScalarType::Int16);
+      REQUIRE(header.byteOrder == nativeByteOrder());
+      REQUIRE(std::filesystem::file_size(file.path) ==
+              RawVolumeHeader::SIZE + 4 * 3 * 2 * 2);
+    }
+    WHEN("I open it") {
+      const auto opened = openRawVolume<std::int16_t>(file.path);
+      THEN("The values are mapped from the file") {
+        REQUIRE(opened.isMapped());
+        REQUIRE(opened.size(X) == 4);
+        REQUIRE(opened.size(Y) == 3);
+        REQUIRE(opened.size(Z) == 2);
+        REQUIRE(std::equal(opened.allValues().begin(),
+                           opened.allValues().end(),
+                           tensor.allValues().begin()));
+        REQUIRE(opened.value(3, 2, 1) == tensor.value(3, 2, 1));
+        opened.willNeed(0, 2);
+      }
+    }
+    WHEN("I open it with another value type") {
+      THEN("An exception is thrown") {
+        REQUIRE_THROWS_AS(openRawVolume<std::uint16_t>(file.path),
+                          std::invalid_argument);
+      }
+    }
+  }
+  GIVEN("A raw volume file in the other byte order") {
+    const auto tensor = int16Tensor();
+    TemporaryFile file{"testRawVolumeSwapped.mcv"};
+    writeRawVolume(file.path, tensor, otherByteOrder());
+    WHEN("I open it") {
+      const auto opened = openRawVolume<std::int16_t>(file.path);
+      THEN("The values are read and swapped") {
+        REQUIRE(readRawVolumeHeader(file.path).byteOrder == otherByteOrder());
+        REQUIRE(!opened.isMapped());
+        REQUIRE(std::equal(opened.allValues().begin(),
+                           opened.allValues().end(),
+                           tensor.allValues().begin()));
+      }
+    }
+  }
+  GIVEN("A sphere written to a raw volume file") {
+    Grid3D grid{equidistantPoints(-7.0, 7.0, 15),
+                equidistantPoints(-5.0, 5.0, 11),
+                equidistantPoints(-9.0, 9.0, 19)};
+    const auto sphere = createSphere(grid);
+    TemporaryFile file{"testRawVolumeSphere.mcv"};
+    writeRawVolume(file.path, sphere);
+    WHEN("I calculate the isosurface of the mapped tensor") {
+      auto opened = openRawVolume<double>(file.path);
+      opened.buildMinMaxHierarchy(4);
+      THEN("It is the isosurface of the tensor") {
+        const auto expected = MarchingCubes{}.isoSurface(grid, sphere, 40.5);
+        REQUIRE(!expected.empty());
+        REQUIRE(MarchingCubes{}.isoSurface(grid, opened, 40.5) == expected);
+        REQUIRE(MarchingCubes{3}.isoSurface(grid, opened, 40.5) == expected);
+      }
+    }
+  }
+  GIVEN("Invalid raw volume files") {
+    TemporaryFile file{"testRawVolumeInvalid.mcv"};
+    THEN("An exception is thrown") {
+      REQUIRE_THROWS_AS(openRawVolume<double>(file.path), std::system_error);
+      std::ofstream{file.path} << "Not a raw volume file";
+      REQUIRE_THROWS_AS(readRawVolumeHeader(file.path), std::runtime_error);
+      writeRawVolume(file.path, int16Tensor());
+      std::filesystem::resize_file(file.path, RawVolumeHeader::SIZE + 10);
+      REQUIRE_THROWS_AS(openRawVolume<std::int16_t>(file.path),
+                        std::runtime_error);
+    }
+  }
+}
+
+} // namespace marchingcubes::tests
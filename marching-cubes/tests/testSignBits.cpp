@@ -0,0 +1,89 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/SignBits.hpp"
+
+#include <limits>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace marchingcubes::tests {
+
+SCENARIO("signBits") {
+  GIVEN("A row of 70 values") {
+    std::vector<double> values(70);
+    for (size_t i = 0; i < values.size(); ++i) {
+      values[i] = static_cast<double>(i % 7);
+    }
+    values[9] = std::numeric_limits<double>::quiet_NaN();
+    WHEN("I calculate the signs of the values for the iso value 3") {
+      THEN("Bit i is set when values[i] - 3 is not negative") {
+        for (size_t count : {0, 1, 5, 33, 64}) {
+          for (size_t first : {0, 1, 6}) {
+            auto word = signBits(values.data() + first, count, 3.0);
+            for (size_t i = 0; i < SIGN_WORD_BITS; ++i) {
+              INFO("first=" << first << ", count=" << count << ", i=" << i);
+              bool expected =
+                  i < count && !(values[first + i] - 3.0 < 0.0);
+              REQUIRE(((word >> i) & 1) == (expected ? 1 : 0));
+            }
+          }
+        }
+      }
+    }
+  }
+  GIVEN("Rows of integer values") {
+    std::vector<std::int16_t> int16Values(64);
+    std::vector<std::uint16_t> uint16Values(64);
+    std::vector<std::uint8_t> uint8Values(64);
+    std::vector<float> floatValues(64);
+    for (size_t i = 0; i < 64; ++i) {
+      int16Values[i] = static_cast<std::int16_t>(1000 * (i % 9) - 4000);
+      uint16Values[i] = static_cast<std::uint16_t>(8000 * (i % 9));
+      uint8Values[i] = static_cast<std::uint8_t>(30 * (i % 9));
+      floatValues[i] = 0.1f * static_cast<float>(i % 9);
+    }
+    auto requireSigns = [](const auto &values, double isoValue) {
+      for (size_t count : {3, 17, 64}) {
+        auto word = signBits(values.data(), count, isoValue);
+        for (size_t i = 0; i < SIGN_WORD_BITS; ++i) {
+          INFO("iso=" << isoValue << ", count=" << count << ", i=" << i);
+          bool expected =
+              i < count && !(static_cast<double>(values[i]) - isoValue < 0.0);
+          REQUIRE(((word >> i) & 1) == (expected ? 1 : 0));
+        }
+      }
+    };
+    THEN("They are compared to the iso value as double values") {
+      for (double isoValue : {-1e6, -4000.5, -4000.0, -1.0, 0.0, 2999.5, 3000.0,
+                              4000.0, 32768.0, 60000.0, 1e6}) {
+        requireSigns(int16Values, isoValue);
+        requireSigns(uint16Values, isoValue);
+      }
+      for (double isoValue : {-1.0, 0.0, 0.5, 30.0, 239.9, 240.0, 255.5}) {
+        requireSigns(uint8Values, isoValue);
+      }
+      for (double isoValue : {-1.0, 0.0, 0.1, 0.30000001, 0.3, 0.8, 1e300}) {
+        requireSigns(floatValues, isoValue);
+      }
+    }
+  }
+  GIVEN("Some words") {
+    THEN("The lowest bit set is found") {
+      REQUIRE(lowestBitIndex(SignWord{1}) == 0);
+      REQUIRE(lowestBitIndex(SignWord{0b101000}) == 3);
+      REQUIRE(lowestBitIndex(SignWord{1} << 63) == 63);
+      REQUIRE(signWordCount(0) == 0);
+      REQUIRE(signWordCount(64) == 1);
+      REQUIRE(signWordCount(65) == 2);
+    }
+  }
+}
+
+} // namespace marchingcubes::tests
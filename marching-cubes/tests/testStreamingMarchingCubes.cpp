@@ -0,0 +1,94 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/StreamingMarchingCubes.hpp"
+
+#include "marching-cubes/MarchingCubes.hpp"
+#include "marching-cubes/Tensor3D.hpp"
+#include "third-parties/catch-main/CatchApprox.hpp"
+
+#include <stdexcept>
+
+namespace marchingcubes::tests {
+
+template <typename TValue>
+static std::vector<TValue> slice(const Tensor3D &tensor, size_t z) {
+  std::vector<TValue> values;
+  for (size_t y = 0; y < tensor.size(Y); ++y) {
+    for (size_t x = 0; x < tensor.size(X); ++x) {
+      values.push_back(static_cast<TValue>(tensor.value(x, y, z)));
+    }
+  }
+  return values;
+}
+
+SCENARIO("StreamingMarchingCubes") {
+  GIVEN("A sphere tensor 3D") {
+    Grid3D grid{equidistantPoints(-7.0, 7.0, 15),
+                equidistantPoints(-5.0, 5.0, 11),
+                equidistantPoints(-9.0, 9.0, 19)};
+    auto sphere = createSphere(grid);
+    const auto expected = MarchingCubes{}.isoSurface(grid, sphere, 40.5);
+    REQUIRE(!expected.empty());
+    struct BatchCollector {
+      void emitBatch(const Triangle3D *batch, std::size_t count) {
+        REQUIRE(count > 0);
+        triangles.insert(triangles.end(), batch, batch + count);
+        ++batchCount;
+      }
+      std::vector<Triangle3D> triangles;
+      size_t batchCount = 0;
+    };
+    BatchCollector collector;
+    TriangleSinkAdapter<BatchCollector> sink{collector};
+    const auto &triangles = collector.triangles;
+    WHEN("I push its Z slices one at a time") {
+      StreamingMarchingCubes<double> streaming{grid.values[X], grid.values[Y],
+                                               40.5, sink};
+      for (size_t z = 0; z < sphere.size(Z); ++z) {
+        streaming.pushSlice(grid.values[Z][z], slice<double>(sphere, z));
+      }
+      THEN("Each slab with triangles is emitted in one batch") {
+        REQUIRE(streaming.sliceCount() == sphere.size(Z));
+        REQUIRE(collector.batchCount > 1);
+        REQUIRE(collector.batchCount <= sphere.size(Z) - 1);
+      }
+      THEN("The triangles are the ones of the whole tensor, in order") {
+        // The Z coordinates come from the slices, whereas isoSurface
+        // calculates them from the uniform grid: they may differ by rounding.
+        REQUIRE(triangles == Catch::approx(expected));
+      }
+    }
+    WHEN("I push slices of 16-bit integers") {
+      StreamingMarchingCubes<std::uint16_t> streaming{
+          grid.values[X], grid.values[Y], 40.5, sink};
+      for (size_t z = 0; z < sphere.size(Z); ++z) {
+        streaming.pushSlice(grid.values[Z][z],
+                            slice<std::uint16_t>(sphere, z));
+      }
+      THEN("The triangles are the ones of the double values") {
+        REQUIRE(triangles == Catch::approx(expected));
+      }
+    }
+    WHEN("I push invalid slices") {
+      StreamingMarchingCubes<double> streaming{grid.values[X], grid.values[Y],
+                                               40.5, sink};
+      streaming.pushSlice(0.0, slice<double>(sphere, 0));
+      THEN("An exception is thrown") {
+        REQUIRE_THROWS_AS(streaming.pushSlice(1.0, std::vector<double>(3)),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(streaming.pushSlice(0.0, slice<double>(sphere, 1)),
+                          std::invalid_argument);
+        REQUIRE(streaming.sliceCount() == 1);
+        REQUIRE(collector.batchCount == 0);
+      }
+    }
+  }
+}
+
+} // namespace marchingcubes::tests
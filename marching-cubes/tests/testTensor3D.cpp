@@ -8,6 +8,9 @@
 
 #include "marching-cubes/Tensor3D.hpp"
 
+#include "marching-cubes/MarchingCubes.hpp"
+
+#include <cmath>
 #include <numeric>
 
 #include <catch2/catch.hpp>
@@ -19,6 +22,39 @@ SCENARIO("equidistantPoints") {
           std::vector<double>{{0.0, 2.0, 4.0, 6.0}});
 }
 
+SCENARIO("Grid3D") {
+  GIVEN("A grid of equidistant points") {
+    Grid3D grid{equidistantPoints(-1.0, 1.0, 21),
+                equidistantPoints(0.0, 0.3, 4), {{5.0}}};
+    THEN("It is described as a uniform grid") {
+      const auto *uniformGrid = grid.uniformGrid();
+      REQUIRE(uniformGrid != nullptr);
+      REQUIRE(uniformGrid->origin == Point3D{{-1.0, 0.0, 5.0}});
+      REQUIRE(uniformGrid->spacing[X] == Approx(0.1));
+      REQUIRE(uniformGrid->spacing[Y] == Approx(0.1));
+      REQUIRE(uniformGrid->coordinate(X, 20) == Approx(1.0));
+    }
+  }
+  GIVEN("A grid whose points are not equidistant along one axis") {
+    Grid3D grid{{{0.0, 1.0, 2.0}}, {{0.0, 1.0, 3.0}}, {{0.0, 1.0}}};
+    THEN("It is not described as a uniform grid") {
+      REQUIRE(grid.uniformGrid() == nullptr);
+    }
+  }
+  GIVEN("A uniform grid") {
+    UniformGrid3D uniformGrid{{{1.0, 2.0, 3.0}}, {{0.5, 0.25, 2.0}}};
+    WHEN("I create a grid from it") {
+      Grid3D grid{uniformGrid, 3, 2, 2};
+      THEN("The values of the axes are calculated from the spacings") {
+        REQUIRE(grid.values[X] == std::vector<double>{{1.0, 1.5, 2.0}});
+        REQUIRE(grid.values[Y] == std::vector<double>{{2.0, 2.25}});
+        REQUIRE(grid.values[Z] == std::vector<double>{{3.0, 5.0}});
+        REQUIRE(grid.uniformGrid() != nullptr);
+      }
+    }
+  }
+}
+
 static std::vector<double> iota(size_t size, double startValue) {
   std::vector<double> values(size);
   assert(values.size() == size);
@@ -46,6 +82,20 @@ SCENARIO("Tensor3D") {
   }
 }
 
+SCENARIO("Tensor3D of 16-bit integers") {
+  GIVEN("A 3D tensor of int16 values") {
+    Tensor3DInt16 tensor{2, 2, 2, {{-300, 2, 3, 4, 5, 6, 7, 1200}}};
+    THEN("The values are stored with their native type") {
+      REQUIRE(sizeof(tensor.allValues()[0]) == 2);
+      REQUIRE(tensor.value(0, 0, 0) == -300);
+      REQUIRE(tensor.value(1, 1, 0) == 4);
+      auto [min, max] = tensor.minMax();
+      REQUIRE(min == -300);
+      REQUIRE(max == 1200);
+    }
+  }
+}
+
 SCENARIO("sphere") {
   GIVEN("A 3D grid") {
     Grid3D grid{equidistantPoints(-3.0, 3.0, 7),
@@ -70,4 +120,101 @@ SCENARIO("sphere") {
   }
 }
 
+SCENARIO("pyramidIndices") {
+  REQUIRE(pyramidIndices(10, 0).size() == 10);
+  REQUIRE(pyramidIndices(10, 1) == std::vector<size_t>{{0, 2, 4, 6, 8, 9}});
+  REQUIRE(pyramidIndices(9, 1) == std::vector<size_t>{{0, 2, 4, 6, 8}});
+  REQUIRE(pyramidIndices(9, 3) == std::vector<size_t>{{0, 8}});
+  REQUIRE(pyramidIndices(9, 4) == std::vector<size_t>{{0, 8}});
+  REQUIRE(pyramidIndices(1, 2) == std::vector<size_t>{{0}});
+}
+
+SCENARIO("Tensor3D pyramid") {
+  GIVEN("A 3D tensor and its grid") {
+    Grid3D grid{equidistantPoints(-4.0, 4.0, 17),
+                equidistantPoints(-3.0, 3.0, 13),
+                equidistantPoints(-5.0, 5.0, 21)};
+    auto sphere = createSphere(grid);
+    WHEN("I build its pyramid") {
+      sphere.buildPyramid(3, 2);
+      THEN("Each level keeps every 2^level-th value of the tensor") {
+        REQUIRE(sphere.pyramidLevelCount() == 4);
+        REQUIRE(&sphere.pyramidLevel(0) == &sphere);
+        for (size_t level = 1; level < sphere.pyramidLevelCount(); ++level) {
+          const auto &coarse = sphere.pyramidLevel(level);
+          const auto xIndices = pyramidIndices(sphere.size(X), level);
+          const auto yIndices = pyramidIndices(sphere.size(Y), level);
+          const auto zIndices = pyramidIndices(sphere.size(Z), level);
+          REQUIRE(coarse.size(X) == xIndices.size());
+          REQUIRE(coarse.size(Y) == yIndices.size());
+          REQUIRE(coarse.size(Z) == zIndices.size());
+          for (size_t z = 0; z < coarse.size(Z); ++z) {
+            for (size_t y = 0; y < coarse.size(Y); ++y) {
+              for (size_t x = 0; x < coarse.size(X); ++x) {
+                REQUIRE(coarse.value(x, y, z) ==
+                        sphere.value(xIndices[x], yIndices[y], zIndices[z]));
+              }
+            }
+          }
+        }
+      }
+      THEN("The grid of a level has the bounds of the grid") {
+        const auto coarseGrid = pyramidGrid(grid, 2);
+        REQUIRE(coarseGrid.values[X] ==
+                std::vector<double>{{-4.0, -2.0, 0.0, 2.0, 4.0}});
+        REQUIRE(coarseGrid.values[Y].front() == -3.0);
+        REQUIRE(coarseGrid.values[Y].back() == 3.0);
+        REQUIRE(coarseGrid.values[Y].size() == sphere.pyramidLevel(2).size(Y));
+        REQUIRE(coarseGrid.uniformGrid() != nullptr);
+        // The last value of Z is 20, which is not a multiple of 8.
+        REQUIRE(pyramidGrid(grid, 3).uniformGrid() == nullptr);
+        REQUIRE(pyramidGrid(grid, 0).values == grid.values);
+      }
+    }
+    WHEN("I build its pyramid with another thread count") {
+      sphere.buildPyramid(2, 1);
+      auto other = createSphere(grid);
+      other.buildPyramid(2, 3);
+      THEN("The levels are the same") {
+        REQUIRE(sphere.pyramidLevelCount() == 3);
+        for (size_t level = 1; level < 3; ++level) {
+          const auto values = sphere.pyramidLevel(level).allValues();
+          const auto otherValues = other.pyramidLevel(level).allValues();
+          REQUIRE(std::equal(values.begin(), values.end(),
+                             otherValues.begin(), otherValues.end()));
+        }
+      }
+    }
+  }
+  GIVEN("A tensor whose values are the x coordinates of a non-uniform grid") {
+    std::vector<double> xValues;
+    for (size_t i = 0; i < 19; ++i) {
+      xValues.push_back(0.1 * static_cast<double>(i * i));
+    }
+    Grid3D grid{xValues, equidistantPoints(0.0, 1.0, 6),
+                equidistantPoints(0.0, 1.0, 7)};
+    std::vector<double> values;
+    for (size_t i = 0; i < xValues.size() * 6 * 7; ++i) {
+      values.push_back(xValues[i % xValues.size()]);
+    }
+    Tensor3D tensor{xValues.size(), 6, 7, std::move(values)};
+    tensor.buildPyramid();
+    WHEN("I calculate the isosurfaces of the levels on their grids") {
+      THEN("They are the same plane x = isoValue") {
+        const MarchingCubes algo;
+        for (size_t level = 0; level < tensor.pyramidLevelCount(); ++level) {
+          const auto triangles = algo.isoSurface(
+              pyramidGrid(grid, level), tensor.pyramidLevel(level), 12.5);
+          REQUIRE(!triangles.empty());
+          for (const auto &triangle : triangles) {
+            for (const auto &point : triangle) {
+              REQUIRE(std::abs(point[X] - 12.5) < 1e-9);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
 } // namespace marchingcubes::tests
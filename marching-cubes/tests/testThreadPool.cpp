@@ -0,0 +1,86 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "marching-cubes/ThreadPool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include <catch2/catch.hpp>
+
+namespace marchingcubes::tests {
+
+SCENARIO("ThreadPool") {
+  GIVEN("A thread pool with 4 threads") {
+    ThreadPool pool{4};
+    REQUIRE(pool.threadCount() == 4);
+    WHEN("I run some tasks several times") {
+      std::vector<std::size_t> results(10, 0);
+      for (std::size_t iRun = 1; iRun <= 3; ++iRun) {
+        pool.run(results.size(), [&](std::size_t i) { results[i] += i; });
+      }
+      THEN("Each task is executed once per run") {
+        for (std::size_t i = 0; i < results.size(); ++i) {
+          REQUIRE(results[i] == 3 * i);
+        }
+      }
+    }
+    WHEN("A task throws an exception") {
+      std::atomic<std::size_t> executedTasks{0};
+      auto run = [&] {
+        pool.run(8, [&](std::size_t i) {
+          ++executedTasks;
+          if (i == 5) {
+            throw std::runtime_error("task 5 failed");
+          }
+        });
+      };
+      THEN("The exception is rethrown once all the tasks are finished") {
+        REQUIRE_THROWS_AS(run(), std::runtime_error);
+        REQUIRE(executedTasks == 8);
+      }
+    }
+  }
+  GIVEN("A thread pool with 2 threads") {
+    ThreadPool pool{2};
+    WHEN("The first task waits for all the other tasks") {
+      constexpr std::size_t taskCount = 100;
+      std::mutex mutex;
+      std::condition_variable otherTasksDone;
+      std::size_t doneCount = 0;
+      bool isFirstTaskUnblocked = false;
+      pool.run(taskCount, [&](std::size_t i) {
+        std::unique_lock<std::mutex> lock{mutex};
+        if (i == 0) {
+          isFirstTaskUnblocked = otherTasksDone.wait_for(
+              lock, std::chrono::seconds(10),
+              [&] { return doneCount == taskCount - 1; });
+        } else if (++doneCount == taskCount - 1) {
+          otherTasksDone.notify_one();
+        }
+      });
+      THEN("The other thread steals the tasks that follow the first one") {
+        REQUIRE(isFirstTaskUnblocked);
+      }
+    }
+  }
+  GIVEN("A thread pool with 1 thread") {
+    ThreadPool pool{1};
+    WHEN("I run some tasks") {
+      std::vector<std::size_t> order;
+      pool.run(3, [&](std::size_t i) { order.push_back(i); });
+      THEN("They are executed in order by the calling thread") {
+        REQUIRE(order == std::vector<std::size_t>{{0, 1, 2}});
+      }
+    }
+  }
+}
+
+} // namespace marchingcubes::tests
@@ -0,0 +1,52 @@
+/**
+ * Copyright Marc-Olivier Andrez 2018.
+ *
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at
+ * https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include "marching-cubes/IndexedMesh.hpp"
+#include "marching-cubes/Tensor3D.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace marchingcubes::tests {
+
+/*!
+ * Returns the number of triangles of each edge of mesh.
+ */
+inline std::map<std::pair<std::uint32_t, std::uint32_t>, size_t>
+edgeTriangleCounts(const IndexedMesh &mesh) {
+  std::map<std::pair<std::uint32_t, std::uint32_t>, size_t> counts;
+  for (const auto &triangle : mesh.triangles) {
+    for (size_t i = 0; i < triangle::POINT_COUNT; ++i) {
+      const auto a = triangle[i];
+      const auto b = triangle[(i + 1) % triangle::POINT_COUNT];
+      ++counts[std::make_pair(std::min(a, b), std::max(a, b))];
+    }
+  }
+  return counts;
+}
+
+/*!
+ * Returns the values of tensor plus shift, converted to TValue.
+ */
+template <typename TValue>
+BasicTensor3D<TValue> convertedTensor(const Tensor3D &tensor,
+                                      double shift = 0.0) {
+  std::vector<TValue> values;
+  for (const auto value : tensor.allValues()) {
+    values.push_back(static_cast<TValue>(value + shift));
+  }
+  return BasicTensor3D<TValue>{tensor.size(X), tensor.size(Y), tensor.size(Z),
+                               std::move(values)};
+}
+
+} // namespace marchingcubes::tests